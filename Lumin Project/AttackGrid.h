@@ -0,0 +1,215 @@
+﻿#pragma once
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include "GameConfig.h"
+#include "CollisionKernel.h"
+
+//均匀网格的格子大小（像素），覆盖整个 SCREEN_WIDTH x SCREEN_HEIGHT 场地
+const int GRID_CELL_SIZE = 40;
+const int GRID_COLS = (SCREEN_WIDTH + GRID_CELL_SIZE - 1) / GRID_CELL_SIZE;
+const int GRID_ROWS = (SCREEN_HEIGHT + GRID_CELL_SIZE - 1) / GRID_CELL_SIZE;
+
+//查询时每次交给批量检测的记录数
+const int GRID_QUERY_CHUNK = 256;
+
+//加入网格的一条记录：复制碰撞需要的数据，查询时不用再回到攻击数组取值
+struct GridEntry
+{
+	float x, y;
+	float radius;
+	float damage;
+	unsigned int seq;          // 攻击生成序号
+	short cellX0, cellY0;      // 攻击包围盒覆盖的第一个格子，用于查询时去重
+	short cellX1, cellY1;
+};
+
+//攻击碰撞粗筛网格（broad-phase）
+//每帧攻击更新完后把 ACTIVE 的攻击按包围盒放入所有覆盖的格子，
+//玩家查询时只检查玩家圆形覆盖的几个格子，与攻击总数无关
+class AttackGrid
+{
+private:
+	std::vector<GridEntry> pending;   // 本帧加入的攻击
+	std::vector<int> cellStart;       // 每个格子在记录数组中的起始下标（多一个尾元素）
+	std::vector<int> cellFill;        // 构建时的写入游标
+
+	// 按格子排好序的记录，结构数组存放以便批量检测
+	std::vector<float> entryX, entryY;
+	std::vector<float> entryRadius;
+	std::vector<float> entryDamage;
+	std::vector<unsigned int> entrySeq;
+	std::vector<short> entryCellX0, entryCellY0;
+
+public:
+	AttackGrid(int capacity = 256)
+		:cellStart(GRID_COLS * GRID_ROWS + 1, 0), cellFill(GRID_COLS * GRID_ROWS, 0)
+	{
+		pending.reserve(capacity);
+		entryX.reserve(capacity * 4);
+		entryY.reserve(capacity * 4);
+		entryRadius.reserve(capacity * 4);
+		entryDamage.reserve(capacity * 4);
+		entrySeq.reserve(capacity * 4);
+		entryCellX0.reserve(capacity * 4);
+		entryCellY0.reserve(capacity * 4);
+	}
+
+	void clear()
+	{
+		pending.clear();
+	}
+
+	void add(float cx, float cy, float r, float dmg, unsigned int seq)
+	{
+		GridEntry e;
+		e.x = cx;
+		e.y = cy;
+		e.radius = r;
+		e.damage = dmg;
+		e.seq = seq;
+		e.cellX0 = (short)cellX(cx - r);
+		e.cellY0 = (short)cellY(cy - r);
+		e.cellX1 = (short)cellX(cx + r);
+		e.cellY1 = (short)cellY(cy + r);
+		pending.push_back(e);
+	}
+
+	//计数排序：先统计每格数量，再前缀和，最后填入
+	void build()
+	{
+		std::fill(cellStart.begin(), cellStart.end(), 0);
+		for (const GridEntry& e : pending)
+		{
+			for (int cy = e.cellY0; cy <= e.cellY1; cy++)
+			{
+				for (int cx = e.cellX0; cx <= e.cellX1; cx++)
+				{
+					cellStart[cy * GRID_COLS + cx + 1]++;
+				}
+			}
+		}
+		for (int c = 0; c < GRID_COLS * GRID_ROWS; c++)
+		{
+			cellStart[c + 1] += cellStart[c];
+			cellFill[c] = cellStart[c];
+		}
+
+		int total = cellStart[GRID_COLS * GRID_ROWS];
+		entryX.resize(total);
+		entryY.resize(total);
+		entryRadius.resize(total);
+		entryDamage.resize(total);
+		entrySeq.resize(total);
+		entryCellX0.resize(total);
+		entryCellY0.resize(total);
+		for (const GridEntry& e : pending)
+		{
+			for (int cy = e.cellY0; cy <= e.cellY1; cy++)
+			{
+				for (int cx = e.cellX0; cx <= e.cellX1; cx++)
+				{
+					int k = cellFill[cy * GRID_COLS + cx]++;
+					entryX[k] = e.x;
+					entryY[k] = e.y;
+					entryRadius[k] = e.radius;
+					entryDamage[k] = e.damage;
+					entrySeq[k] = e.seq;
+					entryCellX0[k] = e.cellX0;
+					entryCellY0[k] = e.cellY0;
+				}
+			}
+		}
+	}
+
+	//查询玩家是否被命中，命中时返回最早生成的命中攻击的伤害
+	//每个格子的记录交给 circleHitBatch 批量检测，只对命中位做去重和排序
+	bool query(float playerX, float playerY, float playerSize, float* damage = nullptr) const
+	{
+		float pr = playerSize / 2.0f;
+		int qx0 = cellX(playerX - pr);
+		int qy0 = cellY(playerY - pr);
+		int qx1 = cellX(playerX + pr);
+		int qy1 = cellY(playerY + pr);
+
+		unsigned int bestSeq = 0;
+		float bestDamage = 0.0f;
+		bool hit = false;
+
+		for (int cy = qy0; cy <= qy1; cy++)
+		{
+			for (int cx = qx0; cx <= qx1; cx++)
+			{
+				int c = cy * GRID_COLS + cx;
+				for (int base = cellStart[c]; base < cellStart[c + 1]; base += GRID_QUERY_CHUNK)
+				{
+					int n = std::min(GRID_QUERY_CHUNK, cellStart[c + 1] - base);
+					unsigned int mask[GRID_QUERY_CHUNK / 32];
+					if (circleHitBatch(&entryX[base], &entryY[base], &entryRadius[base], &entryDamage[base], n,
+						playerX, playerY, pr, mask, nullptr) == 0)
+					{
+						continue;
+					}
+
+					for (int w = 0; w < (n + 31) / 32; w++)
+					{
+						for (unsigned int bits = mask[w]; bits; bits &= bits - 1)
+						{
+							int k = base + w * 32 + lowestBit(bits);
+
+							// 同一个攻击可能出现在多个格子中，只认两者包围盒重叠的第一个格子
+							if (cx != std::max((int)entryCellX0[k], qx0) || cy != std::max((int)entryCellY0[k], qy0))
+							{
+								continue;
+							}
+							if (!hit || entrySeq[k] < bestSeq)
+							{
+								hit = true;
+								bestSeq = entrySeq[k];
+								bestDamage = entryDamage[k];
+							}
+						}
+					}
+				}
+			}
+		}
+
+		if (hit && damage)
+		{
+			*damage = bestDamage;
+		}
+		return hit;
+	}
+
+	int entryCount() const
+	{
+		return (int)entryX.size();
+	}
+
+private:
+	static int lowestBit(unsigned int v)
+	{
+		int b = 0;
+		while ((v & 1u) == 0)
+		{
+			v >>= 1;
+			b++;
+		}
+		return b;
+	}
+
+	//坐标转格子下标，超出场地的部分夹到边缘格子
+	static int cellX(float px)
+	{
+		int c = (int)floorf(px / GRID_CELL_SIZE);
+		return c < 0 ? 0 : (c >= GRID_COLS ? GRID_COLS - 1 : c);
+	}
+
+	static int cellY(float py)
+	{
+		int c = (int)floorf(py / GRID_CELL_SIZE);
+		return c < 0 ? 0 : (c >= GRID_ROWS ? GRID_ROWS - 1 : c);
+	}
+};
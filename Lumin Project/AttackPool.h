@@ -0,0 +1,522 @@
+﻿#pragma once
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+#include "GameConfig.h"
+#include "AttackGrid.h"
+#include "TrigCache.h"
+#include "BulletKernel.h"
+#include "Snapshot.h"
+
+// 每种攻击预分配的容量，正常战斗中不会超过，不会在帧内再申请内存
+// 弹幕脚本会远超这个数，数组按需增长，增长到峰值后同样不再申请
+const int ATTACK_POOL_CAPACITY = 256;
+
+// 追踪子弹激活后转向的帧数，之后沿当前方向直线飞行，避免绕着玩家一直打转
+const int BULLET_HOMING_TIME = 90;
+
+//圆形攻击数组（CircleAttack 与 AimedCircleAttack 共用同一布局）
+//按结构数组(SoA)存放：每个属性一条连续数组，下标 i 对应同一个攻击
+struct CircleAttackArray
+{
+	// 同一种攻击共享的参数
+	int warningTime;
+	int activeTime;
+
+	std::vector<float> x, y;
+	std::vector<float> radius;
+	std::vector<float> damage;
+	std::vector<int> timer;
+	std::vector<AttackPhase> phase;
+	std::vector<unsigned int> seq;   // 生成序号，用于保持原先按生成顺序结算伤害
+
+	CircleAttackArray(int warning, int active, int capacity)
+		:warningTime(warning), activeTime(active)
+	{
+		x.reserve(capacity);
+		y.reserve(capacity);
+		radius.reserve(capacity);
+		damage.reserve(capacity);
+		timer.reserve(capacity);
+		phase.reserve(capacity);
+		seq.reserve(capacity);
+	}
+
+	int size() const
+	{
+		return (int)x.size();
+	}
+
+	void push(unsigned int s, float cx, float cy, float r, float dmg)
+	{
+		x.push_back(cx);
+		y.push_back(cy);
+		radius.push_back(r);
+		damage.push_back(dmg);
+		timer.push_back(0);
+		phase.push_back(WARNING);
+		seq.push_back(s);
+	}
+
+	//更新计时器状态，并移除进入冷却的攻击
+	void update()
+	{
+		for (int i = 0; i < size(); i++)
+		{
+			timer[i]++;
+
+			if (phase[i] == WARNING && timer[i] > warningTime)
+			{
+				phase[i] = ACTIVE;
+				timer[i] = 0;
+			}
+			else if (phase[i] == ACTIVE && timer[i] > activeTime)
+			{
+				phase[i] = COOLDOWN;
+				timer[i] = 0;
+			}
+		}
+		removeExpired();
+	}
+
+	//稳定压缩：一次遍历把未结束的攻击依次前移，保持生成顺序，整体 O(n)
+	void removeExpired()
+	{
+		int n = size();
+		int w = 0;
+		for (int i = 0; i < n; i++)
+		{
+			if (phase[i] == COOLDOWN)
+			{
+				continue;
+			}
+			if (w != i)
+			{
+				x[w] = x[i];
+				y[w] = y[i];
+				radius[w] = radius[i];
+				damage[w] = damage[i];
+				timer[w] = timer[i];
+				phase[w] = phase[i];
+				seq[w] = seq[i];
+			}
+			w++;
+		}
+		if (w != n)
+		{
+			// 缩小 vector 不会释放容量
+			x.resize(w);
+			y.resize(w);
+			radius.resize(w);
+			damage.resize(w);
+			timer.resize(w);
+			phase.resize(w);
+			seq.resize(w);
+		}
+	}
+
+	//共享参数在构造时固定，快照只保存各条数组（等长，只记一个长度）
+	void save(SnapshotWriter& out) const
+	{
+		out.array(x);
+		out.column(y);
+		out.column(radius);
+		out.column(damage);
+		out.column(timer);
+		out.column(phase);
+		out.column(seq);
+	}
+
+	void load(SnapshotReader& in)
+	{
+		uint32_t n = in.array(x);
+		in.column(y, n);
+		in.column(radius, n);
+		in.column(damage, n);
+		in.column(timer, n);
+		in.column(phase, n);
+		in.column(seq, n);
+	}
+
+	bool checkCollision(int i, float playerX, float playerY, float playerSize) const
+	{
+		if (phase[i] != ACTIVE)
+		{
+			return false;
+		}
+		float dx = playerX - x[i];
+		float dy = playerY - y[i];
+		float rr = radius[i] + playerSize / 2.0f;
+		return dx * dx + dy * dy < rr * rr;
+	}
+};
+
+//可反弹子弹数组（BounceBulletAttack）
+struct BounceBulletArray
+{
+	// 同一种攻击共享的参数
+	int warningTime;       // 预警时间（帧数）
+	float rotationSpeed;   // 旋转速度（每帧弧度）
+	Rotation rotationStep; // 每帧旋转量，以 (cos, sin) 保存
+
+	std::vector<float> x, y;
+	std::vector<float> prevX, prevY; // 上一逻辑帧的位置，用于插值绘制
+	std::vector<float> radius;
+	std::vector<float> damage;
+	std::vector<int> timer;
+	std::vector<AttackPhase> phase;
+	std::vector<unsigned int> seq;
+	std::vector<float> speed;        // 子弹速度
+	std::vector<float> directionX;   // X方向向量
+	std::vector<float> directionY;   // Y方向向量
+	std::vector<int> bounceCount;    // 当前反弹次数
+	std::vector<int> maxBounces;     // 最大反弹次数
+	std::vector<Rotation> rotation;  // 当前朝向（cos, sin）
+	std::vector<float> homing;       // 追踪子弹每帧最多转向的弧度，0 为直线飞行
+
+	BounceBulletArray(int capacity)
+		:warningTime(30), rotationSpeed(0.1f), rotationStep(Rotation::fromAngle(0.1f))
+	{
+		x.reserve(capacity);
+		y.reserve(capacity);
+		prevX.reserve(capacity);
+		prevY.reserve(capacity);
+		radius.reserve(capacity);
+		damage.reserve(capacity);
+		timer.reserve(capacity);
+		phase.reserve(capacity);
+		seq.reserve(capacity);
+		speed.reserve(capacity);
+		directionX.reserve(capacity);
+		directionY.reserve(capacity);
+		bounceCount.reserve(capacity);
+		maxBounces.reserve(capacity);
+		rotation.reserve(capacity);
+		homing.reserve(capacity);
+	}
+
+	int size() const
+	{
+		return (int)x.size();
+	}
+
+	void push(unsigned int s, float cx, float cy, float dirX, float dirY, float spd, int maxBounce, float dmg, float turn = 0.0f)
+	{
+		x.push_back(cx);
+		y.push_back(cy);
+		prevX.push_back(cx);
+		prevY.push_back(cy);
+		radius.push_back(10.0f);
+		damage.push_back(dmg);
+		timer.push_back(0);
+		phase.push_back(WARNING);  // 先进入预警阶段
+		seq.push_back(s);
+		speed.push_back(spd);
+		directionX.push_back(dirX);
+		directionY.push_back(dirY);
+		bounceCount.push_back(0);
+		maxBounces.push_back(maxBounce);
+		rotation.push_back({ 1.0f, 0.0f });
+		homing.push_back(turn);
+	}
+
+	//按数组整段分几遍处理，每一遍只碰用得到的几条数组，移动与撞墙交给 BulletKernel 的向量版本
+	//结果与逐颗子弹依次计时、移动、旋转、撞墙、判断销毁完全相同
+	//targetX、targetY 为追踪子弹的目标
+	void update(float targetX, float targetY)
+	{
+		int n = size();
+		if (n == 0)
+		{
+			return;
+		}
+		std::copy(x.begin(), x.end(), prevX.begin());
+		std::copy(y.begin(), y.end(), prevY.begin());
+
+		// 计时；预警结束的子弹本帧只切换阶段（timer 归零），下一帧才开始移动
+		for (int i = 0; i < n; i++)
+		{
+			int t = timer[i] + 1;
+			bool activate = phase[i] == WARNING && t > warningTime;
+			timer[i] = activate ? 0 : t;
+			phase[i] = activate ? ACTIVE : phase[i];
+		}
+
+		steerHoming(targetX, targetY);
+		bulletStepBatch(x.data(), y.data(), directionX.data(), directionY.data(), speed.data(), radius.data(),
+			bounceCount.data(), maxBounces.data(), phase.data(), timer.data(), n);
+		// 撞墙销毁的子弹已是 COOLDOWN，不再旋转，反正马上移除
+		rotationStepBatch(rotation.data(), rotationStep, phase.data(), timer.data(), n);
+		removeExpired();
+	}
+
+	//稳定压缩，结果与 CircleAttackArray::removeExpired 相同
+	//弹幕下每帧都有子弹在数组各处销毁，逐个元素搬 16 条数组太慢；改为找出连续存活的一段，每条数组整段前移
+	void removeExpired()
+	{
+		int n = size();
+		int w = 0;
+		int i = 0;
+		while (i < n)
+		{
+			while (i < n && phase[i] == COOLDOWN)
+			{
+				i++;
+			}
+			int start = i;
+			while (i < n && phase[i] != COOLDOWN)
+			{
+				i++;
+			}
+			if (w != start)
+			{
+				moveRun(start, w, i - start);
+			}
+			w += i - start;
+		}
+		if (w != n)
+		{
+			x.resize(w);
+			y.resize(w);
+			prevX.resize(w);
+			prevY.resize(w);
+			radius.resize(w);
+			damage.resize(w);
+			timer.resize(w);
+			phase.resize(w);
+			seq.resize(w);
+			speed.resize(w);
+			directionX.resize(w);
+			directionY.resize(w);
+			bounceCount.resize(w);
+			maxBounces.resize(w);
+			rotation.resize(w);
+			homing.resize(w);
+		}
+	}
+
+	void save(SnapshotWriter& out) const
+	{
+		out.array(x);
+		out.column(y);
+		out.column(prevX);
+		out.column(prevY);
+		out.column(radius);
+		out.column(damage);
+		out.column(timer);
+		out.column(phase);
+		out.column(seq);
+		out.column(speed);
+		out.column(directionX);
+		out.column(directionY);
+		out.column(bounceCount);
+		out.column(maxBounces);
+		out.column(rotation);
+		out.column(homing);
+	}
+
+	void load(SnapshotReader& in)
+	{
+		uint32_t n = in.array(x);
+		in.column(y, n);
+		in.column(prevX, n);
+		in.column(prevY, n);
+		in.column(radius, n);
+		in.column(damage, n);
+		in.column(timer, n);
+		in.column(phase, n);
+		in.column(seq, n);
+		in.column(speed, n);
+		in.column(directionX, n);
+		in.column(directionY, n);
+		in.column(bounceCount, n);
+		in.column(maxBounces, n);
+		in.column(rotation, n);
+		in.column(homing, n);
+	}
+
+	bool checkCollision(int i, float playerX, float playerY, float playerSize) const
+	{
+		if (phase[i] != ACTIVE) return false;
+		float dx = playerX - x[i];
+		float dy = playerY - y[i];
+		float rr = radius[i] + playerSize / 2.0f;
+		return dx * dx + dy * dy < rr * rr;
+	}
+
+private:
+	//把 [from, from + count) 整段移到 to（to < from，前移时重叠也没关系）
+	void moveRun(int from, int to, int count)
+	{
+		moveColumn(x, from, to, count);
+		moveColumn(y, from, to, count);
+		moveColumn(prevX, from, to, count);
+		moveColumn(prevY, from, to, count);
+		moveColumn(radius, from, to, count);
+		moveColumn(damage, from, to, count);
+		moveColumn(timer, from, to, count);
+		moveColumn(phase, from, to, count);
+		moveColumn(seq, from, to, count);
+		moveColumn(speed, from, to, count);
+		moveColumn(directionX, from, to, count);
+		moveColumn(directionY, from, to, count);
+		moveColumn(bounceCount, from, to, count);
+		moveColumn(maxBounces, from, to, count);
+		moveColumn(rotation, from, to, count);
+		moveColumn(homing, from, to, count);
+	}
+
+	template<typename T>
+	static void moveColumn(std::vector<T>& v, int from, int to, int count)
+	{
+		std::copy(v.begin() + from, v.begin() + from + count, v.begin() + to);
+	}
+
+	//追踪子弹朝目标转向，每帧最多转 homing 弧度；转向在移动之前
+	void steerHoming(float targetX, float targetY)
+	{
+		for (int i = 0; i < size(); i++)
+		{
+			if (homing[i] <= 0.0f || !bulletMoving(phase[i], timer[i]) || timer[i] > BULLET_HOMING_TIME)
+			{
+				continue;
+			}
+			float tx = targetX - x[i];
+			float ty = targetY - y[i];
+			float dx = directionX[i], dy = directionY[i];
+			// 当前方向与目标方向的夹角，超过每帧上限时只转上限
+			float angle = atan2f(dx * ty - dy * tx, dx * tx + dy * ty);
+			angle = std::max(-homing[i], std::min(homing[i], angle));
+			Rotation turn = Rotation::fromAngle(angle);
+			directionX[i] = dx * turn.c - dy * turn.s;
+			directionY[i] = dx * turn.s + dy * turn.c;
+		}
+	}
+};
+
+//攻击池：Boss 的所有攻击按种类分别存放在连续数组中
+//取代原先每个攻击一个 shared_ptr + 虚函数调用的做法
+class AttackPool
+{
+private:
+	CircleAttackArray circleAttacks;       // CircleAttack：大范围圆形攻击
+	CircleAttackArray aimedCircleAttacks;  // AimedCircleAttack：瞄准圆形攻击（短预警）
+	BounceBulletArray bounceBullets;       // BounceBulletAttack：可反弹子弹
+	unsigned int nextSeq;
+	mutable AttackGrid grid;               // ACTIVE 攻击的碰撞粗筛网格，每次 update 后重建
+	mutable bool gridDirty;                // 从快照恢复后网格尚未重建，第一次查询时再建
+
+public:
+	AttackPool(int capacity = ATTACK_POOL_CAPACITY)
+		:circleAttacks(75, 25, capacity), aimedCircleAttacks(20, 20, capacity),
+		bounceBullets(capacity), nextSeq(0), grid(capacity), gridDirty(false) {
+	}
+
+	//生成攻击
+	void spawnCircle(float cx, float cy, float r, float dmg = 25.0f)
+	{
+		circleAttacks.push(nextSeq++, cx, cy, r, dmg);
+	}
+
+	void spawnAimedCircle(float cx, float cy, float r, float dmg = 15.0f)
+	{
+		aimedCircleAttacks.push(nextSeq++, cx, cy, r, dmg);
+	}
+
+	void spawnBounceBullet(float cx, float cy, float dirX, float dirY, float spd = 10.0f, int maxBounce = 4, float dmg = 15.0f)
+	{
+		bounceBullets.push(nextSeq++, cx, cy, dirX, dirY, spd, maxBounce, dmg);
+	}
+
+	//追踪子弹：飞行前 BULLET_HOMING_TIME 帧每帧最多转向 turn 弧度，碰墙即消失
+	void spawnHomingBullet(float cx, float cy, float dirX, float dirY, float spd, float turn, float dmg)
+	{
+		bounceBullets.push(nextSeq++, cx, cy, dirX, dirY, spd, 1, dmg, turn);
+	}
+
+	//更新所有攻击并移除已结束的攻击，然后把 ACTIVE 的攻击放入网格
+	//targetX、targetY 为追踪子弹的目标（Boss 当前瞄准的玩家）
+	void update(float targetX, float targetY)
+	{
+		circleAttacks.update();
+		aimedCircleAttacks.update();
+		bounceBullets.update(targetX, targetY);
+		rebuildGrid();
+	}
+
+	//碰撞检测：命中时返回最早生成的命中攻击的伤害
+	//（与原先按生成顺序遍历、第一次伤害生效后进入无敌帧的结果一致）
+	//只检查玩家所在的几个网格，查询开销与攻击总数无关
+	bool checkHit(float playerX, float playerY, float playerSize, float* damage = nullptr) const
+	{
+		return getGrid().query(playerX, playerY, playerSize, damage);
+	}
+
+	const AttackGrid& getGrid() const
+	{
+		if (gridDirty)
+		{
+			rebuildGrid();
+		}
+		return grid;
+	}
+
+	int size() const
+	{
+		return circleAttacks.size() + aimedCircleAttacks.size() + bounceBullets.size();
+	}
+
+	//网格完全由攻击数组决定，快照里不保存；恢复后只做标记，回滚时连续恢复多次也不必每次重建
+	void save(SnapshotWriter& out) const
+	{
+		circleAttacks.save(out);
+		aimedCircleAttacks.save(out);
+		bounceBullets.save(out);
+		out.value(nextSeq);
+	}
+
+	void load(SnapshotReader& in)
+	{
+		circleAttacks.load(in);
+		aimedCircleAttacks.load(in);
+		bounceBullets.load(in);
+		in.value(nextSeq);
+		gridDirty = true;
+	}
+
+	const CircleAttackArray& getCircleAttacks() const { return circleAttacks; }
+	const CircleAttackArray& getAimedCircleAttacks() const { return aimedCircleAttacks; }
+	const BounceBulletArray& getBounceBullets() const { return bounceBullets; }
+
+private:
+	void rebuildGrid() const
+	{
+		gridDirty = false;
+		grid.clear();
+		addActiveCircles(circleAttacks);
+		addActiveCircles(aimedCircleAttacks);
+		const BounceBulletArray& b = bounceBullets;
+		for (int i = 0; i < b.size(); i++)
+		{
+			if (b.phase[i] == ACTIVE)
+			{
+				grid.add(b.x[i], b.y[i], b.radius[i], b.damage[i], b.seq[i]);
+			}
+		}
+		grid.build();
+	}
+
+	void addActiveCircles(const CircleAttackArray& a) const
+	{
+		for (int i = 0; i < a.size(); i++)
+		{
+			if (a.phase[i] == ACTIVE)
+			{
+				grid.add(a.x[i], a.y[i], a.radius[i], a.damage[i], a.seq[i]);
+			}
+		}
+	}
+};
@@ -0,0 +1,244 @@
+﻿// AttackRenderer.cpp : 攻击的批量绘制
+//
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <cfloat>
+
+#include "AttackRenderer.h"
+
+#ifndef LUMIN_HEADLESS
+#include "rlgl.h"
+
+AttackRenderer gAttackRenderer;
+
+const int GLYPH_FONT_SIZE = 20;   // "!" 按最大字号渲染一次，较小字号按比例缩放
+
+//子弹预警线：从子弹位置沿方向射到屏幕边缘（射线与边界相交）
+static Vector2 rayToScreenEdge(float x, float y, float directionX, float directionY)
+{
+	float t = FLT_MAX;
+	if (directionX > 0) t = (SCREEN_WIDTH - x) / directionX;
+	else if (directionX < 0) t = (-x) / directionX;
+
+	float tY = FLT_MAX;
+	if (directionY > 0) tY = (SCREEN_HEIGHT - y) / directionY;
+	else if (directionY < 0) tY = (-y) / directionY;
+
+	t = fminf(t, tY);
+	return { x + directionX * t, y + directionY * t };
+}
+
+//旋转三角形子弹的三个顶点，corners 已包含本帧插值所需的回退旋转
+static void bulletTriangle(const BounceBulletArray& b, int i, float x, float y, const TriangleCorners& corners, Vector2* points)
+{
+	float vx[3], vy[3];
+	corners.vertices(x, y, b.rotation[i], b.radius[i] * 2, vx, vy);
+	for (int k = 0; k < 3; k++)
+	{
+		points[k] = { vx[k], vy[k] };
+	}
+}
+
+static Vector2 bulletPosition(const BounceBulletArray& b, int i, float alpha)
+{
+	return { b.prevX[i] + (b.x[i] - b.prevX[i]) * alpha, b.prevY[i] + (b.y[i] - b.prevY[i]) * alpha };
+}
+
+AttackRenderer::AttackRenderer()
+	:glyph(), glyphLoaded(false), glyphWidth(0.0f), glyphHeight(0.0f)
+{
+	for (int k = 0; k <= ATTACK_CIRCLE_SEGMENTS; k++)
+	{
+		float angle = 2.0f * (float)M_PI * k / ATTACK_CIRCLE_SEGMENTS;
+		unitCos[k] = cosf(angle);
+		unitSin[k] = sinf(angle);
+	}
+}
+
+void AttackRenderer::loadGlyph()
+{
+	glyphWidth = (float)MeasureText("!", GLYPH_FONT_SIZE);
+	glyphHeight = (float)GLYPH_FONT_SIZE;
+	glyph = LoadRenderTexture((int)glyphWidth, (int)glyphHeight);
+	BeginTextureMode(glyph);
+	ClearBackground(BLANK);
+	DrawText("!", 0, 0, GLYPH_FONT_SIZE, WHITE);
+	EndTextureMode();
+	glyphLoaded = true;
+}
+
+void AttackRenderer::unload()
+{
+	if (glyphLoaded)
+	{
+		UnloadRenderTexture(glyph);
+		glyphLoaded = false;
+	}
+}
+
+void AttackRenderer::fillCircle(float cx, float cy, float r, Color color) const
+{
+	rlCheckRenderBatchLimit(3 * ATTACK_CIRCLE_SEGMENTS);
+	rlColor4ub(color.r, color.g, color.b, color.a);
+	for (int k = 0; k < ATTACK_CIRCLE_SEGMENTS; k++)
+	{
+		rlVertex2f(cx, cy);
+		rlVertex2f(cx + unitCos[k + 1] * r, cy + unitSin[k + 1] * r);
+		rlVertex2f(cx + unitCos[k] * r, cy + unitSin[k] * r);
+	}
+}
+
+void AttackRenderer::outlineCircle(float cx, float cy, float r, Color color) const
+{
+	rlCheckRenderBatchLimit(2 * ATTACK_CIRCLE_SEGMENTS);
+	rlColor4ub(color.r, color.g, color.b, color.a);
+	for (int k = 0; k < ATTACK_CIRCLE_SEGMENTS; k++)
+	{
+		rlVertex2f(cx + unitCos[k] * r, cy + unitSin[k] * r);
+		rlVertex2f(cx + unitCos[k + 1] * r, cy + unitSin[k + 1] * r);
+	}
+}
+
+//渲染纹理上下颠倒，纹理坐标的 v 从 1 到 0
+void AttackRenderer::glyphQuad(float x, float y, int size, Color color) const
+{
+	float scale = (float)size / GLYPH_FONT_SIZE;
+	float w = glyphWidth * scale;
+	float h = glyphHeight * scale;
+
+	rlCheckRenderBatchLimit(4);
+	rlColor4ub(color.r, color.g, color.b, color.a);
+	rlNormal3f(0.0f, 0.0f, 1.0f);
+	rlTexCoord2f(0.0f, 1.0f); rlVertex2f(x, y);
+	rlTexCoord2f(0.0f, 0.0f); rlVertex2f(x, y + h);
+	rlTexCoord2f(1.0f, 0.0f); rlVertex2f(x + w, y + h);
+	rlTexCoord2f(1.0f, 1.0f); rlVertex2f(x + w, y);
+}
+
+void AttackRenderer::fillCircles(const CircleAttackArray& a, Color fillColor) const
+{
+	for (int i = 0; i < a.size(); i++)
+	{
+		if (a.phase[i] == ACTIVE)
+		{
+			fillCircle((float)(int)a.x[i], (float)(int)a.y[i], a.radius[i], fillColor);
+		}
+	}
+}
+
+void AttackRenderer::outlineCircles(const CircleAttackArray& a, Color warningColor, Color lineColor) const
+{
+	for (int i = 0; i < a.size(); i++)
+	{
+		// 与原先一样按整数像素取圆心
+		float cx = (float)(int)a.x[i];
+		float cy = (float)(int)a.y[i];
+		if (a.phase[i] == WARNING)
+		{
+			outlineCircle(cx, cy, a.radius[i], warningColor);
+		}
+		else if (a.phase[i] == ACTIVE)
+		{
+			outlineCircle(cx, cy, a.radius[i], lineColor);
+		}
+		else
+		{
+			outlineCircle(cx, cy, a.radius[i], LIGHTGRAY);
+		}
+	}
+}
+
+void AttackRenderer::glyphCircles(const CircleAttackArray& a, int markSize, Color markColor) const
+{
+	for (int i = 0; i < a.size(); i++)
+	{
+		if (a.phase[i] == WARNING)
+		{
+			glyphQuad((float)((int)a.x[i] - 6), (float)((int)a.y[i] - 6), markSize, markColor);
+		}
+	}
+}
+
+void AttackRenderer::draw(const AttackPool& pool, float alpha)
+{
+	if (!glyphLoaded)
+	{
+		loadGlyph();
+	}
+
+	const CircleAttackArray& circles = pool.getCircleAttacks();
+	const CircleAttackArray& aimed = pool.getAimedCircleAttacks();
+	const BounceBulletArray& b = pool.getBounceBullets();
+	Color bulletLine = Fade(BLACK, 0.5f);
+
+	// 朝向只在逻辑帧更新，插值时按比例往回转；所有子弹转速相同，每帧只需算一次
+	TriangleCorners corners(Rotation::fromAngle(-b.rotationSpeed * (1.0f - alpha)));
+
+	// 1. 填充
+	rlBegin(RL_TRIANGLES);
+	fillCircles(circles, Fade(RED, 0.25f));
+	fillCircles(aimed, Fade(ORANGE, 0.3f));
+	for (int i = 0; i < b.size(); i++)
+	{
+		if (b.phase[i] == ACTIVE)
+		{
+			Vector2 p = bulletPosition(b, i, alpha);
+			Vector2 points[3];
+			bulletTriangle(b, i, p.x, p.y, corners, points);
+			rlCheckRenderBatchLimit(3);
+			rlColor4ub(ORANGE.r, ORANGE.g, ORANGE.b, ORANGE.a);
+			rlVertex2f(points[0].x, points[0].y);
+			rlVertex2f(points[1].x, points[1].y);
+			rlVertex2f(points[2].x, points[2].y);
+		}
+	}
+	rlEnd();
+
+	// 2. 线框
+	rlBegin(RL_LINES);
+	outlineCircles(circles, BLACK, RED);
+	outlineCircles(aimed, ORANGE, ORANGE);
+	for (int i = 0; i < b.size(); i++)
+	{
+		Vector2 p = bulletPosition(b, i, alpha);
+		if (b.phase[i] == WARNING)
+		{
+			Vector2 edge = rayToScreenEdge(p.x, p.y, b.directionX[i], b.directionY[i]);
+			rlCheckRenderBatchLimit(2);
+			rlColor4ub(bulletLine.r, bulletLine.g, bulletLine.b, bulletLine.a);
+			rlVertex2f(p.x, p.y);
+			rlVertex2f(edge.x, edge.y);
+		}
+		else if (b.phase[i] == ACTIVE)
+		{
+			Vector2 points[3];
+			bulletTriangle(b, i, p.x, p.y, corners, points);
+			rlCheckRenderBatchLimit(6);
+			rlColor4ub(ORANGE.r, ORANGE.g, ORANGE.b, ORANGE.a);
+			for (int k = 0; k < 3; k++)
+			{
+				rlVertex2f(points[k].x, points[k].y);
+				rlVertex2f(points[(k + 1) % 3].x, points[(k + 1) % 3].y);
+			}
+		}
+	}
+	rlEnd();
+
+	// 3. "!" 标记：圆形攻击的预警，以及子弹预警阶段在发射位置的提示
+	rlSetTexture(glyph.texture.id);
+	rlBegin(RL_QUADS);
+	glyphCircles(circles, 20, YELLOW);
+	glyphCircles(aimed, 16, ORANGE);
+	for (int i = 0; i < b.size(); i++)
+	{
+		if (b.phase[i] == WARNING)
+		{
+			Vector2 p = bulletPosition(b, i, alpha);
+			glyphQuad((float)((int)p.x - 6), (float)((int)p.y - 6), 20, YELLOW);
+		}
+	}
+	rlEnd();
+	rlSetTexture(0);
+}
+#endif
@@ -0,0 +1,47 @@
+﻿#pragma once
+
+#ifndef LUMIN_HEADLESS
+#include "raylib.h"
+#include "AttackPool.h"
+
+const int ATTACK_CIRCLE_SEGMENTS = 36;   // 与 raylib 的 DrawCircle / DrawCircleLines 相同
+
+//攻击批量绘制：按形状分组，每组只提交一个顶点批次
+//  1. 填充：ACTIVE 的圆形攻击与旋转三角形子弹（RL_TRIANGLES）
+//  2. 线框：预警圈、ACTIVE 圈的描边、子弹描边与预警线（RL_LINES）
+//  3. "!" 标记：预先渲染到纹理里，按四边形批量贴图（RL_QUADS）
+//取代原先每个攻击分别调用 DrawCircle / DrawCircleLines / DrawTriangle / DrawText，
+//避免图元类型与纹理在攻击之间来回切换导致批次被打断
+class AttackRenderer
+{
+private:
+	float unitCos[ATTACK_CIRCLE_SEGMENTS + 1];
+	float unitSin[ATTACK_CIRCLE_SEGMENTS + 1];
+	RenderTexture2D glyph;   // 白色的 "!"，绘制时按颜色着色
+	bool glyphLoaded;
+	float glyphWidth;
+	float glyphHeight;
+
+public:
+	AttackRenderer();
+
+	//绘制攻击池中的所有攻击，alpha 为逻辑帧之间的插值比例
+	void draw(const AttackPool& pool, float alpha);
+
+	//释放缓存的纹理，需在 CloseWindow 之前调用
+	void unload();
+
+private:
+	void loadGlyph();
+
+	void fillCircle(float cx, float cy, float r, Color color) const;
+	void outlineCircle(float cx, float cy, float r, Color color) const;
+	void glyphQuad(float x, float y, int size, Color color) const;
+
+	void fillCircles(const CircleAttackArray& a, Color fillColor) const;
+	void outlineCircles(const CircleAttackArray& a, Color warningColor, Color lineColor) const;
+	void glyphCircles(const CircleAttackArray& a, int markSize, Color markColor) const;
+};
+
+extern AttackRenderer gAttackRenderer;
+#endif
@@ -0,0 +1,1158 @@
+﻿// Benchmark.cpp : 命令行性能测试，不打开窗口
+//
+
+#define _CRT_SECURE_NO_WARNINGS
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <random>
+
+#include "GameConfig.h"
+#include "AttackPool.h"
+#include "CollisionKernel.h"
+#include "TrigCache.h"
+#include "Ecs.h"
+#include "EcsSystems.h"
+#include "Fight.h"
+#include "InputPolicy.h"
+#include "Random.h"
+#include "PatternLibrary.h"
+#include "Benchmark.h"
+
+namespace
+{
+	//固定种子的线性同余随机数，保证每次测试数据相同
+	struct BenchRandom
+	{
+		unsigned int state;
+
+		BenchRandom(unsigned int seed) :state(seed) {}
+
+		float next(float lo, float hi)
+		{
+			state = state * 1664525u + 1013904223u;
+			return lo + (hi - lo) * ((state >> 8) / 16777216.0f);
+		}
+	};
+
+	double nowSeconds()
+	{
+		using namespace std::chrono;
+		return duration<double>(steady_clock::now().time_since_epoch()).count();
+	}
+
+	//生成 count 个静止的反弹子弹并推进到 ACTIVE 阶段
+	//nearCount 个放在左侧查询区域 [0, 200) 内，其余放在右侧
+	void fillBullets(AttackPool& pool, int count, int nearCount, BenchRandom& rng)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			float x = (i < nearCount) ? rng.next(20.0f, 180.0f) : rng.next(220.0f, SCREEN_WIDTH - 20.0f);
+			float y = rng.next(20.0f, SCREEN_HEIGHT - 20.0f);
+			pool.spawnBounceBullet(x, y, 1.0f, 0.0f, 0.0f, 1000);
+		}
+		for (int i = 0; i <= 30; i++)
+		{
+			pool.update(0.0f, 0.0f);
+		}
+	}
+
+	//旧做法：逐个攻击检测
+	bool bruteForceHit(const AttackPool& pool, float px, float py, float* damage)
+	{
+		const BounceBulletArray& b = pool.getBounceBullets();
+		for (int i = 0; i < b.size(); i++)
+		{
+			if (b.checkCollision(i, px, py, PLAYER_SIZE))
+			{
+				*damage = b.damage[i];
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//网格查询开销与攻击总数的关系
+	void benchGrid()
+	{
+		printf("[grid] 玩家查询区域内固定 64 个子弹，其余子弹分布在场地右侧\n");
+		printf("%10s %14s %14s %10s\n", "attacks", "grid ns/query", "brute ns/query", "hits");
+
+		const int counts[] = { 100, 1000, 10000, 100000 };
+		for (int n : counts)
+		{
+			AttackPool pool(n);
+			BenchRandom rng(1234);
+			fillBullets(pool, n, 64, rng);
+
+			const int queries = 200000;
+			std::vector<float> qx(queries), qy(queries);
+			for (int i = 0; i < queries; i++)
+			{
+				qx[i] = rng.next(20.0f, 180.0f);
+				qy[i] = rng.next(20.0f, SCREEN_HEIGHT - 20.0f);
+			}
+
+			int hits = 0;
+			float dmg = 0.0f;
+			double t0 = nowSeconds();
+			for (int i = 0; i < queries; i++)
+			{
+				hits += pool.checkHit(qx[i], qy[i], PLAYER_SIZE, &dmg) ? 1 : 0;
+			}
+			double gridNs = (nowSeconds() - t0) * 1e9 / queries;
+
+			// 逐个检测太慢，按攻击数缩减查询次数
+			int bruteQueries = std::max(100, 20000000 / n);
+			int bruteHits = 0;
+			t0 = nowSeconds();
+			for (int i = 0; i < bruteQueries; i++)
+			{
+				bruteHits += bruteForceHit(pool, qx[i], qy[i], &dmg) ? 1 : 0;
+			}
+			double bruteNs = (nowSeconds() - t0) * 1e9 / bruteQueries;
+
+			printf("%10d %14.1f %14.1f %10d\n", n, gridNs, bruteNs, hits);
+		}
+	}
+
+	//原先的攻击写法：shared_ptr + 虚函数 + 开方，仅用于对比
+	class LegacyAttack
+	{
+	protected:
+		float x, y, radius, damage;
+
+	public:
+		LegacyAttack(float cx, float cy, float r, float dmg) :x(cx), y(cy), radius(r), damage(dmg) {}
+		virtual ~LegacyAttack() {}
+
+		virtual bool checkCollision(float playerX, float playerY, float playerSize)
+		{
+			float dx = playerX - x;
+			float dy = playerY - y;
+			return sqrtf(dx * dx + dy * dy) < (radius + playerSize / 2.0f);
+		}
+
+		float getDamage() const { return damage; }
+	};
+
+	class LegacyCircleAttack : public LegacyAttack
+	{
+	public:
+		LegacyCircleAttack(float cx, float cy, float r, float dmg) :LegacyAttack(cx, cy, r, dmg) {}
+	};
+
+	class LegacyBulletAttack : public LegacyAttack
+	{
+	public:
+		LegacyBulletAttack(float cx, float cy, float dmg) :LegacyAttack(cx, cy, 10.0f, dmg) {}
+	};
+
+	//批量检测与逐对象虚函数检测的对比
+	void benchCollision()
+	{
+		printf("[collision] 批量检测内核: %s\n", collisionKernelName());
+		printf("%10s %16s %16s %8s\n", "attacks", "virtual ns/atk", "batch ns/atk", "speedup");
+
+		const int counts[] = { 16, 256, 4096, 65536 };
+		for (int n : counts)
+		{
+			BenchRandom rng(99);
+			std::vector<std::shared_ptr<LegacyAttack>> legacy;
+			std::vector<float> xs(n), ys(n), rs(n), dmg(n);
+			for (int i = 0; i < n; i++)
+			{
+				xs[i] = rng.next(0.0f, (float)SCREEN_WIDTH);
+				ys[i] = rng.next(0.0f, (float)SCREEN_HEIGHT);
+				bool bullet = (i % 4 != 0);
+				rs[i] = bullet ? 10.0f : 50.0f;
+				dmg[i] = bullet ? 15.0f : 10.0f;
+				if (bullet)
+				{
+					legacy.push_back(std::make_shared<LegacyBulletAttack>(xs[i], ys[i], dmg[i]));
+				}
+				else
+				{
+					legacy.push_back(std::make_shared<LegacyCircleAttack>(xs[i], ys[i], rs[i], dmg[i]));
+				}
+			}
+
+			const int rounds = std::max(20, 20000000 / n);
+			std::vector<unsigned int> mask((n + 31) / 32);
+
+			// 两种做法使用同一组玩家位置，伤害总和应一致
+			const int positions = 1024;
+			std::vector<float> qx(positions), qy(positions);
+			for (int i = 0; i < positions; i++)
+			{
+				qx[i] = rng.next(0.0f, (float)SCREEN_WIDTH);
+				qy[i] = rng.next(0.0f, (float)SCREEN_HEIGHT);
+			}
+
+			float legacyDamage = 0.0f;
+			double t0 = nowSeconds();
+			for (int r = 0; r < rounds; r++)
+			{
+				float px = qx[r % positions];
+				float py = qy[r % positions];
+				for (auto& atk : legacy)
+				{
+					if (atk->checkCollision(px, py, PLAYER_SIZE))
+					{
+						legacyDamage += atk->getDamage();
+					}
+				}
+			}
+			double legacyNs = (nowSeconds() - t0) * 1e9 / ((double)rounds * n);
+
+			float batchDamage = 0.0f;
+			t0 = nowSeconds();
+			for (int r = 0; r < rounds; r++)
+			{
+				float px = qx[r % positions];
+				float py = qy[r % positions];
+				float d = 0.0f;
+				circleHitBatch(xs.data(), ys.data(), rs.data(), dmg.data(), n, px, py, PLAYER_SIZE / 2.0f, mask.data(), &d);
+				batchDamage += d;
+			}
+			double batchNs = (nowSeconds() - t0) * 1e9 / ((double)rounds * n);
+
+			printf("%10d %16.2f %16.2f %7.1fx   (damage %.0f / %.0f)\n", n, legacyNs, batchNs, legacyNs / batchNs, legacyDamage, batchDamage);
+		}
+	}
+
+	//子弹三角形顶点生成：逐顶点 cosf/sinf 与旋转缓存的对比
+	void benchTrig()
+	{
+		const int n = 10000;
+		const int rounds = 200;
+		const float triSize = 20.0f;
+		const float rotationSpeed = 0.1f;
+		printf("[trig] %d 颗子弹，%d 轮\n", n, rounds);
+
+		BenchRandom rng(7);
+		std::vector<float> xs(n), ys(n), angles(n);
+		std::vector<Rotation> rotations(n);
+		for (int i = 0; i < n; i++)
+		{
+			xs[i] = rng.next(0.0f, (float)SCREEN_WIDTH);
+			ys[i] = rng.next(0.0f, (float)SCREEN_HEIGHT);
+			angles[i] = rng.next(0.0f, 2.0f * (float)M_PI);
+			rotations[i] = Rotation::fromAngle(angles[i]);
+		}
+		std::vector<float> oldVx(3 * n), oldVy(3 * n), newVx(3 * n), newVy(3 * n);
+
+		// 旧做法：每颗子弹 6 次三角函数
+		double t0 = nowSeconds();
+		for (int r = 0; r < rounds; r++)
+		{
+			float alpha = (r % 16) / 16.0f;
+			for (int i = 0; i < n; i++)
+			{
+				float rotation = angles[i] - rotationSpeed * (1.0f - alpha);
+				oldVx[3 * i + 0] = xs[i] + cosf(rotation) * triSize;
+				oldVy[3 * i + 0] = ys[i] + sinf(rotation) * triSize;
+				oldVx[3 * i + 1] = xs[i] + cosf(rotation + 2 * (float)M_PI / 3) * triSize;
+				oldVy[3 * i + 1] = ys[i] + sinf(rotation + 2 * (float)M_PI / 3) * triSize;
+				oldVx[3 * i + 2] = xs[i] + cosf(rotation + 4 * (float)M_PI / 3) * triSize;
+				oldVy[3 * i + 2] = ys[i] + sinf(rotation + 4 * (float)M_PI / 3) * triSize;
+			}
+		}
+		double oldNs = (nowSeconds() - t0) * 1e9 / ((double)rounds * n);
+
+		// 新做法：每帧算一次回退旋转，每颗子弹只做复数乘法
+		t0 = nowSeconds();
+		for (int r = 0; r < rounds; r++)
+		{
+			float alpha = (r % 16) / 16.0f;
+			TriangleCorners corners(Rotation::fromAngle(-rotationSpeed * (1.0f - alpha)));
+			for (int i = 0; i < n; i++)
+			{
+				corners.vertices(xs[i], ys[i], rotations[i], triSize, &newVx[3 * i], &newVy[3 * i]);
+			}
+		}
+		double newNs = (nowSeconds() - t0) * 1e9 / ((double)rounds * n);
+
+		// 两种做法最后一轮的 alpha 相同，顶点应几乎重合
+		float maxError = 0.0f;
+		for (int k = 0; k < 3 * n; k++)
+		{
+			maxError = std::max(maxError, std::max(fabsf(oldVx[k] - newVx[k]), fabsf(oldVy[k] - newVy[k])));
+		}
+
+		// 逻辑帧里逐帧累乘的朝向与直接按角度计算的偏差
+		Rotation step = Rotation::fromAngle(rotationSpeed);
+		Rotation accumulated = { 1.0f, 0.0f };
+		const int frames = 60 * 60 * 10;
+		for (int f = 0; f < frames; f++)
+		{
+			accumulated = (accumulated * step).renormalized();
+		}
+		Rotation direct = Rotation::fromAngle(fmodf(rotationSpeed * frames, 2.0f * (float)M_PI));
+		float drift = fabsf(accumulated.c - direct.c) + fabsf(accumulated.s - direct.s);
+
+		printf("%16s %16s %8s\n", "trig ns/bullet", "cache ns/bullet", "speedup");
+		printf("%16.2f %16.2f %7.1fx   (max vertex error %.5f px, drift after %d frames %.5f)\n",
+			oldNs, newNs, oldNs / newNs, maxError, frames, drift);
+	}
+
+	//旧做法：每个角色一个堆对象，通过虚函数各自更新无敌帧
+	class LegacyActor
+	{
+	public:
+		float x, y, prevX, prevY;
+		float hp, maxHp;
+		bool damageCooldown;
+		int damageTimer;
+
+		LegacyActor(float cx, float cy)
+			:x(cx), y(cy), prevX(cx), prevY(cy), hp(100), maxHp(100), damageCooldown(false), damageTimer(35) {
+		}
+		virtual ~LegacyActor() {}
+
+		virtual void update()
+		{
+			prevX = x;
+			prevY = y;
+			if (damageCooldown)
+			{
+				damageTimer--;
+				if (damageTimer <= 0)
+				{
+					damageCooldown = false;
+					damageTimer = 35;
+				}
+			}
+		}
+
+		void takeDamage(float damage)
+		{
+			if (!damageCooldown)
+			{
+				hp -= damage;
+				damageCooldown = true;
+				if (hp < 0) hp = 0;
+			}
+		}
+	};
+
+	//每轮：全部角色更新一次，其中 1/8 受到伤害；返回每个角色的平均纳秒数
+	double runLegacyActors(std::vector<LegacyActor*>& actors, int rounds)
+	{
+		int n = (int)actors.size();
+		double t0 = nowSeconds();
+		for (int r = 0; r < rounds; r++)
+		{
+			for (LegacyActor* a : actors)
+			{
+				a->update();
+			}
+			for (int i = r % 8; i < n; i += 8)
+			{
+				actors[i]->takeDamage(1.0f);
+			}
+		}
+		return (nowSeconds() - t0) * 1e9 / ((double)rounds * n);
+	}
+
+	//ECS：同样的角色放进一个原型，系统线性遍历连续数组
+	void benchEcs()
+	{
+		const int n = 20000;
+		const int rounds = 500;
+		BenchRandom rng(11);
+
+		// 旧做法的对象分两组：连续分配的（最理想的情况）和与其他分配交错的（长时间运行后的常态）
+		std::vector<std::unique_ptr<LegacyActor>> owned;
+		std::vector<std::unique_ptr<char[]>> filler;
+		std::vector<LegacyActor*> packed, scattered;
+		EcsWorld world;
+		std::vector<Entity> entities;
+		for (int i = 0; i < n; i++)
+		{
+			float x = rng.next(0.0f, (float)SCREEN_WIDTH), y = rng.next(0.0f, (float)SCREEN_HEIGHT);
+			owned.push_back(std::unique_ptr<LegacyActor>(new LegacyActor(x, y)));
+			packed.push_back(owned.back().get());
+			Entity e = world.create(CHARACTER_COMPONENTS);
+			world.get<Transform>(e) = { x, y, x, y };
+			world.get<Health>(e) = { 100, 100 };
+			world.get<DamageCooldown>(e) = { false, 35, 35 };
+			entities.push_back(e);
+		}
+		for (int i = 0; i < n; i++)
+		{
+			filler.push_back(std::unique_ptr<char[]>(new char[16 + (int)rng.next(0.0f, 200.0f)]));
+			owned.push_back(std::unique_ptr<LegacyActor>(new LegacyActor(packed[i]->x, packed[i]->y)));
+			scattered.push_back(owned.back().get());
+		}
+
+		double packedNs = runLegacyActors(packed, rounds);
+		double scatteredNs = runLegacyActors(scattered, rounds);
+
+		double t0 = nowSeconds();
+		for (int r = 0; r < rounds; r++)
+		{
+			storePreviousPositions(world);
+			updateDamageCooldowns(world);
+			for (int i = r % 8; i < n; i += 8)
+			{
+				applyDamage(world, entities[i], 1.0f);
+			}
+		}
+		double newNs = (nowSeconds() - t0) * 1e9 / ((double)rounds * n);
+
+		// 相同的伤害序列下生命值应完全一致
+		int mismatches = 0;
+		for (int i = 0; i < n; i++)
+		{
+			if (packed[i]->hp != world.get<Health>(entities[i]).hp)
+			{
+				mismatches++;
+			}
+		}
+
+		// 短寿命实体：反复生成与销毁，检查原型数组的增删开销
+		EcsWorld shortLived;
+		t0 = nowSeconds();
+		for (int r = 0; r < rounds; r++)
+		{
+			for (int k = 0; k < 40; k++)
+			{
+				Entity e = shortLived.create(MELEE_ATTACK_COMPONENTS);
+				shortLived.get<Lifetime>(e) = { 15 + k % 10 };
+			}
+			updateAttackStates(shortLived);
+			updateLifetimes(shortLived);
+		}
+		double lifetimeNs = (nowSeconds() - t0) * 1e9 / ((double)rounds * 40);
+
+		printf("%14s %14s %14s   (ns/entity per frame, %d entities)\n", "virtual", "virtual", "system", n);
+		printf("%14s %14s %14s\n", "packed", "scattered", "archetype");
+		printf("%14.2f %14.2f %14.2f   (hp mismatches %d, spawn+expire %.1f ns/entity, %d alive)\n",
+			packedNs, scatteredNs, newNs, mismatches, lifetimeNs, shortLived.entityCount());
+	}
+
+	//多人混战：8 个随机犯错的脚本玩家对 4 个 Boss，统计每个逻辑帧的耗时是否留在 60 FPS 的帧预算内
+	void benchArena()
+	{
+		const int playerCount = 8;
+		const int bossCount = 4;
+		const int frames = LOGIC_TICK_RATE * 60;
+		Boss01Tuning tuning;
+		// 加厚 Boss 血量、降低伤害并缩短攻击间隔，让整段测试尽量在满员、攻击密集的状态下进行
+		tuning.maxHp = 20000.0f;
+		tuning.circleDamage = 1.0f;
+		tuning.aimedDamage = 1.0f;
+		tuning.attackDelay = 60;
+
+		Fight fight(tuning, playerCount, bossCount);
+		std::vector<std::unique_ptr<InputPolicy>> policies;
+		for (int i = 0; i < playerCount; i++)
+		{
+			policies.push_back(makeInputPolicy("sloppy", 100 + i, i));
+		}
+
+		std::vector<PlayerInput> inputs(playerCount);
+		std::vector<double> tickMs;
+		int peakAttacks = 0;
+		long long attackSum = 0;
+		while (!fight.isOver() && fight.getFrame() < frames)
+		{
+			double t0 = nowSeconds();
+			for (int i = 0; i < playerCount; i++)
+			{
+				inputs[i] = policies[i]->next(fight);
+			}
+			fight.tick(inputs.data());
+			tickMs.push_back((nowSeconds() - t0) * 1000.0);
+
+			int attacks = fight.getAttackCount();
+			peakAttacks = std::max(peakAttacks, attacks);
+			attackSum += attacks;
+		}
+
+		int alive = 0;
+		for (int i = 0; i < playerCount; i++)
+		{
+			alive += fight.getPlayer(i).getHp() > 0 ? 1 : 0;
+		}
+		double total = 0.0;
+		for (double t : tickMs)
+		{
+			total += t;
+		}
+		int n = (int)tickMs.size();
+		std::vector<double> sorted = tickMs;
+		std::sort(sorted.begin(), sorted.end());
+
+		printf("%d players x %d bosses, %d ticks (players alive at end: %d)\n", playerCount, bossCount, n, alive);
+		printf("%14s %14s %14s %14s %14s\n", "avg ms", "p99 ms", "max ms", "avg attacks", "peak attacks");
+		printf("%14.4f %14.4f %14.4f %14.1f %14d   (budget %.2f ms)\n",
+			total / std::max(1, n), sorted[std::min(n - 1, n * 99 / 100)], sorted[n - 1],
+			attackSum / (double)std::max(1, n), peakAttacks, 1000.0 / LOGIC_TICK_RATE);
+	}
+
+	//快照：在攻击最密集的时候比较整场拷贝与快照保存/恢复的耗时，并检查恢复后继续模拟的结果与原局逐位一致
+	void benchSnapshot()
+	{
+		const int playerCount = 8;
+		const int bossCount = 4;
+		const int rounds = 20000;
+		Boss01Tuning tuning;
+		tuning.maxHp = 20000.0f;
+		tuning.circleDamage = 1.0f;
+		tuning.aimedDamage = 1.0f;
+		tuning.attackDelay = 60;
+
+		// 先跑到场上攻击最多的那一帧
+		Fight fight(tuning, playerCount, bossCount);
+		std::vector<std::unique_ptr<InputPolicy>> policies;
+		for (int i = 0; i < playerCount; i++)
+		{
+			policies.push_back(makeInputPolicy("sloppy", 100 + i, i));
+		}
+		std::vector<PlayerInput> inputs(playerCount);
+		auto step = [&](Fight& f)
+		{
+			for (int i = 0; i < playerCount; i++)
+			{
+				inputs[i] = policies[i]->next(f);
+			}
+			f.tick(inputs.data());
+		};
+		while (fight.getFrame() < 240 || fight.getAttackCount() < 40)
+		{
+			step(fight);
+		}
+
+		Fight copy = fight;
+		double t0 = nowSeconds();
+		for (int r = 0; r < rounds; r++)
+		{
+			copy = fight;
+		}
+		double copyNs = (nowSeconds() - t0) * 1e9 / rounds;
+
+		FightSnapshot snapshot;
+		t0 = nowSeconds();
+		for (int r = 0; r < rounds; r++)
+		{
+			fight.save(snapshot);
+		}
+		double saveNs = (nowSeconds() - t0) * 1e9 / rounds;
+
+		Fight branch(tuning, playerCount, bossCount);
+		bool ok = true;
+		t0 = nowSeconds();
+		for (int r = 0; r < rounds; r++)
+		{
+			ok = branch.restore(snapshot) && ok;
+		}
+		double restoreNs = (nowSeconds() - t0) * 1e9 / rounds;
+
+		// 恢复后的分支与原局同样输入继续跑 600 帧，哈希须一致；策略自带随机数，按同一种子各建一份
+		FightSnapshot again;
+		branch.save(again);
+		bool sameBytes = again.size() == snapshot.size() && memcmp(again.data(), snapshot.data(), snapshot.size()) == 0;
+		std::vector<std::unique_ptr<InputPolicy>> saved;
+		saved.swap(policies);
+		for (int pass = 0; pass < 2; pass++)
+		{
+			for (int i = 0; i < playerCount; i++)
+			{
+				policies.push_back(makeInputPolicy("sloppy", 7 + i, i));
+			}
+			Fight& target = (pass == 0) ? fight : branch;
+			for (int f = 0; f < 600; f++)
+			{
+				step(target);
+			}
+			policies.clear();
+		}
+		bool sameRun = fight.stateHash() == branch.stateHash();
+
+		printf("%d players x %d bosses, %d attacks, %d entities, snapshot %zu bytes\n",
+			playerCount, bossCount, fight.getAttackCount(), fight.getWorld().entityCount(), snapshot.size());
+		printf("%14s %14s %14s\n", "copy ns", "save ns", "restore ns");
+		printf("%14.0f %14.0f %14.0f   (restore %s, bytes %s, 600-frame branch %s)\n", copyNs, saveNs, restoreNs,
+			ok ? "ok" : "FAILED", sameBytes ? "identical" : "DIFFER", sameRun ? "identical" : "DIFFERS");
+	}
+
+	//改用出招脚本之前 Boss01 手写的出招状态机，原样保留作对照
+	class LegacyBoss
+	{
+	protected:
+		float x, y;
+		int attackDelay;
+		AttackPool attacks;
+
+	public:
+		LegacyBoss(float cx, float cy)
+			:x(cx), y(cy), attackDelay(0) {
+		}
+		virtual ~LegacyBoss() {}
+
+		virtual void update(float playerX, float playerY) = 0;
+		virtual void doAttack(float playerX, float playerY) = 0;
+		virtual int getAttackDelay() = 0;
+
+		const AttackPool& getAttacks() const
+		{
+			return attacks;
+		}
+	};
+
+	class LegacyBoss01 : public LegacyBoss
+	{
+	private:
+		Boss01Tuning tuning;
+		int attackPattern;
+		int aimedAttackCounter;
+		bool isDoingAimedAttack;
+		int chainAttackInterval;
+
+	public:
+		LegacyBoss01(float cx, float cy, const Boss01Tuning& t)
+			:LegacyBoss(cx, cy), tuning(t), attackPattern(0), aimedAttackCounter(0), isDoingAimedAttack(false), chainAttackInterval(0)
+		{
+			attackDelay = getAttackDelay() / 2;
+		}
+
+		virtual void update(float playerX, float playerY) override
+		{
+			if (isDoingAimedAttack)
+			{
+				if (chainAttackInterval > 0)
+				{
+					chainAttackInterval--;
+				}
+				else
+				{
+					doAimedAttack(playerX, playerY);
+				}
+			}
+			else
+			{
+				if (attackDelay > 0)
+				{
+					attackDelay--;
+				}
+				if (attackDelay == 0)
+				{
+					doAttack(playerX, playerY);
+					attackDelay = getAttackDelay();
+				}
+			}
+			attacks.update(playerX, playerY);
+		}
+
+		void doAimedAttack(float playerX, float playerY)
+		{
+			attacks.spawnAimedCircle(playerX, playerY, tuning.aimedRadius, tuning.aimedDamage);
+			aimedAttackCounter++;
+			if (aimedAttackCounter >= tuning.aimedChainCount)
+			{
+				isDoingAimedAttack = false;
+				aimedAttackCounter = 0;
+				attackDelay = getAttackDelay();
+			}
+			else
+			{
+				chainAttackInterval = tuning.aimedChainInterval;
+			}
+		}
+
+		void spawnSpread(float playerX, float playerY)
+		{
+			float dx = playerX - x;
+			float dy = playerY - y;
+			float dist = sqrtf(dx * dx + dy * dy);
+			if (dist > 0)
+			{
+				dx /= dist;
+				dy /= dist;
+			}
+			for (int i = -1; i <= 1; i++)
+			{
+				float angleOffset = i * tuning.bulletSpread;
+				float dirX = dx * cosf(angleOffset) - dy * sinf(angleOffset);
+				float dirY = dx * sinf(angleOffset) + dy * cosf(angleOffset);
+				attacks.spawnBounceBullet(x, y, dirX, dirY, tuning.bulletSpeed, tuning.bulletMaxBounces);
+			}
+		}
+
+		virtual void doAttack(float playerX, float playerY) override
+		{
+			float dx = playerX - x;
+			float dy = playerY - y;
+			float distance = sqrtf(dx * dx + dy * dy);
+			if (attackPattern % 3 == 0)
+			{
+				spawnSpread(playerX, playerY);
+			}
+			else if (distance > tuning.nearDistance)
+			{
+				isDoingAimedAttack = true;
+				aimedAttackCounter = 0;
+				chainAttackInterval = 0;
+			}
+			else
+			{
+				attacks.spawnCircle(x, y, tuning.circleRadius, tuning.circleDamage);
+			}
+			attackPattern++;
+		}
+
+		virtual int getAttackDelay() override
+		{
+			return tuning.attackDelay;
+		}
+	};
+
+	uint64_t poolHash(const AttackPool& pool, FightSnapshot& scratch)
+	{
+		{
+			SnapshotWriter out(scratch);
+			pool.save(out);
+		}
+		return scratch.hash();
+	}
+
+	//出招脚本：内置脚本与原先手写的状态机逐帧比较生成的攻击（多组参数、目标远近来回变化），再比较每次 update 的耗时
+	void benchPattern()
+	{
+		const float bossX = SCREEN_WIDTH / 2.0f, bossY = 120.0f;
+		// 目标绕 Boss 转圈，半径在 40 到 360 之间往复，反复跨过近身距离
+		auto target = [&](int f, float* tx, float* ty)
+		{
+			float radius = 200.0f + 160.0f * sinf(f * 0.013f);
+			*tx = bossX + radius * cosf(f * 0.021f);
+			*ty = bossY + radius * sinf(f * 0.021f);
+		};
+
+		std::vector<Boss01Tuning> tunings(7);
+		tunings[1].attackDelay = 60;
+		tunings[2].attackDelay = 1;
+		tunings[3].attackDelay = 0;
+		tunings[4].aimedChainCount = 1;
+		tunings[4].nearDistance = 250.0f;
+		tunings[5].aimedChainInterval = 0;
+		tunings[5].aimedChainCount = 3;
+		tunings[6].attackDelay = 37;
+		tunings[6].bulletSpread = 0.5f;
+
+		const int frames = 4000;
+		int mismatches = 0;
+		long long spawned = 0;
+		FightSnapshot a, b;
+		for (const Boss01Tuning& t : tunings)
+		{
+			EcsWorld world;
+			Boss01 boss(&world, bossX, bossY, t);
+			LegacyBoss01 legacy(bossX, bossY, t);
+			for (int f = 0; f < frames; f++)
+			{
+				float tx, ty;
+				target(f, &tx, &ty);
+				boss.update(tx, ty, 100.0f);
+				legacy.update(tx, ty);
+				if (poolHash(boss.getAttacks(), a) != poolHash(legacy.getAttacks(), b))
+				{
+					mismatches++;
+				}
+			}
+			spawned += boss.getAttacks().size();
+		}
+
+		// 耗时：64 个 Boss 各跑同样的帧，包含攻击更新（两边相同），差值即出招逻辑的开销
+		const int bossCount = 64;
+		Boss01Tuning fast;
+		fast.attackDelay = 30;
+		EcsWorld world;
+		std::vector<Boss01> bosses;
+		std::vector<std::unique_ptr<LegacyBoss>> legacies;
+		for (int i = 0; i < bossCount; i++)
+		{
+			bosses.push_back(Boss01(&world, bossX, bossY, fast));
+			legacies.emplace_back(new LegacyBoss01(bossX, bossY, fast));
+		}
+		double t0 = nowSeconds();
+		for (int f = 0; f < frames; f++)
+		{
+			float tx, ty;
+			target(f, &tx, &ty);
+			for (auto& l : legacies)
+			{
+				l->update(tx, ty);
+			}
+		}
+		double legacyNs = (nowSeconds() - t0) * 1e9 / ((double)frames * bossCount);
+		t0 = nowSeconds();
+		for (int f = 0; f < frames; f++)
+		{
+			float tx, ty;
+			target(f, &tx, &ty);
+			for (Boss01& boss : bosses)
+			{
+				boss.update(tx, ty, 100.0f);
+			}
+		}
+		double scriptNs = (nowSeconds() - t0) * 1e9 / ((double)frames * bossCount);
+
+		const PatternProgram& program = boss01DefaultPattern();
+		printf("default pattern: %zu bytes of code, %zu operands, %zu-byte state per boss\n",
+			program.code.size(), program.operands.size(), sizeof(PatternState));
+		printf("%d tunings x %d frames, %lld attacks alive at end: %s (%d mismatching frames)\n",
+			(int)tunings.size(), frames, spawned, mismatches == 0 ? "identical to legacy" : "DIFFERS", mismatches);
+		printf("%14s %14s\n", "legacy ns", "script ns");
+		printf("%14.1f %14.1f   (per boss update, attack update included)\n", legacyNs, scriptNs);
+	}
+
+	//随机数：Philox 已知答案校验，以及各种抽取方式每次的耗时（与标准库 mt19937 对照）
+	void benchRandom()
+	{
+		// Random123 给出的 philox4x32-10 参考输出
+		uint32_t ctr[4] = { 0x243F6A88u, 0x85A308D3u, 0x13198A2Eu, 0x03707344u };
+		uint32_t key[2] = { 0xA4093822u, 0x299F31D0u };
+		uint32_t out[4];
+		RandomStream::philox(ctr, key, out);
+		bool known = out[0] == 0xD16CFE09u && out[1] == 0x94FDCCEBu && out[2] == 0x5001E420u && out[3] == 0x24126EA1u;
+
+		const int n = 20000000;
+		RandomStream rng(12345, randomStream(RANDOM_BOSS, 0));
+		uint32_t sink = 0;
+		double t0 = nowSeconds();
+		for (int i = 0; i < n; i++)
+		{
+			sink += rng.next32();
+		}
+		double next32Ns = (nowSeconds() - t0) * 1e9 / n;
+
+		float fsink = 0.0f;
+		t0 = nowSeconds();
+		for (int i = 0; i < n; i++)
+		{
+			fsink += rng.nextFloat();
+		}
+		double floatNs = (nowSeconds() - t0) * 1e9 / n;
+
+		t0 = nowSeconds();
+		for (int i = 0; i < n; i++)
+		{
+			sink += (uint32_t)rng.nextInt(-4, 4);
+		}
+		double intNs = (nowSeconds() - t0) * 1e9 / n;
+
+		uint64_t wsink = 0;
+		t0 = nowSeconds();
+		for (int i = 0; i < n; i++)
+		{
+			wsink += RandomStream::at(12345, randomStream(RANDOM_FIGHT_SEED, 0), (uint64_t)i);
+		}
+		double atNs = (nowSeconds() - t0) * 1e9 / n;
+
+		std::mt19937 mt(12345);
+		t0 = nowSeconds();
+		for (int i = 0; i < n; i++)
+		{
+			sink += mt();
+		}
+		double mtNs = (nowSeconds() - t0) * 1e9 / n;
+
+		// 同一个流抽到一半拷贝出去，两份之后的结果须相同（快照恢复依赖这一点）
+		RandomStream a(7, randomStream(RANDOM_BOSS, 3));
+		a.next32();
+		RandomStream b = a;
+		bool copyable = true;
+		for (int i = 0; i < 1000; i++)
+		{
+			copyable = (a.next32() == b.next32()) && copyable;
+		}
+
+		printf("philox4x32-10 known answer: %s, copied stream: %s, state %zu bytes (checksum %08x %.1f %llx)\n",
+			known ? "ok" : "WRONG", copyable ? "same" : "DIFFERS", sizeof(RandomStream), sink, fsink, (unsigned long long)wsink);
+		printf("%14s %14s %14s %14s %14s\n", "next32 ns", "nextFloat ns", "nextInt ns", "at() ns", "mt19937 ns");
+		printf("%14.2f %14.2f %14.2f %14.2f %14.2f\n", next32Ns, floatNs, intNs, atNs, mtNs);
+	}
+
+	//原先逐颗子弹的更新（计时、移动、旋转、撞墙、销毁挨个做）与逐元素压缩，保留下来对照批量版本
+	void legacyBulletUpdate(BounceBulletArray& b)
+	{
+		for (int i = 0; i < b.size(); i++)
+		{
+			b.timer[i]++;
+			b.prevX[i] = b.x[i];
+			b.prevY[i] = b.y[i];
+			if (b.phase[i] == WARNING && b.timer[i] > b.warningTime)
+			{
+				b.phase[i] = ACTIVE;
+				b.timer[i] = 0;
+			}
+			else if (b.phase[i] == ACTIVE)
+			{
+				b.x[i] += b.directionX[i] * b.speed[i];
+				b.y[i] += b.directionY[i] * b.speed[i];
+				b.rotation[i] = (b.rotation[i] * b.rotationStep).renormalized();
+
+				float r = b.radius[i];
+				if (b.x[i] - r < 0)
+				{
+					b.x[i] = r;
+					b.directionX[i] = -b.directionX[i];
+					b.bounceCount[i]++;
+				}
+				else if (b.x[i] + r > SCREEN_WIDTH)
+				{
+					b.x[i] = SCREEN_WIDTH - r;
+					b.directionX[i] = -b.directionX[i];
+					b.bounceCount[i]++;
+				}
+				if (b.y[i] - r < 0)
+				{
+					b.y[i] = r;
+					b.directionY[i] = -b.directionY[i];
+					b.bounceCount[i]++;
+				}
+				else if (b.y[i] + r > SCREEN_HEIGHT)
+				{
+					b.y[i] = SCREEN_HEIGHT - r;
+					b.directionY[i] = -b.directionY[i];
+					b.bounceCount[i]++;
+				}
+				if (b.bounceCount[i] >= b.maxBounces[i]
+					|| b.x[i] < -50 || b.x[i] > SCREEN_WIDTH + 50 || b.y[i] < -50 || b.y[i] > SCREEN_HEIGHT + 50)
+				{
+					b.phase[i] = COOLDOWN;
+				}
+			}
+		}
+		// 原先的逐元素压缩
+		int n = b.size();
+		int w = 0;
+		for (int i = 0; i < n; i++)
+		{
+			if (b.phase[i] == COOLDOWN)
+			{
+				continue;
+			}
+			if (w != i)
+			{
+				b.x[w] = b.x[i];
+				b.y[w] = b.y[i];
+				b.prevX[w] = b.prevX[i];
+				b.prevY[w] = b.prevY[i];
+				b.radius[w] = b.radius[i];
+				b.damage[w] = b.damage[i];
+				b.timer[w] = b.timer[i];
+				b.phase[w] = b.phase[i];
+				b.seq[w] = b.seq[i];
+				b.speed[w] = b.speed[i];
+				b.directionX[w] = b.directionX[i];
+				b.directionY[w] = b.directionY[i];
+				b.bounceCount[w] = b.bounceCount[i];
+				b.maxBounces[w] = b.maxBounces[i];
+				b.rotation[w] = b.rotation[i];
+				b.homing[w] = b.homing[i];
+			}
+			w++;
+		}
+		if (w != n)
+		{
+			b.x.resize(w);
+			b.y.resize(w);
+			b.prevX.resize(w);
+			b.prevY.resize(w);
+			b.radius.resize(w);
+			b.damage.resize(w);
+			b.timer.resize(w);
+			b.phase.resize(w);
+			b.seq.resize(w);
+			b.speed.resize(w);
+			b.directionX.resize(w);
+			b.directionY.resize(w);
+			b.bounceCount.resize(w);
+			b.maxBounces.resize(w);
+			b.rotation.resize(w);
+			b.homing.resize(w);
+		}
+	}
+
+	uint64_t bulletHash(const BounceBulletArray& b, FightSnapshot& scratch)
+	{
+		{
+			SnapshotWriter out(scratch);
+			b.save(out);
+		}
+		return scratch.hash();
+	}
+
+	//弹幕：批量子弹更新与逐颗更新逐帧比较，再比较每帧耗时；最后用 stress 脚本跑满屏子弹的整场战斗，看能否守住 60 FPS
+	void benchBullets()
+	{
+		// 一万颗子弹，每帧补充被销毁的部分，保持数量不变
+		const int bulletCount = 10000;
+		const int frames = 600;
+		BenchRandom rnd(2024);
+		auto refill = [&](BounceBulletArray& b, unsigned int& seq)
+		{
+			while (b.size() < bulletCount)
+			{
+				float angle = rnd.next(0.0f, (float)(2.0 * M_PI));
+				b.push(seq++, rnd.next(20.0f, SCREEN_WIDTH - 20.0f), rnd.next(20.0f, SCREEN_HEIGHT - 20.0f),
+					cosf(angle), sinf(angle), rnd.next(2.0f, 12.0f), (int)rnd.next(1.0f, 6.0f), 1.0f);
+			}
+		};
+
+		BounceBulletArray batched(bulletCount), legacy(bulletCount);
+		unsigned int seqA = 0, seqB = 0;
+		FightSnapshot a, b;
+		int mismatches = 0;
+		BenchRandom start = rnd;
+		for (int f = 0; f < frames; f++)
+		{
+			BenchRandom frameRnd = rnd;
+			refill(batched, seqA);
+			rnd = frameRnd;
+			refill(legacy, seqB);
+			batched.update(0.0f, 0.0f);
+			legacyBulletUpdate(legacy);
+			if (bulletHash(batched, a) != bulletHash(legacy, b))
+			{
+				mismatches++;
+			}
+		}
+
+		// 耗时：同样的子弹各自重跑一遍（补充子弹的开销两边相同）
+		rnd = start;
+		BounceBulletArray timedBatched(bulletCount), timedLegacy(bulletCount);
+		seqA = seqB = 0;
+		double batchedTime = 0.0, legacyTime = 0.0;
+		for (int f = 0; f < frames; f++)
+		{
+			BenchRandom frameRnd = rnd;
+			refill(timedBatched, seqA);
+			rnd = frameRnd;
+			refill(timedLegacy, seqB);
+			double t0 = nowSeconds();
+			timedBatched.update(0.0f, 0.0f);
+			double t1 = nowSeconds();
+			legacyBulletUpdate(timedLegacy);
+			double t2 = nowSeconds();
+			batchedTime += t1 - t0;
+			legacyTime += t2 - t1;
+		}
+
+		printf("%d bullets x %d frames: %s (%d mismatching frames)\n",
+			bulletCount, frames, mismatches == 0 ? "identical to per-bullet update" : "DIFFERS", mismatches);
+		printf("%14s %14s %14s\n", "legacy us", "batched us", "speedup");
+		printf("%14.1f %14.1f %13.2fx   (per update of %d bullets)\n",
+			legacyTime * 1e6 / frames, batchedTime * 1e6 / frames, legacyTime / std::max(batchedTime, 1e-12), bulletCount);
+
+		// 整场战斗：四个 Boss 都用 stress 脚本，玩家站着不动，子弹不造成伤害
+		const int playerCount = 1;
+		const int bossCount = 4;
+		const int fightFrames = LOGIC_TICK_RATE * 30;
+		Boss01Tuning tuning;
+		tuning.maxHp = 20000.0f;
+		PatternProgram stress;
+		std::string error;
+		if (!loadBoss01Pattern("stress", stress, error))
+		{
+			printf("stress pattern: %s\n", error.c_str());
+			return;
+		}
+		Fight fight(tuning, playerCount, bossCount, &stress);
+		std::unique_ptr<InputPolicy> policy = makeInputPolicy("idle", 1, 0);
+		std::vector<double> tickMs;
+		int peakAttacks = 0;
+		long long attackSum = 0;
+		while (!fight.isOver() && fight.getFrame() < fightFrames)
+		{
+			PlayerInput input = policy->next(fight);
+			double t0 = nowSeconds();
+			fight.tick(input);
+			tickMs.push_back((nowSeconds() - t0) * 1000.0);
+			int attacks = fight.getAttackCount();
+			peakAttacks = std::max(peakAttacks, attacks);
+			attackSum += attacks;
+		}
+		double total = 0.0;
+		for (double t : tickMs)
+		{
+			total += t;
+		}
+		int n = (int)tickMs.size();
+		std::vector<double> sorted = tickMs;
+		std::sort(sorted.begin(), sorted.end());
+
+		printf("stress fight: %d player x %d bosses, %d ticks\n", playerCount, bossCount, n);
+		printf("%14s %14s %14s %14s %14s\n", "avg ms", "p99 ms", "max ms", "avg attacks", "peak attacks");
+		printf("%14.4f %14.4f %14.4f %14.1f %14d   (budget %.2f ms)\n",
+			total / std::max(1, n), sorted[std::min(n - 1, n * 99 / 100)], sorted[n - 1],
+			attackSum / (double)std::max(1, n), peakAttacks, 1000.0 / LOGIC_TICK_RATE);
+	}
+}
+
+int runBenchmarks(const char* name)
+{
+	bool all = (name == nullptr || strcmp(name, "all") == 0);
+	bool ran = false;
+
+	if (all || strcmp(name, "grid") == 0)
+	{
+		benchGrid();
+		ran = true;
+	}
+	if (all || strcmp(name, "collision") == 0)
+	{
+		benchCollision();
+		ran = true;
+	}
+	if (all || strcmp(name, "trig") == 0)
+	{
+		benchTrig();
+		ran = true;
+	}
+	if (all || strcmp(name, "ecs") == 0)
+	{
+		benchEcs();
+		ran = true;
+	}
+	if (all || strcmp(name, "arena") == 0)
+	{
+		benchArena();
+		ran = true;
+	}
+	if (all || strcmp(name, "snapshot") == 0)
+	{
+		benchSnapshot();
+		ran = true;
+	}
+	if (all || strcmp(name, "pattern") == 0)
+	{
+		benchPattern();
+		ran = true;
+	}
+	if (all || strcmp(name, "rng") == 0)
+	{
+		benchRandom();
+		ran = true;
+	}
+	if (all || strcmp(name, "bullets") == 0)
+	{
+		benchBullets();
+		ran = true;
+	}
+
+	if (!ran)
+	{
+		printf("未知的测试: %s\n", name);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,5 @@
+﻿#pragma once
+
+//性能测试入口：Lumin Project.exe --bench [名称]
+//名称为空或 all 时运行全部测试，返回进程退出码
+int runBenchmarks(const char* name);
@@ -0,0 +1,334 @@
+﻿#pragma once
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <string>
+
+#ifndef LUMIN_HEADLESS
+#include "raylib.h"
+#include "AttackRenderer.h"
+#endif
+#include "GameConfig.h"
+#include "AttackPool.h"
+#include "PatternScript.h"
+#include "Profiler.h"
+#include "Ecs.h"
+#include "EcsSystems.h"
+
+//基类Boss：位置、生命值与无敌帧是 EcsWorld 中的组件，出招由 PatternScript 的字节码脚本驱动
+class Boss
+{
+protected:
+	EcsWorld* world;
+	Entity entity;
+	std::string name;
+	const PatternProgram* program;   // 共用的只读脚本，不属于 Boss
+	PatternState pattern;
+	RandomStream rng;                // 本 Boss 独占的随机数流，脚本中的随机出招都从这里抽取
+	AttackPool attacks;
+
+public:
+	Boss(EcsWorld* w, float cx, float cy, float health, const std::string n, const PatternProgram* p, const RandomStream& r)
+		:world(w), name(n), program(p), rng(r)
+	{
+		entity = world->create(CHARACTER_COMPONENTS);
+		world->get<Transform>(entity) = { cx, cy, cx, cy };
+		world->get<Health>(entity) = { health, health };
+		world->get<DamageCooldown>(entity) = { false, 35, 35 };
+		world->get<Hitbox>(entity) = { BOSS_SIZE / 2.0f, 0.0f };
+		resetPattern(pattern);
+	}
+	virtual ~Boss() {}
+
+	//拷贝整个战斗时，实体句柄不变，只需指向新的世界
+	void attach(EcsWorld* w)
+	{
+		world = w;
+	}
+
+	virtual void update(float playerX, float playerY, float playerHp)
+	{
+		runScript(playerX, playerY);
+		updateAttacks(playerX, playerY);
+	}
+
+	const PatternProgram& getPattern() const
+	{
+		return *program;
+	}
+
+	const PatternState& getPatternState() const
+	{
+		return pattern;
+	}
+
+protected:
+	//脚本中 $参数名 的取值，顺序与派生类编译脚本时给出的参数名一致
+	virtual const float* patternParams() const = 0;
+
+	void runScript(float targetX, float targetY)
+	{
+		PatternContext ctx = { patternParams(), getX(), getY(), targetX, targetY, &attacks, &rng };
+		runPattern(*program, pattern, ctx);
+	}
+
+protected:
+	//更新攻击并移除已结束的攻击（Boss 与各派生类共用），追踪子弹飞向 (targetX, targetY)
+	void updateAttacks(float targetX, float targetY)
+	{
+		PROFILE_SCOPE(PROFILE_ATTACK_UPDATE);
+		attacks.update(targetX, targetY);
+	}
+
+public:
+#ifndef LUMIN_HEADLESS
+	virtual void draw()
+	{
+		float x = getX(), y = getY();
+		const Health& health = world->get<Health>(entity);
+
+		//绘制Boss各种东西
+		DrawCircle((int)x, (int)y, BOSS_SIZE / 2, MAROON);
+		// 名称与血条
+		std::string hpText = name + " HP: " + std::to_string((int)health.hp);
+		DrawText(hpText.c_str(), (int)x - 40, (int)y - BOSS_SIZE / 2 - 20, 10, RAYWHITE);
+
+		// 血条
+		float barWidth = 80;
+		float hpRatio = (health.maxHp > 0) ? (health.hp / health.maxHp) : 0;
+		DrawRectangle((int)(x - barWidth / 2), (int)(y + BOSS_SIZE / 2 + 6), (int)barWidth, 6, DARKGRAY);
+		DrawRectangle((int)(x - barWidth / 2), (int)(y + BOSS_SIZE / 2 + 6), (int)(barWidth * hpRatio), 6, RED);
+	}
+
+	void drawAttacks(float alpha = 1.0f)
+	{
+		gAttackRenderer.draw(attacks, alpha);
+	}
+
+#endif
+
+	bool checkHit(float playerX, float playerY, float playerSize)
+	{
+		return attacks.checkHit(playerX, playerY, playerSize);
+	}
+
+	// 提供访问攻击以便处理伤害
+	const AttackPool& getAttacks() const
+	{
+		return attacks;
+	}
+
+	void takeDamage(float damage)
+	{
+		applyDamage(*world, entity, damage);
+	}
+
+	Entity getEntity() const
+	{
+		return entity;
+	}
+	float getX() const
+	{
+		return world->get<Transform>(entity).x;
+	}
+	float getY() const
+	{
+		return world->get<Transform>(entity).y;
+	}
+	float getHp() const
+	{
+		return world->get<Health>(entity).hp;
+	}
+	std::string getName() const
+	{
+		return name;
+	}
+
+	//名称在构造时固定，不进快照
+	virtual void save(SnapshotWriter& out) const
+	{
+		out.value(entity);
+		out.value(pattern);
+		out.value(rng);
+		attacks.save(out);
+	}
+
+	virtual void load(SnapshotReader& in)
+	{
+		in.value(entity);
+		in.value(pattern);
+		in.value(rng);
+		// 世界先于 Boss 恢复，句柄须指向存活的角色实体
+		if (!world->hasAll(entity, CHARACTER_COMPONENTS))
+		{
+			in.ok = false;
+		}
+		// 脚本本身不进快照，进度须能在当前脚本上安全执行
+		if (!patternStateValid(*program, pattern))
+		{
+			in.ok = false;
+			resetPattern(pattern);
+		}
+		attacks.load(in);
+	}
+
+};
+
+//Boss01 的可调参数，默认值即原先手工调好的数值
+//批量模拟时可以逐项修改，用于平衡测试
+struct Boss01Tuning
+{
+	float maxHp = 250.0f;
+	int attackDelay = 180;            // 普通攻击间隔（帧）
+	float nearDistance = 100.0f;      // 小于该距离时使用近身攻击
+	float circleRadius = 175.0f;      // 近身圆形攻击半径
+	float circleDamage = 25.0f;
+	float bulletSpeed = 3.5f;         // 反弹子弹速度（像素/帧）
+	int bulletMaxBounces = 8;
+	float bulletSpread = 0.2f;        // 三连发子弹之间的夹角（弧度）
+	float aimedRadius = 50.0f;        // 连续瞄准攻击半径
+	float aimedDamage = 10.0f;
+	int aimedChainCount = 8;          // 一轮连续瞄准攻击的次数
+	int aimedChainInterval = 15;      // 连续瞄准攻击之间的间隔（帧）
+};
+
+//Boss01 脚本可用的参数名，与 Boss01Tuning 字段一一对应
+enum Boss01Param
+{
+	BOSS01_MAX_HP,
+	BOSS01_ATTACK_DELAY,
+	BOSS01_NEAR_DISTANCE,
+	BOSS01_CIRCLE_RADIUS,
+	BOSS01_CIRCLE_DAMAGE,
+	BOSS01_BULLET_SPEED,
+	BOSS01_BULLET_MAX_BOUNCES,
+	BOSS01_BULLET_SPREAD,
+	BOSS01_AIMED_RADIUS,
+	BOSS01_AIMED_DAMAGE,
+	BOSS01_AIMED_CHAIN_COUNT,
+	BOSS01_AIMED_CHAIN_INTERVAL,
+	BOSS01_PARAM_COUNT
+};
+
+inline const char* const* boss01ParamNames()
+{
+	static const char* const names[BOSS01_PARAM_COUNT] = {
+		"maxHp", "attackDelay", "nearDistance", "circleRadius", "circleDamage", "bulletSpeed",
+		"bulletMaxBounces", "bulletSpread", "aimedRadius", "aimedDamage", "aimedChainCount", "aimedChainInterval"
+	};
+	return names;
+}
+
+//Boss01 原先手写的出招顺序：开场等半个间隔，之后每轮先三连发反弹子弹，再两次按距离选择
+//远处连续瞄准攻击（相邻两次间隔 aimedChainInterval + 1 帧），近处圆形攻击
+const char* const BOSS01_DEFAULT_PATTERN =
+	"wait $attackDelay / 2\n"
+	"repeat\n"
+	"    spread 3 $bulletSpread $bulletSpeed $bulletMaxBounces 15\n"
+	"    wait $attackDelay\n"
+	"    repeat 2\n"
+	"        if far $nearDistance\n"
+	"            wait 1\n"
+	"            aim $aimedRadius $aimedDamage\n"
+	"            repeat $aimedChainCount - 1\n"
+	"                wait $aimedChainInterval + 1\n"
+	"                aim $aimedRadius $aimedDamage\n"
+	"            end\n"
+	"        else\n"
+	"            spawn $circleRadius $circleDamage\n"
+	"        end\n"
+	"        wait $attackDelay\n"
+	"    end\n"
+	"end\n";
+
+//把参数换成脚本中 $参数名 的取值，out 须有 BOSS01_PARAM_COUNT 个元素
+inline void boss01PatternParams(const Boss01Tuning& t, float* out)
+{
+	out[BOSS01_MAX_HP] = t.maxHp;
+	out[BOSS01_ATTACK_DELAY] = (float)t.attackDelay;
+	out[BOSS01_NEAR_DISTANCE] = t.nearDistance;
+	out[BOSS01_CIRCLE_RADIUS] = t.circleRadius;
+	out[BOSS01_CIRCLE_DAMAGE] = t.circleDamage;
+	out[BOSS01_BULLET_SPEED] = t.bulletSpeed;
+	out[BOSS01_BULLET_MAX_BOUNCES] = (float)t.bulletMaxBounces;
+	out[BOSS01_BULLET_SPREAD] = t.bulletSpread;
+	out[BOSS01_AIMED_RADIUS] = t.aimedRadius;
+	out[BOSS01_AIMED_DAMAGE] = t.aimedDamage;
+	out[BOSS01_AIMED_CHAIN_COUNT] = (float)t.aimedChainCount;
+	out[BOSS01_AIMED_CHAIN_INTERVAL] = (float)t.aimedChainInterval;
+}
+
+//按 Boss01 的参数名编译脚本
+inline bool compileBoss01Pattern(const char* source, PatternProgram& out, std::string& error)
+{
+	return compilePattern(source, boss01ParamNames(), BOSS01_PARAM_COUNT, out, error);
+}
+
+//内置脚本只编译一次，所有 Boss01 共用
+inline const PatternProgram& boss01DefaultPattern()
+{
+	static const PatternProgram program = []()
+	{
+		PatternProgram p;
+		std::string error;
+		compileBoss01Pattern(BOSS01_DEFAULT_PATTERN, p, error);
+		return p;
+	}();
+	return program;
+}
+
+class Boss01 : public Boss
+{
+private:
+	Boss01Tuning tuning;
+	float params[BOSS01_PARAM_COUNT];
+
+public:
+	//pattern 为空时使用内置脚本；构造时执行第 0 帧（开场等待），此时还没有目标，以自身位置代替
+	//rng 通常取战斗种子下的 randomStream(RANDOM_BOSS, 第几个 Boss)
+	Boss01(EcsWorld* w, float cx, float cy, const Boss01Tuning& t = Boss01Tuning(), const PatternProgram* pattern = nullptr,
+		const RandomStream& rng = RandomStream())
+		: Boss(w, cx, cy, t.maxHp, "Boss01", pattern ? pattern : &boss01DefaultPattern(), rng), tuning(t)
+	{
+		refreshParams();
+		runScript(cx, cy);
+	}
+
+	const Boss01Tuning& getTuning() const
+	{
+		return tuning;
+	}
+
+	//中途换参数，之后的出招按新参数（已有的攻击与生命值不变）
+	void setTuning(const Boss01Tuning& t)
+	{
+		tuning = t;
+		refreshParams();
+	}
+
+	//出招进度与参数一起保存，"假如"分支可以在恢复后改参数继续模拟
+	virtual void save(SnapshotWriter& out) const override
+	{
+		Boss::save(out);
+		out.value(tuning);
+	}
+
+	virtual void load(SnapshotReader& in) override
+	{
+		Boss::load(in);
+		in.value(tuning);
+		refreshParams();
+	}
+
+protected:
+	virtual const float* patternParams() const override
+	{
+		return params;
+	}
+
+private:
+	void refreshParams()
+	{
+		boss01PatternParams(tuning, params);
+	}
+};
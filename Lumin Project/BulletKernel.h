@@ -0,0 +1,273 @@
+﻿#pragma once
+
+#include <cstdint>
+
+#include "GameConfig.h"
+#include "CollisionKernel.h"   // LUMIN_SIMD_AVX2 / LUMIN_SIMD_SSE2
+#include "TrigCache.h"
+
+//子弹批量推进：按 SoA 数组整段处理，取代逐颗子弹调用 checkWallCollision / isOutOfBounds
+//只处理"本帧之前就已激活"的子弹（phase 为 ACTIVE 且 timer 不为 0，刚结束预警的这一帧不动），其余子弹原样保留
+//向量版本与标量版本逐位一致：同样的运算顺序，取反用翻转符号位，选择用掩码，不引入乘加融合
+static_assert(sizeof(AttackPhase) == sizeof(int32_t), "AttackPhase 须为 32 位，向量版本按 int32 读写");
+
+inline bool bulletMoving(AttackPhase phase, int timer)
+{
+	return phase == ACTIVE && timer != 0;
+}
+
+//移动、撞墙反弹、超过反弹次数或飞出场地时进入冷却
+inline void bulletStepBatch(float* xs, float* ys, float* dirX, float* dirY, const float* speed, const float* radius,
+	int* bounce, const int* maxBounce, AttackPhase* phase, const int* timer, int count)
+{
+	int i = 0;
+#if defined(LUMIN_SIMD_AVX2) || defined(LUMIN_SIMD_SSE2)
+	int32_t* phaseBits = reinterpret_cast<int32_t*>(phase);
+#endif
+
+#if defined(LUMIN_SIMD_AVX2)
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 width = _mm256_set1_ps((float)SCREEN_WIDTH);
+	const __m256 height = _mm256_set1_ps((float)SCREEN_HEIGHT);
+	const __m256 low = _mm256_set1_ps(-50.0f);
+	const __m256 highX = _mm256_set1_ps((float)(SCREEN_WIDTH + 50));
+	const __m256 highY = _mm256_set1_ps((float)(SCREEN_HEIGHT + 50));
+	const __m256 sign = _mm256_set1_ps(-0.0f);
+	const __m256i active = _mm256_set1_epi32(ACTIVE);
+	const __m256i cooldown = _mm256_set1_epi32(COOLDOWN);
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i ph = _mm256_loadu_si256((const __m256i*)(phaseBits + i));
+		__m256i tm = _mm256_loadu_si256((const __m256i*)(timer + i));
+		__m256i movingBits = _mm256_andnot_si256(_mm256_cmpeq_epi32(tm, _mm256_setzero_si256()), _mm256_cmpeq_epi32(ph, active));
+		if (_mm256_testz_si256(movingBits, movingBits))
+		{
+			continue;
+		}
+		__m256 moving = _mm256_castsi256_ps(movingBits);
+
+		__m256 x = _mm256_loadu_ps(xs + i);
+		__m256 y = _mm256_loadu_ps(ys + i);
+		__m256 dx = _mm256_loadu_ps(dirX + i);
+		__m256 dy = _mm256_loadu_ps(dirY + i);
+		__m256 spd = _mm256_loadu_ps(speed + i);
+		__m256 r = _mm256_loadu_ps(radius + i);
+		__m256i b = _mm256_loadu_si256((const __m256i*)(bounce + i));
+
+		__m256 nx = _mm256_add_ps(x, _mm256_mul_ps(dx, spd));
+		__m256 ny = _mm256_add_ps(y, _mm256_mul_ps(dy, spd));
+
+		// 左右边界
+		__m256 left = _mm256_cmp_ps(_mm256_sub_ps(nx, r), zero, _CMP_LT_OQ);
+		__m256 right = _mm256_andnot_ps(left, _mm256_cmp_ps(_mm256_add_ps(nx, r), width, _CMP_GT_OQ));
+		nx = _mm256_blendv_ps(nx, r, left);
+		nx = _mm256_blendv_ps(nx, _mm256_sub_ps(width, r), right);
+		__m256 flipX = _mm256_and_ps(_mm256_or_ps(left, right), moving);   // 没有移动的子弹不反弹
+		dx = _mm256_blendv_ps(dx, _mm256_xor_ps(dx, sign), flipX);
+
+		// 上下边界
+		__m256 top = _mm256_cmp_ps(_mm256_sub_ps(ny, r), zero, _CMP_LT_OQ);
+		__m256 bottom = _mm256_andnot_ps(top, _mm256_cmp_ps(_mm256_add_ps(ny, r), height, _CMP_GT_OQ));
+		ny = _mm256_blendv_ps(ny, r, top);
+		ny = _mm256_blendv_ps(ny, _mm256_sub_ps(height, r), bottom);
+		__m256 flipY = _mm256_and_ps(_mm256_or_ps(top, bottom), moving);
+		dy = _mm256_blendv_ps(dy, _mm256_xor_ps(dy, sign), flipY);
+
+		// 掩码为 -1，减去即加一
+		__m256i nb = _mm256_sub_epi32(_mm256_sub_epi32(b, _mm256_castps_si256(flipX)), _mm256_castps_si256(flipY));
+
+		__m256 outside = _mm256_or_ps(
+			_mm256_or_ps(_mm256_cmp_ps(nx, low, _CMP_LT_OQ), _mm256_cmp_ps(nx, highX, _CMP_GT_OQ)),
+			_mm256_or_ps(_mm256_cmp_ps(ny, low, _CMP_LT_OQ), _mm256_cmp_ps(ny, highY, _CMP_GT_OQ)));
+		__m256i exhausted = _mm256_xor_si256(_mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i*)(maxBounce + i)), nb),
+			_mm256_set1_epi32(-1));
+		__m256i dead = _mm256_and_si256(_mm256_or_si256(exhausted, _mm256_castps_si256(outside)), movingBits);
+
+		_mm256_storeu_ps(xs + i, _mm256_blendv_ps(x, nx, moving));
+		_mm256_storeu_ps(ys + i, _mm256_blendv_ps(y, ny, moving));
+		_mm256_storeu_ps(dirX + i, dx);
+		_mm256_storeu_ps(dirY + i, dy);
+		_mm256_storeu_si256((__m256i*)(bounce + i), nb);
+		_mm256_storeu_si256((__m256i*)(phaseBits + i), _mm256_blendv_epi8(ph, cooldown, dead));
+	}
+#elif defined(LUMIN_SIMD_SSE2)
+	// SSE2 没有 blendv，用 and/andnot/or 选择
+	auto select = [](__m128 mask, __m128 a, __m128 b)
+	{
+		return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a));
+	};
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 width = _mm_set1_ps((float)SCREEN_WIDTH);
+	const __m128 height = _mm_set1_ps((float)SCREEN_HEIGHT);
+	const __m128 low = _mm_set1_ps(-50.0f);
+	const __m128 highX = _mm_set1_ps((float)(SCREEN_WIDTH + 50));
+	const __m128 highY = _mm_set1_ps((float)(SCREEN_HEIGHT + 50));
+	const __m128 sign = _mm_set1_ps(-0.0f);
+	const __m128i active = _mm_set1_epi32(ACTIVE);
+	const __m128i cooldown = _mm_set1_epi32(COOLDOWN);
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i ph = _mm_loadu_si128((const __m128i*)(phaseBits + i));
+		__m128i tm = _mm_loadu_si128((const __m128i*)(timer + i));
+		__m128i movingBits = _mm_andnot_si128(_mm_cmpeq_epi32(tm, _mm_setzero_si128()), _mm_cmpeq_epi32(ph, active));
+		__m128 moving = _mm_castsi128_ps(movingBits);
+		if (_mm_movemask_ps(moving) == 0)
+		{
+			continue;
+		}
+
+		__m128 x = _mm_loadu_ps(xs + i);
+		__m128 y = _mm_loadu_ps(ys + i);
+		__m128 dx = _mm_loadu_ps(dirX + i);
+		__m128 dy = _mm_loadu_ps(dirY + i);
+		__m128 spd = _mm_loadu_ps(speed + i);
+		__m128 r = _mm_loadu_ps(radius + i);
+		__m128i b = _mm_loadu_si128((const __m128i*)(bounce + i));
+
+		__m128 nx = _mm_add_ps(x, _mm_mul_ps(dx, spd));
+		__m128 ny = _mm_add_ps(y, _mm_mul_ps(dy, spd));
+
+		__m128 left = _mm_cmplt_ps(_mm_sub_ps(nx, r), zero);
+		__m128 right = _mm_andnot_ps(left, _mm_cmpgt_ps(_mm_add_ps(nx, r), width));
+		nx = select(left, nx, r);
+		nx = select(right, nx, _mm_sub_ps(width, r));
+		__m128 flipX = _mm_and_ps(_mm_or_ps(left, right), moving);   // 没有移动的子弹不反弹
+		dx = select(flipX, dx, _mm_xor_ps(dx, sign));
+
+		__m128 top = _mm_cmplt_ps(_mm_sub_ps(ny, r), zero);
+		__m128 bottom = _mm_andnot_ps(top, _mm_cmpgt_ps(_mm_add_ps(ny, r), height));
+		ny = select(top, ny, r);
+		ny = select(bottom, ny, _mm_sub_ps(height, r));
+		__m128 flipY = _mm_and_ps(_mm_or_ps(top, bottom), moving);
+		dy = select(flipY, dy, _mm_xor_ps(dy, sign));
+
+		__m128i nb = _mm_sub_epi32(_mm_sub_epi32(b, _mm_castps_si128(flipX)), _mm_castps_si128(flipY));
+
+		__m128 outside = _mm_or_ps(
+			_mm_or_ps(_mm_cmplt_ps(nx, low), _mm_cmpgt_ps(nx, highX)),
+			_mm_or_ps(_mm_cmplt_ps(ny, low), _mm_cmpgt_ps(ny, highY)));
+		__m128i exhausted = _mm_xor_si128(_mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)(maxBounce + i)), nb),
+			_mm_set1_epi32(-1));
+		__m128i dead = _mm_and_si128(_mm_or_si128(exhausted, _mm_castps_si128(outside)), movingBits);
+
+		_mm_storeu_ps(xs + i, select(moving, x, nx));
+		_mm_storeu_ps(ys + i, select(moving, y, ny));
+		_mm_storeu_ps(dirX + i, dx);
+		_mm_storeu_ps(dirY + i, dy);
+		_mm_storeu_si128((__m128i*)(bounce + i), nb);
+		_mm_storeu_si128((__m128i*)(phaseBits + i), _mm_or_si128(_mm_and_si128(dead, cooldown), _mm_andnot_si128(dead, ph)));
+	}
+#endif
+
+	// 标量版本，也用于处理剩余不足一组的子弹
+	for (; i < count; i++)
+	{
+		if (!bulletMoving(phase[i], timer[i]))
+		{
+			continue;
+		}
+		float r = radius[i];
+		float x = xs[i] + dirX[i] * speed[i];
+		float y = ys[i] + dirY[i] * speed[i];
+		if (x - r < 0)
+		{
+			x = r;
+			dirX[i] = -dirX[i];
+			bounce[i]++;
+		}
+		else if (x + r > SCREEN_WIDTH)
+		{
+			x = SCREEN_WIDTH - r;
+			dirX[i] = -dirX[i];
+			bounce[i]++;
+		}
+		if (y - r < 0)
+		{
+			y = r;
+			dirY[i] = -dirY[i];
+			bounce[i]++;
+		}
+		else if (y + r > SCREEN_HEIGHT)
+		{
+			y = SCREEN_HEIGHT - r;
+			dirY[i] = -dirY[i];
+			bounce[i]++;
+		}
+		xs[i] = x;
+		ys[i] = y;
+		if (bounce[i] >= maxBounce[i] || x < -50 || x > SCREEN_WIDTH + 50 || y < -50 || y > SCREEN_HEIGHT + 50)
+		{
+			phase[i] = COOLDOWN;
+		}
+	}
+}
+
+//朝向批量旋转：rot = (rot * step).renormalized()，只处理本帧移动的子弹
+//Rotation 是 (cos, sin) 交错存放，一个向量寄存器放 2（SSE2）或 4（AVX2）颗子弹
+inline void rotationStepBatch(Rotation* rot, Rotation step, const AttackPhase* phase, const int* timer, int count)
+{
+	int i = 0;
+	static_assert(sizeof(Rotation) == 2 * sizeof(float), "Rotation 须为紧密排列的 (cos, sin)");
+
+#if defined(LUMIN_SIMD_AVX2) || defined(LUMIN_SIMD_SSE2)
+	float* v = &rot[0].c;
+#endif
+
+#if defined(LUMIN_SIMD_AVX2)
+	const __m256 cosStep = _mm256_set1_ps(step.c);
+	const __m256 sinStep = _mm256_setr_ps(-step.s, step.s, -step.s, step.s, -step.s, step.s, -step.s, step.s);
+	const __m256 half = _mm256_set1_ps(0.5f);
+	const __m256 threeHalves = _mm256_set1_ps(1.5f);
+	for (; i + 4 <= count; i += 4)
+	{
+		int m0 = bulletMoving(phase[i], timer[i]) ? -1 : 0;
+		int m1 = bulletMoving(phase[i + 1], timer[i + 1]) ? -1 : 0;
+		int m2 = bulletMoving(phase[i + 2], timer[i + 2]) ? -1 : 0;
+		int m3 = bulletMoving(phase[i + 3], timer[i + 3]) ? -1 : 0;
+		if ((m0 | m1 | m2 | m3) == 0)
+		{
+			continue;
+		}
+		__m256 mask = _mm256_castsi256_ps(_mm256_setr_epi32(m0, m0, m1, m1, m2, m2, m3, m3));
+		__m256 a = _mm256_loadu_ps(v + 2 * i);
+		// (c, s) -> (c*cs + s*(-ss), s*cs + c*ss)，与标量的 c*cs - s*ss、c*ss + s*cs 逐位相同
+		__m256 swapped = _mm256_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1));
+		__m256 turned = _mm256_add_ps(_mm256_mul_ps(a, cosStep), _mm256_mul_ps(swapped, sinStep));
+		__m256 sq = _mm256_mul_ps(turned, turned);
+		__m256 len = _mm256_add_ps(sq, _mm256_permute_ps(sq, _MM_SHUFFLE(2, 3, 0, 1)));
+		__m256 k = _mm256_sub_ps(threeHalves, _mm256_mul_ps(half, len));
+		_mm256_storeu_ps(v + 2 * i, _mm256_blendv_ps(a, _mm256_mul_ps(turned, k), mask));
+	}
+#elif defined(LUMIN_SIMD_SSE2)
+	const __m128 cosStep = _mm_set1_ps(step.c);
+	const __m128 sinStep = _mm_setr_ps(-step.s, step.s, -step.s, step.s);
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 threeHalves = _mm_set1_ps(1.5f);
+	for (; i + 2 <= count; i += 2)
+	{
+		int m0 = bulletMoving(phase[i], timer[i]) ? -1 : 0;
+		int m1 = bulletMoving(phase[i + 1], timer[i + 1]) ? -1 : 0;
+		if ((m0 | m1) == 0)
+		{
+			continue;
+		}
+		__m128 mask = _mm_castsi128_ps(_mm_setr_epi32(m0, m0, m1, m1));
+		__m128 a = _mm_loadu_ps(v + 2 * i);
+		__m128 swapped = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1));
+		__m128 turned = _mm_add_ps(_mm_mul_ps(a, cosStep), _mm_mul_ps(swapped, sinStep));
+		__m128 sq = _mm_mul_ps(turned, turned);
+		__m128 len = _mm_add_ps(sq, _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(2, 3, 0, 1)));
+		__m128 k = _mm_sub_ps(threeHalves, _mm_mul_ps(half, len));
+		__m128 out = _mm_mul_ps(turned, k);
+		_mm_storeu_ps(v + 2 * i, _mm_or_ps(_mm_and_ps(mask, out), _mm_andnot_ps(mask, a)));
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		if (bulletMoving(phase[i], timer[i]))
+		{
+			rot[i] = (rot[i] * step).renormalized();
+		}
+	}
+}
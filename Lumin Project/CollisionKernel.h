@@ -0,0 +1,123 @@
+﻿#pragma once
+
+#include <cstring>
+
+//根据编译选项选择向量指令：/arch:AVX2 时用 AVX2，x64 默认带 SSE2，否则走标量版本
+//定义 LUMIN_NO_SIMD 可强制使用标量版本
+#if !defined(LUMIN_NO_SIMD) && defined(__AVX2__)
+#define LUMIN_SIMD_AVX2 1
+#include <immintrin.h>
+#elif !defined(LUMIN_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define LUMIN_SIMD_SSE2 1
+#include <emmintrin.h>
+#endif
+
+inline const char* collisionKernelName()
+{
+#if defined(LUMIN_SIMD_AVX2)
+	return "AVX2";
+#elif defined(LUMIN_SIMD_SSE2)
+	return "SSE2";
+#else
+	return "scalar";
+#endif
+}
+
+inline int countBits(unsigned int v)
+{
+	int n = 0;
+	while (v)
+	{
+		v &= v - 1;
+		n++;
+	}
+	return n;
+}
+
+//批量圆形碰撞检测：xs/ys/rs/dmg 为连续的攻击圆心、半径与伤害数组
+//用距离平方比较，不开方。第 i 个攻击命中时 hitMask 第 i 位置 1
+//hitMask 至少 (count + 31) / 32 个元素；totalDamage 可为空，非空时返回命中攻击的伤害之和
+//返回命中个数
+inline int circleHitBatch(const float* xs, const float* ys, const float* rs, const float* dmg, int count,
+	float playerX, float playerY, float playerRadius, unsigned int* hitMask, float* totalDamage)
+{
+	memset(hitMask, 0, sizeof(unsigned int) * ((count + 31) / 32));
+
+	int hits = 0;
+	float damageSum = 0.0f;
+	int i = 0;
+
+#if defined(LUMIN_SIMD_AVX2)
+	const __m256 px = _mm256_set1_ps(playerX);
+	const __m256 py = _mm256_set1_ps(playerY);
+	const __m256 pr = _mm256_set1_ps(playerRadius);
+	__m256 sum = _mm256_setzero_ps();
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 dx = _mm256_sub_ps(_mm256_loadu_ps(xs + i), px);
+		__m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ys + i), py);
+		__m256 d2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+		__m256 rr = _mm256_add_ps(_mm256_loadu_ps(rs + i), pr);
+		__m256 m = _mm256_cmp_ps(d2, _mm256_mul_ps(rr, rr), _CMP_LT_OQ);
+		unsigned int bits = (unsigned int)_mm256_movemask_ps(m);
+		if (bits)
+		{
+			hitMask[i >> 5] |= bits << (i & 31);
+			hits += countBits(bits);
+			sum = _mm256_add_ps(sum, _mm256_and_ps(m, _mm256_loadu_ps(dmg + i)));
+		}
+	}
+	float lanes[8];
+	_mm256_storeu_ps(lanes, sum);
+	for (int k = 0; k < 8; k++)
+	{
+		damageSum += lanes[k];
+	}
+#elif defined(LUMIN_SIMD_SSE2)
+	const __m128 px = _mm_set1_ps(playerX);
+	const __m128 py = _mm_set1_ps(playerY);
+	const __m128 pr = _mm_set1_ps(playerRadius);
+	__m128 sum = _mm_setzero_ps();
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + i), px);
+		__m128 dy = _mm_sub_ps(_mm_loadu_ps(ys + i), py);
+		__m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+		__m128 rr = _mm_add_ps(_mm_loadu_ps(rs + i), pr);
+		__m128 m = _mm_cmplt_ps(d2, _mm_mul_ps(rr, rr));
+		unsigned int bits = (unsigned int)_mm_movemask_ps(m);
+		if (bits)
+		{
+			hitMask[i >> 5] |= bits << (i & 31);
+			hits += countBits(bits);
+			sum = _mm_add_ps(sum, _mm_and_ps(m, _mm_loadu_ps(dmg + i)));
+		}
+	}
+	float lanes[4];
+	_mm_storeu_ps(lanes, sum);
+	for (int k = 0; k < 4; k++)
+	{
+		damageSum += lanes[k];
+	}
+#endif
+
+	// 标量版本，也用于处理剩余不足一组的攻击
+	for (; i < count; i++)
+	{
+		float dx = xs[i] - playerX;
+		float dy = ys[i] - playerY;
+		float rr = rs[i] + playerRadius;
+		if (dx * dx + dy * dy < rr * rr)
+		{
+			hitMask[i >> 5] |= 1u << (i & 31);
+			hits++;
+			damageSum += dmg[i];
+		}
+	}
+
+	if (totalDamage)
+	{
+		*totalDamage = damageSum;
+	}
+	return hits;
+}
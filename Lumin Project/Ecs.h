@@ -0,0 +1,480 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "GameConfig.h"
+#include "Snapshot.h"
+
+//实体句柄：低 20 位为槽位编号，高 12 位为代数，槽位重用后旧句柄自动失效
+typedef uint32_t Entity;
+const Entity NULL_ENTITY = 0xFFFFFFFFu;
+const int ENTITY_INDEX_BITS = 20;
+const uint32_t ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+
+// ---- 组件：只有数据，没有虚函数 ----
+
+//位置，prevX/prevY 为上一逻辑帧的位置，用于插值绘制
+struct Transform
+{
+	float x, y;
+	float prevX, prevY;
+};
+
+struct Health
+{
+	float hp, maxHp;
+};
+
+//受击后的无敌帧：active 期间不再受伤，timer 倒数到 0 后恢复为 duration
+struct DamageCooldown
+{
+	bool active;
+	int timer;
+	int duration;
+};
+
+//圆形判定范围，damage 为命中时造成的伤害（受击方可为 0）
+struct Hitbox
+{
+	float radius;
+	float damage;
+};
+
+//攻击阶段（AttackPhase 组件）：当前阶段、已持续的帧数与攻击朝向
+struct AttackState
+{
+	AttackPhase phase;
+	int timer;
+	float dirX, dirY;
+};
+
+//剩余存活帧数，归零时实体被销毁
+struct Lifetime
+{
+	int frames;
+};
+
+enum ComponentType
+{
+	COMPONENT_TRANSFORM,
+	COMPONENT_HEALTH,
+	COMPONENT_DAMAGE_COOLDOWN,
+	COMPONENT_HITBOX,
+	COMPONENT_ATTACK_STATE,
+	COMPONENT_LIFETIME,
+	COMPONENT_COUNT
+};
+
+//组件集合的位掩码，同一掩码的实体放在同一个原型中
+typedef uint32_t ComponentMask;
+const ComponentMask HAS_TRANSFORM = 1u << COMPONENT_TRANSFORM;
+const ComponentMask HAS_HEALTH = 1u << COMPONENT_HEALTH;
+const ComponentMask HAS_DAMAGE_COOLDOWN = 1u << COMPONENT_DAMAGE_COOLDOWN;
+const ComponentMask HAS_HITBOX = 1u << COMPONENT_HITBOX;
+const ComponentMask HAS_ATTACK_STATE = 1u << COMPONENT_ATTACK_STATE;
+const ComponentMask HAS_LIFETIME = 1u << COMPONENT_LIFETIME;
+const uint32_t COMPONENT_MASK_LIMIT = 1u << COMPONENT_COUNT;   // 原型最多有这么多种
+
+//原型（archetype）：组件集合完全相同的实体，每种组件一条连续数组，第 i 行属于 entities[i]
+//系统按原型遍历这些数组，没有逐对象的虚函数调用
+struct Archetype
+{
+	ComponentMask mask;
+	std::vector<Entity> entities;
+	std::vector<Transform> transforms;
+	std::vector<Health> healths;
+	std::vector<DamageCooldown> cooldowns;
+	std::vector<Hitbox> hitboxes;
+	std::vector<AttackState> attackStates;
+	std::vector<Lifetime> lifetimes;
+
+	explicit Archetype(ComponentMask m)
+		:mask(m) {
+	}
+
+	int size() const
+	{
+		return (int)entities.size();
+	}
+
+	bool has(ComponentMask required) const
+	{
+		return (mask & required) == required;
+	}
+
+	//追加一行，组件全部零初始化
+	int push(Entity e)
+	{
+		entities.push_back(e);
+		if (mask & HAS_TRANSFORM) transforms.push_back(Transform());
+		if (mask & HAS_HEALTH) healths.push_back(Health());
+		if (mask & HAS_DAMAGE_COOLDOWN) cooldowns.push_back(DamageCooldown());
+		if (mask & HAS_HITBOX) hitboxes.push_back(Hitbox());
+		if (mask & HAS_ATTACK_STATE) attackStates.push_back(AttackState());
+		if (mask & HAS_LIFETIME) lifetimes.push_back(Lifetime());
+		return size() - 1;
+	}
+
+	//各组件数组与 entities 等长（不在 mask 中的为空），只记一个行数
+	void save(SnapshotWriter& out) const
+	{
+		out.value(mask);
+		out.array(entities);
+		out.column(transforms);
+		out.column(healths);
+		out.column(cooldowns);
+		out.column(hitboxes);
+		out.column(attackStates);
+		out.column(lifetimes);
+	}
+
+	void load(SnapshotReader& in)
+	{
+		in.value(mask);
+		uint32_t n = in.array(entities);
+		in.column(transforms, (mask & HAS_TRANSFORM) ? n : 0);
+		in.column(healths, (mask & HAS_HEALTH) ? n : 0);
+		in.column(cooldowns, (mask & HAS_DAMAGE_COOLDOWN) ? n : 0);
+		in.column(hitboxes, (mask & HAS_HITBOX) ? n : 0);
+		in.column(attackStates, (mask & HAS_ATTACK_STATE) ? n : 0);
+		in.column(lifetimes, (mask & HAS_LIFETIME) ? n : 0);
+	}
+
+	//用最后一行填补被删除的行，返回被移动的实体（删除的就是最后一行时返回 NULL_ENTITY）
+	Entity swapRemove(int row)
+	{
+		int last = size() - 1;
+		Entity moved = (row != last) ? entities[last] : NULL_ENTITY;
+		swapRemoveColumn(entities, row);
+		swapRemoveColumn(transforms, row);
+		swapRemoveColumn(healths, row);
+		swapRemoveColumn(cooldowns, row);
+		swapRemoveColumn(hitboxes, row);
+		swapRemoveColumn(attackStates, row);
+		swapRemoveColumn(lifetimes, row);
+		return moved;
+	}
+
+private:
+	template<typename T>
+	static void swapRemoveColumn(std::vector<T>& column, int row)
+	{
+		if (column.empty())
+		{
+			return;
+		}
+		column[row] = column.back();
+		column.pop_back();
+	}
+};
+
+//组件类型到原型中对应数组的映射
+template<typename T> struct ComponentColumn;
+template<> struct ComponentColumn<Transform>
+{
+	static const ComponentMask bit = HAS_TRANSFORM;
+	static std::vector<Transform>& of(Archetype& a) { return a.transforms; }
+	static const std::vector<Transform>& of(const Archetype& a) { return a.transforms; }
+};
+template<> struct ComponentColumn<Health>
+{
+	static const ComponentMask bit = HAS_HEALTH;
+	static std::vector<Health>& of(Archetype& a) { return a.healths; }
+	static const std::vector<Health>& of(const Archetype& a) { return a.healths; }
+};
+template<> struct ComponentColumn<DamageCooldown>
+{
+	static const ComponentMask bit = HAS_DAMAGE_COOLDOWN;
+	static std::vector<DamageCooldown>& of(Archetype& a) { return a.cooldowns; }
+	static const std::vector<DamageCooldown>& of(const Archetype& a) { return a.cooldowns; }
+};
+template<> struct ComponentColumn<Hitbox>
+{
+	static const ComponentMask bit = HAS_HITBOX;
+	static std::vector<Hitbox>& of(Archetype& a) { return a.hitboxes; }
+	static const std::vector<Hitbox>& of(const Archetype& a) { return a.hitboxes; }
+};
+template<> struct ComponentColumn<AttackState>
+{
+	static const ComponentMask bit = HAS_ATTACK_STATE;
+	static std::vector<AttackState>& of(Archetype& a) { return a.attackStates; }
+	static const std::vector<AttackState>& of(const Archetype& a) { return a.attackStates; }
+};
+template<> struct ComponentColumn<Lifetime>
+{
+	static const ComponentMask bit = HAS_LIFETIME;
+	static std::vector<Lifetime>& of(Archetype& a) { return a.lifetimes; }
+	static const std::vector<Lifetime>& of(const Archetype& a) { return a.lifetimes; }
+};
+
+//实体世界：按原型存放所有实体的组件
+//整个世界只由 vector 组成，可以直接拷贝
+class EcsWorld
+{
+private:
+	struct EntityRecord
+	{
+		int archetype;       // -1 表示槽位空闲
+		int row;
+		uint32_t generation;
+	};
+
+	std::vector<Archetype> archetypes;
+	std::vector<EntityRecord> records;
+	std::vector<uint32_t> freeSlots;
+	int liveCount;
+
+public:
+	EcsWorld()
+		:liveCount(0) {
+	}
+
+	Entity create(ComponentMask mask)
+	{
+		uint32_t index;
+		if (!freeSlots.empty())
+		{
+			index = freeSlots.back();
+			freeSlots.pop_back();
+		}
+		else
+		{
+			index = (uint32_t)records.size();
+			records.push_back({ -1, 0, 0 });
+		}
+
+		EntityRecord& r = records[index];
+		Entity e = (r.generation << ENTITY_INDEX_BITS) | index;
+		r.archetype = findOrAddArchetype(mask);
+		r.row = archetypes[r.archetype].push(e);
+		liveCount++;
+		return e;
+	}
+
+	void destroy(Entity e)
+	{
+		if (!isAlive(e))
+		{
+			return;
+		}
+		EntityRecord& r = records[e & ENTITY_INDEX_MASK];
+		Entity moved = archetypes[r.archetype].swapRemove(r.row);
+		if (moved != NULL_ENTITY)
+		{
+			records[moved & ENTITY_INDEX_MASK].row = r.row;
+		}
+		r.archetype = -1;
+		r.generation = (r.generation + 1) & (0xFFFFFFFFu >> ENTITY_INDEX_BITS);
+		freeSlots.push_back(e & ENTITY_INDEX_MASK);
+		liveCount--;
+	}
+
+	bool isAlive(Entity e) const
+	{
+		if (e == NULL_ENTITY || (e & ENTITY_INDEX_MASK) >= records.size())
+		{
+			return false;
+		}
+		const EntityRecord& r = records[e & ENTITY_INDEX_MASK];
+		return r.archetype >= 0 && (e >> ENTITY_INDEX_BITS) == r.generation;
+	}
+
+	template<typename T>
+	bool has(Entity e) const
+	{
+		return hasAll(e, ComponentColumn<T>::bit);
+	}
+
+	//实体存活且带有 required 中的全部组件
+	bool hasAll(Entity e, ComponentMask required) const
+	{
+		return isAlive(e) && archetypes[records[e & ENTITY_INDEX_MASK].archetype].has(required);
+	}
+
+	//取组件，调用方保证实体存活且带有该组件
+	template<typename T>
+	T& get(Entity e)
+	{
+		const EntityRecord& r = records[e & ENTITY_INDEX_MASK];
+		return ComponentColumn<T>::of(archetypes[r.archetype])[r.row];
+	}
+
+	template<typename T>
+	const T& get(Entity e) const
+	{
+		const EntityRecord& r = records[e & ENTITY_INDEX_MASK];
+		return ComponentColumn<T>::of(archetypes[r.archetype])[r.row];
+	}
+
+	//对每个包含 required 全部组件的非空原型调用 fn(Archetype&)
+	//fn 中可以销毁当前原型中的实体（倒序遍历时安全），但不能创建实体
+	template<typename Fn>
+	void forEach(ComponentMask required, Fn fn)
+	{
+		for (Archetype& a : archetypes)
+		{
+			if (a.has(required) && a.size() > 0)
+			{
+				fn(a);
+			}
+		}
+	}
+
+	template<typename Fn>
+	void forEach(ComponentMask required, Fn fn) const
+	{
+		for (const Archetype& a : archetypes)
+		{
+			if (a.has(required) && a.size() > 0)
+			{
+				fn(a);
+			}
+		}
+	}
+
+	int entityCount() const
+	{
+		return liveCount;
+	}
+
+	int archetypeCount() const
+	{
+		return (int)archetypes.size();
+	}
+
+	//写入快照：原型顺序、槽位与空闲表都原样保存，恢复后实体句柄与遍历顺序不变
+	void save(SnapshotWriter& out) const
+	{
+		uint32_t count = (uint32_t)archetypes.size();
+		out.value(count);
+		for (const Archetype& a : archetypes)
+		{
+			a.save(out);
+		}
+		out.array(records);
+		out.array(freeSlots);
+		out.value(liveCount);
+	}
+
+	void load(SnapshotReader& in)
+	{
+		uint32_t count = 0;
+		in.value(count);
+		if (count > COMPONENT_MASK_LIMIT)
+		{
+			in.ok = false;
+			return;
+		}
+		archetypes.resize(count, Archetype(0));
+		for (Archetype& a : archetypes)
+		{
+			a.load(in);
+		}
+		in.array(records);
+		in.array(freeSlots);
+		in.value(liveCount);
+		// 快照可能来自外部文件：内容自洽才能让 get<T>() 的下标不越界
+		// 失败时清空，之后读取玩家/Boss 句柄的检查不会再按坏记录取下标
+		if (!in.ok || !consistent())
+		{
+			in.ok = false;
+			archetypes.clear();
+			records.clear();
+			freeSlots.clear();
+			liveCount = 0;
+		}
+	}
+
+private:
+	//检查读入的世界是否自洽：
+	//每一行的实体指回这一行，每条存活记录指向的行属于它，空闲表恰好列出全部空闲槽位各一次，实体计数与行数相符
+	bool consistent() const
+	{
+		const uint32_t maxGeneration = 0xFFFFFFFFu >> ENTITY_INDEX_BITS;
+		if (records.size() > (size_t)ENTITY_INDEX_MASK + 1)
+		{
+			return false;
+		}
+
+		size_t rows = 0;
+		for (int a = 0; a < (int)archetypes.size(); a++)
+		{
+			const Archetype& arch = archetypes[a];
+			if (arch.mask >= COMPONENT_MASK_LIMIT)
+			{
+				return false;
+			}
+			for (int b = 0; b < a; b++)
+			{
+				if (archetypes[b].mask == arch.mask)
+				{
+					return false;
+				}
+			}
+			for (int row = 0; row < arch.size(); row++)
+			{
+				Entity e = arch.entities[row];
+				uint32_t index = e & ENTITY_INDEX_MASK;
+				if (e == NULL_ENTITY || index >= records.size())
+				{
+					return false;
+				}
+				const EntityRecord& r = records[index];
+				if (r.archetype != a || r.row != row || r.generation != (e >> ENTITY_INDEX_BITS))
+				{
+					return false;
+				}
+			}
+			rows += arch.size();
+		}
+
+		// 上面已保证每一行恰有一条记录指向它；这里再保证不存在指向别处的存活记录
+		size_t live = 0;
+		std::vector<uint8_t> listed(records.size(), 0);
+		for (uint32_t slot : freeSlots)
+		{
+			if (slot >= records.size() || records[slot].archetype != -1 || listed[slot])
+			{
+				return false;
+			}
+			listed[slot] = 1;
+		}
+		for (size_t i = 0; i < records.size(); i++)
+		{
+			const EntityRecord& r = records[i];
+			if (r.generation > maxGeneration)
+			{
+				return false;
+			}
+			if (r.archetype == -1)
+			{
+				if (!listed[i])
+				{
+					return false;
+				}
+				continue;
+			}
+			if (r.archetype < 0 || r.archetype >= (int)archetypes.size() || r.row < 0 || r.row >= archetypes[r.archetype].size()
+				|| (archetypes[r.archetype].entities[r.row] & ENTITY_INDEX_MASK) != i)
+			{
+				return false;
+			}
+			live++;
+		}
+		return live == rows && liveCount == (int)rows;
+	}
+
+	int findOrAddArchetype(ComponentMask mask)
+	{
+		for (int i = 0; i < (int)archetypes.size(); i++)
+		{
+			if (archetypes[i].mask == mask)
+			{
+				return i;
+			}
+		}
+		archetypes.push_back(Archetype(mask));
+		return (int)archetypes.size() - 1;
+	}
+};
@@ -0,0 +1,184 @@
+﻿#pragma once
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+#include "Ecs.h"
+
+//各系统每帧对所有匹配的原型做一次线性遍历，玩家、Boss 与攻击共用同一份逻辑
+
+//近战攻击实体：位置、判定范围、朝向与剩余帧数
+const ComponentMask MELEE_ATTACK_COMPONENTS = HAS_TRANSFORM | HAS_HITBOX | HAS_ATTACK_STATE | HAS_LIFETIME;
+
+//可受伤的角色（玩家、Boss）
+const ComponentMask CHARACTER_COMPONENTS = HAS_TRANSFORM | HAS_HEALTH | HAS_DAMAGE_COOLDOWN | HAS_HITBOX;
+
+//记录上一逻辑帧的位置，供插值绘制
+inline void storePreviousPositions(EcsWorld& world)
+{
+	world.forEach(HAS_TRANSFORM, [](Archetype& a)
+	{
+		for (Transform& t : a.transforms)
+		{
+			t.prevX = t.x;
+			t.prevY = t.y;
+		}
+	});
+}
+
+//无敌帧倒计时；受击时刻是随机的，写成无分支形式避免分支预测失败
+inline void updateDamageCooldowns(EcsWorld& world)
+{
+	world.forEach(HAS_DAMAGE_COOLDOWN, [](Archetype& a)
+	{
+		for (DamageCooldown& c : a.cooldowns)
+		{
+			int timer = c.timer - (c.active ? 1 : 0);
+			bool expired = c.active && timer <= 0;
+			c.active = c.active && !expired;
+			c.timer = expired ? c.duration : timer;
+		}
+	});
+}
+
+//造成伤害：无敌帧内无效，生命值不低于 0，受伤后进入无敌帧
+//返回实际扣除的生命值
+inline float applyDamage(EcsWorld& world, Entity target, float damage)
+{
+	DamageCooldown& cooldown = world.get<DamageCooldown>(target);
+	if (cooldown.active)
+	{
+		return 0.0f;
+	}
+	Health& health = world.get<Health>(target);
+	float before = health.hp;
+	health.hp -= damage;
+	cooldown.active = true;
+	if (health.hp < 0)
+	{
+		health.hp = 0;
+	}
+	return before - health.hp;
+}
+
+//攻击阶段计时
+inline void updateAttackStates(EcsWorld& world)
+{
+	world.forEach(HAS_ATTACK_STATE, [](Archetype& a)
+	{
+		for (AttackState& s : a.attackStates)
+		{
+			s.timer++;
+		}
+	});
+}
+
+//剩余帧数归零的实体被销毁；倒序遍历，swapRemove 移过来的行已经处理过
+inline void updateLifetimes(EcsWorld& world)
+{
+	world.forEach(HAS_LIFETIME, [&world](Archetype& a)
+	{
+		for (int i = a.size() - 1; i >= 0; i--)
+		{
+			if (--a.lifetimes[i].frames <= 0)
+			{
+				world.destroy(a.entities[i]);
+			}
+		}
+	});
+}
+
+//半圆形近战判定：目标圆与攻击圆相交，且目标中心位于攻击朝向两侧各 90 度以内
+inline bool meleeArcHit(const Transform& t, const Hitbox& box, const AttackState& s, float targetX, float targetY, float targetRadius)
+{
+	float dx = targetX - t.x;
+	float dy = targetY - t.y;
+	float dist = sqrtf(dx * dx + dy * dy);
+	if (dist > box.radius + targetRadius) return false;
+
+	float targetAngle = atan2f(dy, dx);
+	float attackStartAngle = atan2f(s.dirY, s.dirX) - M_PI / 2;
+	float attackEndAngle = attackStartAngle + M_PI;
+
+	// 处理角度环绕问题
+	if (attackStartAngle < 0) attackStartAngle += 2 * M_PI;
+	if (attackEndAngle < 0) attackEndAngle += 2 * M_PI;
+	if (targetAngle < 0) targetAngle += 2 * M_PI;
+
+	if (attackStartAngle <= attackEndAngle)
+	{
+		return targetAngle >= attackStartAngle && targetAngle <= attackEndAngle;
+	}
+	return targetAngle >= attackStartAngle || targetAngle <= attackEndAngle;
+}
+
+//近战攻击的粗筛（sweep and prune）：每帧把激活中的近战攻击按 x 排序，
+//查询时二分找出 x 方向可能重叠的一段，只对这一段做精确的半圆判定
+class MeleeSweep
+{
+private:
+	struct Entry
+	{
+		Transform transform;
+		Hitbox hitbox;
+		AttackState state;
+		Entity entity;
+	};
+
+	std::vector<Entry> entries;
+	float maxRadius;
+
+public:
+	MeleeSweep()
+		:maxRadius(0.0f) {
+	}
+
+	void build(const EcsWorld& world)
+	{
+		entries.clear();
+		maxRadius = 0.0f;
+		world.forEach(HAS_TRANSFORM | HAS_HITBOX | HAS_ATTACK_STATE, [this](const Archetype& a)
+		{
+			for (int i = 0; i < a.size(); i++)
+			{
+				if (a.attackStates[i].phase == ACTIVE)
+				{
+					entries.push_back({ a.transforms[i], a.hitboxes[i], a.attackStates[i], a.entities[i] });
+					maxRadius = std::max(maxRadius, a.hitboxes[i].radius);
+				}
+			}
+		});
+		// 按 x 排序，x 相同时按实体句柄，保证结果与原型内的行顺序无关
+		std::sort(entries.begin(), entries.end(), [](const Entry& l, const Entry& r)
+		{
+			return l.transform.x < r.transform.x || (l.transform.x == r.transform.x && l.entity < r.entity);
+		});
+	}
+
+	//目标圆被某个近战攻击命中时返回 true，并给出排序后第一个命中攻击的伤害与实体
+	bool query(float x, float y, float radius, float* damage = nullptr, Entity* attacker = nullptr) const
+	{
+		float reach = radius + maxRadius;
+		auto first = std::lower_bound(entries.begin(), entries.end(), x - reach, [](const Entry& e, float v)
+		{
+			return e.transform.x < v;
+		});
+		for (auto it = first; it != entries.end() && it->transform.x <= x + reach; ++it)
+		{
+			if (meleeArcHit(it->transform, it->hitbox, it->state, x, y, radius))
+			{
+				if (damage) *damage = it->hitbox.damage;
+				if (attacker) *attacker = it->entity;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	int size() const
+	{
+		return (int)entries.size();
+	}
+};
@@ -0,0 +1,464 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+#ifndef LUMIN_HEADLESS
+#include "raylib.h"
+#endif
+#include "GameConfig.h"
+#include "PlayerInput.h"
+#include "Player.h"
+#include "Boss.h"
+#include "Ecs.h"
+#include "EcsSystems.h"
+#include "Snapshot.h"
+#include "Profiler.h"
+
+enum FightWinner
+{
+	WINNER_NONE,     // 尚未分出胜负（或达到帧数上限）
+	WINNER_PLAYER,
+	WINNER_BOSS
+};
+
+//Boss 选择攻击目标的方式
+enum BossTargeting
+{
+	TARGET_NEAREST,   // 每帧瞄准最近的存活玩家
+	TARGET_CHOSEN     // 瞄准指定的玩家，该玩家倒下后改为最近的玩家
+};
+
+//一场战斗：N 个玩家对 M 个 Boss01（默认一对一），只包含逻辑状态
+//窗口版与无窗口版共用同一个 tick，保证两者结果一致
+//角色与近战攻击的数据都在 world 中，冷却、寿命等通用逻辑由 EcsSystems 中的系统统一更新
+//命中检测全部经过粗筛：Boss 攻击用各自攻击池的网格，玩家近战用按 x 排序的扫掠表
+class Fight
+{
+private:
+	static const uint32_t SNAPSHOT_MAGIC = 0x504E534Cu;   // "LSNP"
+	static const uint32_t SNAPSHOT_VERSION = 4;
+
+	EcsWorld world;              // 必须在 players、bosses 之前构造
+	std::vector<Player> players;
+	std::vector<Boss01> bosses;
+	std::vector<BossTargeting> targeting;
+	std::vector<int> chosenTarget;
+	MeleeSweep meleeSweep;
+	GameState gameState;
+	uint64_t seed;               // 战斗种子，各 Boss 的随机数流由它派生
+	int frame;                   // 已执行的逻辑帧数
+	float damageTakenByPlayer;   // 所有玩家实际受到的伤害总和
+	float damageDealtToBoss;     // 所有 Boss 实际受到的伤害总和
+
+public:
+	//玩家沿场地上方从 (100, 100) 起依次排开，Boss 在 y = 120 处均匀分布
+	//pattern 为所有 Boss 共用的出招脚本，为空时使用内置脚本；脚本须比战斗活得久
+	//randomSeed 为战斗种子，决定 Boss 的随机出招，第 j 个 Boss 使用流 randomStream(RANDOM_BOSS, j)，同种子同输入的战斗逐位相同
+	Fight(const Boss01Tuning& tuning = Boss01Tuning(), int playerCount = 1, int bossCount = 1, const PatternProgram* pattern = nullptr,
+		uint64_t randomSeed = 0)
+		:gameState(PLAYING), seed(randomSeed), frame(0), damageTakenByPlayer(0.0f), damageDealtToBoss(0.0f)
+	{
+		for (int i = 0; i < std::max(1, playerCount); i++)
+		{
+			players.push_back(Player(&world, 100.0f + i * 80.0f, 100.0f));
+		}
+		for (int j = 0; j < std::max(1, bossCount); j++)
+		{
+			bosses.push_back(Boss01(&world, SCREEN_WIDTH * (j + 1.0f) / (std::max(1, bossCount) + 1), 120.0f, tuning, pattern,
+				RandomStream(seed, randomStream(RANDOM_BOSS, (uint32_t)j))));
+		}
+		targeting.assign(bosses.size(), TARGET_NEAREST);
+		chosenTarget.assign(bosses.size(), 0);
+	}
+
+	//玩家与 Boss 保存着所在世界的指针，拷贝后要指向自己的 world
+	Fight(const Fight& o)
+		:world(o.world), players(o.players), bosses(o.bosses), targeting(o.targeting), chosenTarget(o.chosenTarget),
+		gameState(o.gameState), seed(o.seed), frame(o.frame), damageTakenByPlayer(o.damageTakenByPlayer), damageDealtToBoss(o.damageDealtToBoss)
+	{
+		attachAll();
+	}
+
+	Fight& operator=(const Fight& o)
+	{
+		world = o.world;
+		players = o.players;
+		bosses = o.bosses;
+		targeting = o.targeting;
+		chosenTarget = o.chosenTarget;
+		gameState = o.gameState;
+		seed = o.seed;
+		frame = o.frame;
+		damageTakenByPlayer = o.damageTakenByPlayer;
+		damageDealtToBoss = o.damageDealtToBoss;
+		attachAll();
+		return *this;
+	}
+
+	//让第 boss 个 Boss 瞄准第 player 个玩家
+	void setBossTarget(int boss, BossTargeting mode, int player = 0)
+	{
+		targeting[boss] = mode;
+		chosenTarget[boss] = player;
+	}
+
+	//一对一时执行一个逻辑帧
+	void tick(PlayerInput input)
+	{
+		tick(&input);
+	}
+
+	//执行一个逻辑帧，inputs 为每个玩家本帧的输入
+	void tick(const PlayerInput* inputs)
+	{
+		// 检查游戏是否应该结束
+		if (allPlayersDown() || allBossesDown())
+		{
+			gameState = GAME_OVER;
+		}
+
+		// 只有在游戏进行中才更新逻辑
+		if (gameState != PLAYING)
+		{
+			return;
+		}
+		frame++;
+		storePreviousPositions(world);
+
+		// 逻辑更新，倒下的角色不再行动
+		{
+			PROFILE_SCOPE(PROFILE_PLAYER_UPDATE);
+			for (size_t i = 0; i < players.size(); i++)
+			{
+				if (players[i].getHp() > 0)
+				{
+					players[i].update(inputs[i]);
+				}
+			}
+		}
+		{
+			PROFILE_SCOPE(PROFILE_BOSS_UPDATE);
+			for (size_t j = 0; j < bosses.size(); j++)
+			{
+				if (bosses[j].getHp() > 0)
+				{
+					const Player& target = players[pickTarget((int)j)];
+					bosses[j].update(target.getX(), target.getY(), target.getHp());
+				}
+			}
+		}
+		updateDamageCooldowns(world);
+		updateAttackStates(world);
+		updateLifetimes(world);
+
+		PROFILE_SCOPE(PROFILE_COLLISION);
+
+		// Boss 的攻击命中玩家：每个攻击池的网格查询只看玩家附近的格子，与攻击总数无关
+		// 命中后玩家进入无敌帧，同一帧内后面的 Boss 不必再查
+		for (Player& player : players)
+		{
+			if (player.getHp() <= 0)
+			{
+				continue;
+			}
+			for (const Boss01& boss : bosses)
+			{
+				float hitDamage = 0.0f;
+				if (boss.getHp() > 0 && boss.getAttacks().checkHit(player.getX(), player.getY(), PLAYER_SIZE, &hitDamage))
+				{
+					damageTakenByPlayer += applyDamage(world, player.getEntity(), hitDamage);
+					// 暂不立即移除攻击，攻击生命周期由 AttackPool 管理
+					break;
+				}
+			}
+		}
+
+		// 玩家的近战攻击命中 Boss
+		meleeSweep.build(world);
+		for (Boss01& boss : bosses)
+		{
+			float hitDamage = 0.0f;
+			if (boss.getHp() > 0 && meleeSweep.query(boss.getX(), boss.getY(), world.get<Hitbox>(boss.getEntity()).radius, &hitDamage))
+			{
+				damageDealtToBoss += applyDamage(world, boss.getEntity(), hitDamage);
+			}
+		}
+	}
+
+	bool isOver() const
+	{
+		return gameState == GAME_OVER || allPlayersDown() || allBossesDown();
+	}
+
+	FightWinner getWinner() const
+	{
+		if (allPlayersDown())
+		{
+			return WINNER_BOSS;
+		}
+		if (allBossesDown())
+		{
+			return WINNER_PLAYER;
+		}
+		return WINNER_NONE;
+	}
+
+	//战斗关键状态的哈希（FNV-1a），用于确认录像回放与原局逐位一致
+	//依次为每个玩家的位置与生命值、每个 Boss 的生命值、伤害总和、帧数与攻击总数
+	uint64_t stateHash() const
+	{
+		uint64_t h = 1469598103934665603ull;
+		auto mix = [&h](const void* data, size_t size)
+		{
+			const unsigned char* bytes = (const unsigned char*)data;
+			for (size_t i = 0; i < size; i++)
+			{
+				h = (h ^ bytes[i]) * 1099511628211ull;
+			}
+		};
+		for (const Player& p : players)
+		{
+			float values[] = { p.getX(), p.getY(), p.getHp() };
+			mix(values, sizeof(values));
+		}
+		for (const Boss01& b : bosses)
+		{
+			float hp = b.getHp();
+			mix(&hp, sizeof(hp));
+		}
+		float totals[] = { damageTakenByPlayer, damageDealtToBoss };
+		int counts[] = { frame, getAttackCount() };
+		mix(totals, sizeof(totals));
+		mix(counts, sizeof(counts));
+		return h;
+	}
+
+	const Player& getPlayer(int i = 0) const { return players[i]; }
+	const Boss01& getBoss(int j = 0) const { return bosses[j]; }
+	int getPlayerCount() const { return (int)players.size(); }
+	int getBossCount() const { return (int)bosses.size(); }
+	const EcsWorld& getWorld() const { return world; }
+	int getFrame() const { return frame; }
+	uint64_t getSeed() const { return seed; }
+	float getDamageTakenByPlayer() const { return damageTakenByPlayer; }
+	float getDamageDealtToBoss() const { return damageDealtToBoss; }
+
+	//把整场战斗写进快照，之后可以任意次恢复
+	void save(FightSnapshot& snapshot) const
+	{
+		SnapshotWriter out(snapshot);
+		uint32_t header[] = { SNAPSHOT_MAGIC, SNAPSHOT_VERSION, (uint32_t)players.size(), (uint32_t)bosses.size() };
+		out.value(header);
+		world.save(out);
+		for (const Player& p : players)
+		{
+			p.save(out);
+		}
+		for (const Boss01& b : bosses)
+		{
+			b.save(out);
+		}
+		out.array(targeting);
+		out.array(chosenTarget);
+		out.value(gameState);
+		out.value(seed);
+		out.value(frame);
+		out.value(damageTakenByPlayer);
+		out.value(damageDealtToBoss);
+	}
+
+	//恢复到快照时的状态；快照的玩家数、Boss 数须与本场相同，出招脚本也应相同（脚本不进快照）
+	//格式不对时返回 false（此时本场状态不可再用）
+	bool restore(const FightSnapshot& snapshot)
+	{
+		SnapshotReader in(snapshot);
+		uint32_t header[4] = {};
+		in.value(header);
+		if (!in.ok || header[0] != SNAPSHOT_MAGIC || header[1] != SNAPSHOT_VERSION
+			|| header[2] != players.size() || header[3] != bosses.size())
+		{
+			return false;
+		}
+		world.load(in);
+		for (Player& p : players)
+		{
+			p.load(in);
+		}
+		for (Boss01& b : bosses)
+		{
+			b.load(in);
+		}
+		in.array(targeting);
+		in.array(chosenTarget);
+		in.value(gameState);
+		in.value(seed);
+		in.value(frame);
+		in.value(damageTakenByPlayer);
+		in.value(damageDealtToBoss);
+		return in.ok && in.finished() && targeting.size() == bosses.size() && chosenTarget.size() == bosses.size();
+	}
+
+	//快照中的玩家数与 Boss 数，用于先建好同样规模的战斗再恢复
+	static bool peekSnapshot(const FightSnapshot& snapshot, int* playerCount, int* bossCount)
+	{
+		SnapshotReader in(snapshot);
+		uint32_t header[4] = {};
+		in.value(header);
+		if (!in.ok || header[0] != SNAPSHOT_MAGIC || header[1] != SNAPSHOT_VERSION)
+		{
+			return false;
+		}
+		*playerCount = (int)header[2];
+		*bossCount = (int)header[3];
+		return true;
+	}
+
+	//给所有 Boss 换参数，用于从同一快照分出不同参数的"假如"模拟
+	void setBossTuning(const Boss01Tuning& tuning)
+	{
+		for (Boss01& b : bosses)
+		{
+			b.setTuning(tuning);
+		}
+	}
+
+	//所有 Boss 场上的攻击总数
+	int getAttackCount() const
+	{
+		int n = 0;
+		for (const Boss01& b : bosses)
+		{
+			n += b.getAttacks().size();
+		}
+		return n;
+	}
+
+#ifndef LUMIN_HEADLESS
+	//绘制场景与 HUD，alpha 为逻辑帧之间的插值比例
+	void draw(float alpha)
+	{
+		// 绘制场景
+		{
+			PROFILE_SCOPE(PROFILE_DRAW_BOSS);
+			for (Boss01& boss : bosses)
+			{
+				boss.draw();
+			}
+		}
+		{
+			PROFILE_SCOPE(PROFILE_DRAW_ATTACKS);
+			for (Boss01& boss : bosses)
+			{
+				boss.drawAttacks(alpha);
+			}
+		}
+		{
+			PROFILE_SCOPE(PROFILE_DRAW_PLAYER);
+			for (Player& player : players)
+			{
+				player.draw(alpha);
+			}
+		}
+
+		// HUD
+		PROFILE_SCOPE(PROFILE_DRAW_HUD);
+		int y = 10;
+		DrawText(TextFormat("FPS: %d", GetFPS()), 10, y, 12, DARKGRAY);
+		for (size_t i = 0; i < players.size(); i++)
+		{
+			y += 20;
+			const char* label = (players.size() == 1) ? TextFormat("Player HP: %d", (int)players[i].getHp())
+				: TextFormat("Player %d HP: %d", (int)i + 1, (int)players[i].getHp());
+			DrawText(label, 10, y, 12, DARKGRAY);
+		}
+		for (const Boss01& boss : bosses)
+		{
+			y += 20;
+			DrawText(TextFormat("%s HP: %d", boss.getName().c_str(), (int)boss.getHp()), 10, y, 12, DARKGRAY);
+		}
+
+		// 若一方全部倒下，显示结束信息（主循环在战斗结束后不再 tick，不能只看 gameState）
+		if (isOver())
+		{
+			if (allPlayersDown())
+			{
+				DrawText("You Died", SCREEN_WIDTH / 2 - 60, SCREEN_HEIGHT / 2 - 10, 20, RED);
+			}
+			else if (allBossesDown())
+			{
+				DrawText("Boss Defeated!", SCREEN_WIDTH / 2 - 90, SCREEN_HEIGHT / 2 - 10, 20, GREEN);
+			}
+			DrawText("Press ESC to exit", SCREEN_WIDTH / 2 - 80, SCREEN_HEIGHT / 2 + 30, 16, DARKGRAY);
+		}
+	}
+#endif
+
+private:
+	void attachAll()
+	{
+		for (Player& p : players)
+		{
+			p.attach(&world);
+		}
+		for (Boss01& b : bosses)
+		{
+			b.attach(&world);
+		}
+	}
+
+	bool allPlayersDown() const
+	{
+		for (const Player& p : players)
+		{
+			if (p.getHp() > 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool allBossesDown() const
+	{
+		for (const Boss01& b : bosses)
+		{
+			if (b.getHp() > 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//Boss 本帧的目标：指定的玩家仍然存活时用它，否则取最近的存活玩家（距离相同取编号小的）
+	int pickTarget(int boss) const
+	{
+		if (targeting[boss] == TARGET_CHOSEN && players[chosenTarget[boss]].getHp() > 0)
+		{
+			return chosenTarget[boss];
+		}
+		float bx = bosses[boss].getX(), by = bosses[boss].getY();
+		int best = 0;
+		float bestDist = 0.0f;
+		bool found = false;
+		for (int i = 0; i < (int)players.size(); i++)
+		{
+			if (players[i].getHp() <= 0)
+			{
+				continue;
+			}
+			float dx = players[i].getX() - bx, dy = players[i].getY() - by;
+			float d = dx * dx + dy * dy;
+			if (!found || d < bestDist)
+			{
+				found = true;
+				best = i;
+				bestDist = d;
+			}
+		}
+		return best;
+	}
+};
@@ -0,0 +1,26 @@
+﻿#pragma once
+
+//定义全局常量
+const int SCREEN_WIDTH = 800;
+const int SCREEN_HEIGHT = 600;
+const int PLAYER_SIZE = 20;
+const int BOSS_SIZE = 60;
+
+//固定逻辑帧率：所有以“帧”为单位的计时、速度都按逻辑帧计算，与渲染帧率无关
+const int LOGIC_TICK_RATE = 60;
+const double LOGIC_DT = 1.0 / LOGIC_TICK_RATE;
+//单次渲染帧最多补算的时间，避免卡顿后追赶过多逻辑帧
+const double MAX_FRAME_TIME = 0.25;
+
+enum GameState {
+	PLAYING,
+	GAME_OVER
+};
+
+//定义预警攻击阶段
+enum AttackPhase
+{
+	WARNING,
+	ACTIVE,
+	COOLDOWN
+};
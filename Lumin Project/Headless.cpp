@@ -0,0 +1,396 @@
+﻿// Headless.cpp : 无窗口模拟入口（Headless 配置，定义 LUMIN_HEADLESS）
+// 不依赖 raylib，用脚本输入跑完整场战斗并输出结果，用于批量平衡测试
+//
+
+#define _CRT_SECURE_NO_WARNINGS
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <string>
+
+#include "GameConfig.h"
+#include "Fight.h"
+#include "InputPolicy.h"
+#include "Simulator.h"
+#include "InputReplay.h"
+#include "NetTransport.h"
+#include "Rollback.h"
+#include "PatternLibrary.h"
+#include "Benchmark.h"
+
+#ifdef LUMIN_HEADLESS
+
+static const char* winnerName(FightWinner w)
+{
+	switch (w)
+	{
+	case WINNER_PLAYER: return "player";
+	case WINNER_BOSS: return "boss";
+	default: return "none";
+	}
+}
+
+static void printUsage()
+{
+	printf("用法: Lumin Project.exe [--policy idle|chase|sloppy] [--seed S] [--max-frames N] [--repeat N] [--record 文件]\n");
+	printf("      Lumin Project.exe --players N --bosses M [--policy P] [--seed S] [--max-frames N]\n");
+	printf("      Lumin Project.exe --replay 文件 [--repeat N]\n");
+	printf("      Lumin Project.exe --simulate N [--threads T] [--policy P] [--seed S] [Boss 参数]\n");
+	printf("      Lumin Project.exe --netplay N [--latency 毫秒] [--jitter 毫秒] [--loss 比例] [--input-delay N] [--udp 起始端口]\n");
+	printf("      Lumin Project.exe --bench [名称]\n");
+	printf("种子: --seed S 同时决定输入脚本与 Boss 的随机出招，录像会保存种子\n");
+	printf("出招脚本: --pattern 文件或内置名称 boss01|spiral|ring|homing|stress（录像不保存脚本，回放时须给出录制时的同一个脚本）\n");
+	printf("Boss 参数: --boss-hp X --attack-delay N --circle-radius X --circle-damage X\n");
+	printf("           --bullet-speed X --bullet-bounces N --aimed-count N --aimed-interval N\n");
+}
+
+//解析 Boss01 可调参数，识别成功返回 true
+static bool parseTuningArg(const char* name, const char* value, Boss01Tuning& t)
+{
+	if (strcmp(name, "--boss-hp") == 0) t.maxHp = (float)atof(value);
+	else if (strcmp(name, "--attack-delay") == 0) t.attackDelay = atoi(value);
+	else if (strcmp(name, "--circle-radius") == 0) t.circleRadius = (float)atof(value);
+	else if (strcmp(name, "--circle-damage") == 0) t.circleDamage = (float)atof(value);
+	else if (strcmp(name, "--bullet-speed") == 0) t.bulletSpeed = (float)atof(value);
+	else if (strcmp(name, "--bullet-bounces") == 0) t.bulletMaxBounces = atoi(value);
+	else if (strcmp(name, "--aimed-count") == 0) t.aimedChainCount = atoi(value);
+	else if (strcmp(name, "--aimed-interval") == 0) t.aimedChainInterval = atoi(value);
+	else return false;
+	return true;
+}
+
+//联机测试参数
+struct NetplayOptions
+{
+	int playerCount = 0;    // 0 表示不做联机测试
+	NetConditions conditions;
+	int inputDelay = 2;
+	int udpPort = 0;        // 非 0 时走本机真实 UDP 端口（起始端口 + 玩家编号），否则走进程内模拟网络
+};
+
+//联机测试：在一个进程里跑 N 个回滚会话，每个会话只操控自己的玩家，经（模拟的）网络交换输入
+//使用虚拟时钟，延迟、抖动与丢包都按种子复现；最后所有会话的状态须与用同样输入离线跑出的结果逐位一致
+static int runNetplay(const NetplayOptions& options, const char* policyName, uint64_t seed, int bossCount, int frames, const Boss01Tuning& tuning, const PatternProgram* pattern)
+{
+	int n = options.playerCount;
+	LoopbackNetwork network(n);
+	std::vector<std::unique_ptr<Transport>> links;
+	std::vector<std::unique_ptr<ConditionedTransport>> conditioned;
+	std::vector<std::unique_ptr<RollbackSession>> sessions;
+	std::vector<std::unique_ptr<InputPolicy>> policies;
+	double clockMs = 0.0;
+
+	std::vector<std::string> addresses;
+	for (int i = 0; i < n; i++)
+	{
+		addresses.push_back("127.0.0.1:" + std::to_string(options.udpPort + i));
+	}
+	for (int i = 0; i < n; i++)
+	{
+		if (options.udpPort)
+		{
+			UdpTransport* udp = new UdpTransport();
+			links.emplace_back(udp);
+			if (!udp->open(i, addresses))
+			{
+				printf("无法打开 UDP 端口: %s\n", addresses[i].c_str());
+				return 1;
+			}
+		}
+		else
+		{
+			links.emplace_back(new LoopbackTransport(network, i));
+		}
+		conditioned.emplace_back(new ConditionedTransport(*links[i], options.conditions, RandomStream(seed, randomStream(RANDOM_NETWORK, (uint32_t)i)), &clockMs));
+
+		RollbackConfig config;
+		config.playerCount = n;
+		config.bossCount = bossCount;
+		config.localPlayer = i;
+		config.inputDelay = options.inputDelay;
+		config.tuning = tuning;
+		config.pattern = pattern;
+		config.seed = seed;
+		sessions.emplace_back(new RollbackSession(*conditioned[i], config));
+		policies.push_back(makeInputPolicy(policyName, seed, i));
+	}
+
+	// 每个玩家实际提交的输入，用于离线对照；等待对方时同一个输入留到下一帧再交
+	int delay = sessions[0]->getInputDelay();
+	std::vector<std::vector<PlayerInput>> log(frames + delay, std::vector<PlayerInput>(n, 0));
+	std::vector<PlayerInput> pending(n, 0);
+	std::vector<bool> hasPending(n, false);
+
+	auto start = std::chrono::steady_clock::now();
+	int ticks = 0;
+	const int tickLimit = frames * 20 + 1000;
+	for (; ticks < tickLimit; ticks++)
+	{
+		bool done = true;
+		for (int i = 0; i < n; i++)
+		{
+			conditioned[i]->flush();
+		}
+		for (int i = 0; i < n; i++)
+		{
+			RollbackSession& session = *sessions[i];
+			if (session.getFrame() >= frames)
+			{
+				session.idle();
+			}
+			else
+			{
+				if (!hasPending[i])
+				{
+					pending[i] = policies[i]->next(session.getFight());
+					hasPending[i] = true;
+				}
+				int target = session.getFrame() + delay;
+				if (session.advance(pending[i]))
+				{
+					log[target][i] = pending[i];
+					hasPending[i] = false;
+				}
+			}
+			done = done && session.getFrame() >= frames && session.getConfirmedFrame() >= frames;
+		}
+		if (done)
+		{
+			break;
+		}
+		clockMs += 1000.0 / LOGIC_TICK_RATE;
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	// 离线对照：同样的输入直接喂给一场本地战斗
+	Fight reference(tuning, n, bossCount, pattern, seed);
+	for (int f = 0; f < frames; f++)
+	{
+		reference.tick(log[f].data());
+	}
+	uint64_t expected = reference.stateHash();
+
+	printf("netplay: %d players, %d bosses, %d frames, latency %.0f+%.0f ms, loss %.0f%%, input delay %d, %s\n",
+		n, bossCount, frames, options.conditions.latencyMs, options.conditions.jitterMs, options.conditions.lossRate * 100.0f,
+		delay, options.udpPort ? "udp" : "loopback");
+	printf("%6s %8s %9s %10s %7s %8s %8s %10s %8s %8s %10s %10s\n", "peer", "frame", "confirmed", "rollbacks", "resim",
+		"stalls", "packets", "bytes/frm", "checks", "desyncs", "save us", "restore us");
+	bool inSync = ticks < tickLimit;
+	for (int i = 0; i < n; i++)
+	{
+		const RollbackSession& session = *sessions[i];
+		const RollbackStats& st = session.getStats();
+		bool same = session.getFight().stateHash() == expected;
+		inSync = inSync && same && st.desyncs == 0;
+		printf("%6d %8d %9d %10d %7d %8d %8d %10.1f %8d %8d %10.2f %10.2f%s\n", i, session.getFrame(), session.getConfirmedFrame(),
+			st.rollbacks, st.resimulatedFrames, st.stalls, st.packetsSent, st.bytesSent / (double)std::max(1, session.getFrame()),
+			st.hashChecks, st.desyncs, st.snapshotNs / 1000.0 / std::max(1, st.snapshots), st.restoreNs / 1000.0 / std::max(1, st.restores),
+			same ? "" : "  <-- 与离线结果不同");
+	}
+	printf("winner: %s\n", winnerName(reference.getWinner()));
+	printf("state hash: %016llx\n", (unsigned long long)expected);
+	printf("in sync: %s (%d ticks, %.3f s)\n", inSync ? "yes" : "NO", ticks, seconds);
+	return inSync ? 0 : 2;
+}
+
+int main(int argc, char* argv[])
+{
+	// 命令行性能测试：--bench [名称]
+	if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+	{
+		return runBenchmarks(argc > 2 ? argv[2] : "all");
+	}
+
+	const char* policyName = nullptr;             // 默认：单场用 chase，批量模拟用 sloppy
+	int maxFrames = LOGIC_TICK_RATE * 60 * 10;   // 默认最多模拟 10 分钟
+	int repeat = 1;
+	int simulateCount = 0;
+	int threadCount = 0;
+	unsigned long long seed = 1;
+	const char* recordPath = nullptr;
+	const char* replayPath = nullptr;
+	int playerCount = 1;
+	int bossCount = 1;
+	NetplayOptions netplay;
+	Boss01Tuning tuning;
+	const char* patternPath = nullptr;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+		if (!value)
+		{
+			printUsage();
+			return 1;
+		}
+
+		if (strcmp(argv[i], "--policy") == 0) policyName = value;
+		else if (strcmp(argv[i], "--max-frames") == 0) maxFrames = atoi(value);
+		else if (strcmp(argv[i], "--repeat") == 0) repeat = atoi(value);
+		else if (strcmp(argv[i], "--simulate") == 0) simulateCount = atoi(value);
+		else if (strcmp(argv[i], "--threads") == 0) threadCount = atoi(value);
+		else if (strcmp(argv[i], "--seed") == 0) seed = strtoull(value, nullptr, 10);
+		else if (strcmp(argv[i], "--record") == 0) recordPath = value;
+		else if (strcmp(argv[i], "--replay") == 0) replayPath = value;
+		else if (strcmp(argv[i], "--players") == 0) playerCount = atoi(value);
+		else if (strcmp(argv[i], "--bosses") == 0) bossCount = atoi(value);
+		else if (strcmp(argv[i], "--netplay") == 0) netplay.playerCount = atoi(value);
+		else if (strcmp(argv[i], "--latency") == 0) netplay.conditions.latencyMs = atof(value);
+		else if (strcmp(argv[i], "--jitter") == 0) netplay.conditions.jitterMs = atof(value);
+		else if (strcmp(argv[i], "--loss") == 0) netplay.conditions.lossRate = (float)atof(value);
+		else if (strcmp(argv[i], "--input-delay") == 0) netplay.inputDelay = atoi(value);
+		else if (strcmp(argv[i], "--udp") == 0) netplay.udpPort = atoi(value);
+		else if (strcmp(argv[i], "--pattern") == 0) patternPath = value;
+		else if (!parseTuningArg(argv[i], value, tuning))
+		{
+			printUsage();
+			return 1;
+		}
+		i++;
+	}
+
+	if (!policyName)
+	{
+		policyName = (simulateCount > 0) ? "sloppy" : "chase";
+	}
+	if (!makeInputPolicy(policyName))
+	{
+		printf("未知的输入来源: %s\n", policyName);
+		return 1;
+	}
+
+	if (playerCount < 1 || bossCount < 1)
+	{
+		printUsage();
+		return 1;
+	}
+
+	// 自定义出招脚本（文件或内置名称），编译失败时给出行号
+	PatternProgram customPattern;
+	const PatternProgram* pattern = nullptr;
+	if (patternPath)
+	{
+		std::string error;
+		if (!loadBoss01Pattern(patternPath, customPattern, error))
+		{
+			printf("出招脚本 %s: %s\n", patternPath, error.c_str());
+			return 1;
+		}
+		pattern = &customPattern;
+	}
+	if (netplay.playerCount > 0)
+	{
+		// 联机测试默认跑 30 秒
+		return runNetplay(netplay, policyName, seed, bossCount, std::min(maxFrames, LOGIC_TICK_RATE * 30), tuning, pattern);
+	}
+
+	// 录像与批量模拟只记录单个玩家的输入
+	if ((playerCount > 1 || bossCount > 1) && (recordPath || replayPath || simulateCount > 0))
+	{
+		printf("--record、--replay、--simulate 只支持一对一战斗\n");
+		return 1;
+	}
+
+	// 批量模拟：多线程运行 simulateCount 场战斗并汇总
+	if (simulateCount > 0)
+	{
+		SimulationConfig config;
+		config.fightCount = simulateCount;
+		config.threadCount = threadCount;
+		config.maxFrames = maxFrames;
+		config.seed = seed;
+		config.policyName = policyName;
+		config.tuning = tuning;
+		config.pattern = pattern;
+
+		std::vector<FightResult> results;
+		auto simStart = std::chrono::steady_clock::now();
+		int used = runSimulation(config, results);
+		double simSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - simStart).count();
+		printSimulationReport(config, results, used, simSeconds);
+		return 0;
+	}
+
+	// 回放录像时使用录像中的 Boss 参数，并在录像结束时停止
+	InputReplay replay;
+	if (replayPath)
+	{
+		if (!replay.load(replayPath))
+		{
+			printf("无法读取录像: %s\n", replayPath);
+			return 1;
+		}
+		tuning = replay.getTuning();
+		seed = replay.getSeed();
+		maxFrames = (int)replay.getFrameCount();
+	}
+	InputRecorder recorder;
+
+	auto start = std::chrono::steady_clock::now();
+	long long totalFrames = 0;
+
+	// 战斗是确定性的，重复运行结果相同，--repeat 用于测量吞吐量
+	for (int r = 0; r < repeat; r++)
+	{
+		Fight fight(tuning, playerCount, bossCount, pattern, seed);
+		// 每个玩家一份输入来源，同一种子下第 i 个玩家使用自己的随机数流
+		std::vector<std::unique_ptr<InputPolicy>> policies;
+		if (replayPath)
+		{
+			replay.rewind();
+			policies.emplace_back(new ReplayPolicy(replay));
+		}
+		else
+		{
+			for (int p = 0; p < playerCount; p++)
+			{
+				policies.push_back(makeInputPolicy(policyName, seed, p));
+			}
+		}
+
+		std::vector<PlayerInput> inputs(playerCount);
+		while (!fight.isOver() && fight.getFrame() < maxFrames)
+		{
+			for (int p = 0; p < playerCount; p++)
+			{
+				inputs[p] = policies[p]->next(fight);
+			}
+			if (recordPath && r == 0)
+			{
+				recorder.record(inputs[0]);
+			}
+			fight.tick(inputs.data());
+		}
+		totalFrames += fight.getFrame();
+
+		if (r == 0)
+		{
+			if (playerCount > 1 || bossCount > 1)
+			{
+				printf("players: %d  bosses: %d\n", playerCount, bossCount);
+			}
+			printf("winner: %s\n", winnerName(fight.getWinner()));
+			printf("frames: %d (%.1f s)\n", fight.getFrame(), fight.getFrame() / (double)LOGIC_TICK_RATE);
+			printf("damage to player: %.0f\n", fight.getDamageTakenByPlayer());
+			printf("damage to boss: %.0f\n", fight.getDamageDealtToBoss());
+			printf("state hash: %016llx\n", (unsigned long long)fight.stateHash());
+		}
+	}
+
+	if (recordPath && !recorder.save(recordPath, tuning, seed))
+	{
+		printf("无法写入录像: %s\n", recordPath);
+		return 1;
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	printf("simulated %lld frames in %.3f s (%.0f frames/s)\n", totalFrames, seconds, totalFrames / (seconds > 0 ? seconds : 1e-9));
+	return 0;
+}
+
+#endif
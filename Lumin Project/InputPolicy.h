@@ -0,0 +1,171 @@
+﻿#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "GameConfig.h"
+#include "PlayerInput.h"
+#include "Fight.h"
+#include "InputReplay.h"
+#include "Random.h"
+
+//输入来源：无窗口模拟时代替键盘，每个逻辑帧给出一次输入
+class InputPolicy
+{
+public:
+	virtual ~InputPolicy() {}
+	virtual PlayerInput next(const Fight& fight) = 0;
+};
+
+//站着不动
+class IdlePolicy : public InputPolicy
+{
+public:
+	PlayerInput next(const Fight& fight) override
+	{
+		return 0;
+	}
+};
+
+//简单脚本：躲开圆形攻击范围，否则贴近最近的 Boss 并持续攻击
+//带种子时会随机犯错（偶尔不躲、攻击节奏抖动），用于批量模拟不同水平的玩家
+//多人战斗时每个玩家各用一份，playerIndex 指定操控的是第几个玩家，同一种子下各玩家使用各自的随机数流
+class ChasePolicy : public InputPolicy
+{
+private:
+	float attackRange;   // 进入该距离后开始攻击
+	int attackEvery;     // 每隔多少逻辑帧按一次攻击
+	float mistakeRate;   // 每帧忽略危险的概率
+	RandomStream rng;
+	int nextAttackFrame;
+	int playerIndex;
+
+public:
+	ChasePolicy(float range = 50.0f, int every = 16, float mistakes = 0.0f, uint64_t seed = 0, int player = 0)
+		:attackRange(range), attackEvery(every), mistakeRate(mistakes), rng(seed, randomStream(RANDOM_INPUT, (uint32_t)player)), nextAttackFrame(0), playerIndex(player) {
+	}
+
+	PlayerInput next(const Fight& fight) override
+	{
+		const Player& player = fight.getPlayer(playerIndex);
+		float px = player.getX();
+		float py = player.getY();
+
+		// 站在任一 Boss 预警或激活中的圆形攻击里时，往圆外跑
+		float awayX = 0.0f, awayY = 0.0f;
+		bool danger = false;
+		int nearest = 0;
+		float nearestDist = -1.0f;
+		for (int j = 0; j < fight.getBossCount(); j++)
+		{
+			const Boss01& b = fight.getBoss(j);
+			if (b.getHp() <= 0)
+			{
+				continue;
+			}
+			const AttackPool& pool = b.getAttacks();
+			accumulateDanger(pool.getCircleAttacks(), px, py, awayX, awayY, danger);
+			accumulateDanger(pool.getAimedCircleAttacks(), px, py, awayX, awayY, danger);
+
+			float bx = b.getX() - px, by = b.getY() - py;
+			float d = bx * bx + by * by;
+			if (nearestDist < 0.0f || d < nearestDist)
+			{
+				nearest = j;
+				nearestDist = d;
+			}
+		}
+		if (danger && (mistakeRate <= 0.0f || rng.nextFloat() >= mistakeRate))
+		{
+			return directionBits(awayX, awayY);
+		}
+
+		const Boss01& boss = fight.getBoss(nearest);
+		float dx = boss.getX() - px;
+		float dy = boss.getY() - py;
+		float dist = sqrtf(dx * dx + dy * dy);
+		if (dist > attackRange)
+		{
+			return directionBits(dx, dy);
+		}
+
+		// 已贴近：朝 Boss 方向按攻击，攻击方向取本帧的移动方向
+		PlayerInput input = directionBits(dx, dy);
+		if (fight.getFrame() >= nextAttackFrame)
+		{
+			input |= INPUT_ATTACK;
+			nextAttackFrame = fight.getFrame() + (mistakeRate > 0.0f ? rng.nextInt(attackEvery - 4, attackEvery + 4) : attackEvery);
+		}
+		return input;
+	}
+
+private:
+	static void accumulateDanger(const CircleAttackArray& a, float px, float py, float& awayX, float& awayY, bool& danger)
+	{
+		for (int i = 0; i < a.size(); i++)
+		{
+			if (a.phase[i] == COOLDOWN)
+			{
+				continue;
+			}
+			float dx = px - a.x[i];
+			float dy = py - a.y[i];
+			float rr = a.radius[i] + PLAYER_SIZE;
+			if (dx * dx + dy * dy < rr * rr)
+			{
+				// 正好站在圆心时随便选一个方向
+				awayX += (dx == 0.0f && dy == 0.0f) ? 1.0f : dx;
+				awayY += dy;
+				danger = true;
+			}
+		}
+	}
+
+	//把方向向量转成 8 方向按键
+	static PlayerInput directionBits(float dx, float dy)
+	{
+		PlayerInput input = 0;
+		float ax = fabsf(dx), ay = fabsf(dy);
+		if (dx > ay * 0.4f) input |= INPUT_RIGHT;
+		if (dx < -ay * 0.4f) input |= INPUT_LEFT;
+		if (dy > ax * 0.4f) input |= INPUT_DOWN;
+		if (dy < -ax * 0.4f) input |= INPUT_UP;
+		return input;
+	}
+};
+
+//按录像逐帧回放
+class ReplayPolicy : public InputPolicy
+{
+private:
+	InputReplay& replay;
+
+public:
+	ReplayPolicy(InputReplay& r) :replay(r) {}
+
+	PlayerInput next(const Fight& fight) override
+	{
+		return replay.next();
+	}
+};
+
+//按名称创建输入来源，未知名称返回空
+//chase 为不犯错的脚本，sloppy 为按种子随机犯错的脚本，player 为操控的玩家编号
+inline std::unique_ptr<InputPolicy> makeInputPolicy(const char* name, uint64_t seed = 0, int player = 0)
+{
+	if (strcmp(name, "idle") == 0)
+	{
+		return std::unique_ptr<InputPolicy>(new IdlePolicy());
+	}
+	if (strcmp(name, "chase") == 0)
+	{
+		return std::unique_ptr<InputPolicy>(new ChasePolicy(50.0f, 16, 0.0f, 0, player));
+	}
+	if (strcmp(name, "sloppy") == 0)
+	{
+		return std::unique_ptr<InputPolicy>(new ChasePolicy(50.0f, 16, 0.2f, seed, player));
+	}
+	return nullptr;
+}
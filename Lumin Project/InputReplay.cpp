@@ -0,0 +1,266 @@
+﻿// InputReplay.cpp : 输入录像的读写
+//
+
+#define _CRT_SECURE_NO_WARNINGS
+#include <cstdio>
+#include <cstring>
+
+#include "GameConfig.h"
+#include "InputReplay.h"
+
+namespace
+{
+	const char REPLAY_MAGIC[4] = { 'L', 'R', 'P', 'L' };
+	const uint8_t REPLAY_VERSION = 2;     // 2：加入战斗种子；1 版录像按种子 0 读取
+
+	//按小端顺序写入，文件在不同平台间通用
+	class ByteWriter
+	{
+	public:
+		std::vector<uint8_t> bytes;
+
+		void u8(uint8_t v)
+		{
+			bytes.push_back(v);
+		}
+
+		void u16(uint16_t v)
+		{
+			u8((uint8_t)v);
+			u8((uint8_t)(v >> 8));
+		}
+
+		void u32(uint32_t v)
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				u8((uint8_t)(v >> (8 * i)));
+			}
+		}
+
+		void i32(int v)
+		{
+			u32((uint32_t)v);
+		}
+
+		void u64(uint64_t v)
+		{
+			u32((uint32_t)v);
+			u32((uint32_t)(v >> 32));
+		}
+
+		void f32(float v)
+		{
+			uint32_t bits;
+			memcpy(&bits, &v, sizeof(bits));
+			u32(bits);
+		}
+
+		//变长整数：每字节 7 位，最高位表示后面还有
+		void varint(uint32_t v)
+		{
+			while (v >= 0x80)
+			{
+				u8((uint8_t)(v | 0x80));
+				v >>= 7;
+			}
+			u8((uint8_t)v);
+		}
+	};
+
+	class ByteReader
+	{
+	private:
+		const std::vector<uint8_t>& bytes;
+		size_t pos;
+
+	public:
+		bool ok;
+
+		ByteReader(const std::vector<uint8_t>& b) :bytes(b), pos(0), ok(true) {}
+
+		uint8_t u8()
+		{
+			if (pos >= bytes.size())
+			{
+				ok = false;
+				return 0;
+			}
+			return bytes[pos++];
+		}
+
+		uint16_t u16()
+		{
+			uint16_t lo = u8();
+			return (uint16_t)(lo | (u8() << 8));
+		}
+
+		uint32_t u32()
+		{
+			uint32_t v = 0;
+			for (int i = 0; i < 4; i++)
+			{
+				v |= (uint32_t)u8() << (8 * i);
+			}
+			return v;
+		}
+
+		int i32()
+		{
+			return (int)u32();
+		}
+
+		uint64_t u64()
+		{
+			uint64_t lo = u32();
+			return lo | ((uint64_t)u32() << 32);
+		}
+
+		float f32()
+		{
+			uint32_t bits = u32();
+			float v;
+			memcpy(&v, &bits, sizeof(v));
+			return v;
+		}
+
+		uint32_t varint()
+		{
+			uint32_t v = 0;
+			for (int shift = 0; shift < 35; shift += 7)
+			{
+				uint8_t b = u8();
+				v |= (uint32_t)(b & 0x7F) << shift;
+				if (!(b & 0x80))
+				{
+					return v;
+				}
+			}
+			ok = false;
+			return 0;
+		}
+	};
+
+	void writeTuning(ByteWriter& w, const Boss01Tuning& t)
+	{
+		w.f32(t.maxHp);
+		w.i32(t.attackDelay);
+		w.f32(t.nearDistance);
+		w.f32(t.circleRadius);
+		w.f32(t.circleDamage);
+		w.f32(t.bulletSpeed);
+		w.i32(t.bulletMaxBounces);
+		w.f32(t.bulletSpread);
+		w.f32(t.aimedRadius);
+		w.f32(t.aimedDamage);
+		w.i32(t.aimedChainCount);
+		w.i32(t.aimedChainInterval);
+	}
+
+	void readTuning(ByteReader& r, Boss01Tuning& t)
+	{
+		t.maxHp = r.f32();
+		t.attackDelay = r.i32();
+		t.nearDistance = r.f32();
+		t.circleRadius = r.f32();
+		t.circleDamage = r.f32();
+		t.bulletSpeed = r.f32();
+		t.bulletMaxBounces = r.i32();
+		t.bulletSpread = r.f32();
+		t.aimedRadius = r.f32();
+		t.aimedDamage = r.f32();
+		t.aimedChainCount = r.i32();
+		t.aimedChainInterval = r.i32();
+	}
+}
+
+bool InputRecorder::save(const char* path, const Boss01Tuning& tuning, uint64_t seed) const
+{
+	ByteWriter w;
+	for (char c : REPLAY_MAGIC)
+	{
+		w.u8((uint8_t)c);
+	}
+	w.u8(REPLAY_VERSION);
+	w.u16((uint16_t)LOGIC_TICK_RATE);
+	writeTuning(w, tuning);
+	w.u64(seed);
+	w.u32(frameCount);
+	w.u32((uint32_t)runs.size());
+	for (const InputRun& run : runs)
+	{
+		w.u8(run.input);
+		w.varint(run.count);
+	}
+
+	FILE* f = fopen(path, "wb");
+	if (!f)
+	{
+		return false;
+	}
+	bool ok = fwrite(w.bytes.data(), 1, w.bytes.size(), f) == w.bytes.size();
+	fclose(f);
+	return ok;
+}
+
+bool InputReplay::load(const char* path)
+{
+	FILE* f = fopen(path, "rb");
+	if (!f)
+	{
+		return false;
+	}
+	std::vector<uint8_t> bytes;
+	uint8_t buffer[4096];
+	size_t n;
+	while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+	{
+		bytes.insert(bytes.end(), buffer, buffer + n);
+	}
+	fclose(f);
+
+	ByteReader r(bytes);
+	for (char c : REPLAY_MAGIC)
+	{
+		if (r.u8() != (uint8_t)c)
+		{
+			return false;
+		}
+	}
+	// 逻辑帧率不同的录像无法逐帧复现
+	uint8_t version = r.u8();
+	if ((version != 1 && version != REPLAY_VERSION) || r.u16() != LOGIC_TICK_RATE)
+	{
+		return false;
+	}
+	readTuning(r, tuning);
+	seed = (version >= 2) ? r.u64() : 0;
+	frameCount = r.u32();
+	uint32_t runCount = r.u32();
+	if (!r.ok)
+	{
+		return false;
+	}
+
+	// 长度为 0 的段在 next() 中仍会播放一帧，使后面的输入错位；总帧数用 64 位累加，防止溢出后凑巧相等
+	runs.clear();
+	uint64_t total = 0;
+	bool emptyRun = false;
+	for (uint32_t i = 0; i < runCount && r.ok && !emptyRun; i++)
+	{
+		InputRun run;
+		run.input = r.u8();
+		run.count = r.varint();
+		emptyRun = (run.count == 0);
+		total += run.count;
+		runs.push_back(run);
+	}
+	if (!r.ok || emptyRun || total != frameCount)
+	{
+		runs.clear();
+		return false;
+	}
+
+	rewind();
+	return true;
+}
@@ -0,0 +1,111 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "PlayerInput.h"
+#include "Boss.h"
+
+//录像文件格式（小端）：
+//  "LRPL"  魔数
+//  u8      版本号
+//  u16     逻辑帧率
+//  ...     Boss01Tuning 各字段
+//  u64     战斗种子（版本 2 起）
+//  u32     总帧数
+//  u32     段数
+//  之后每段：u8 按键位掩码 + 变长整数(LEB128) 重复帧数
+//按键通常连续按住很多帧，按段存放后一分钟的录像只有几百字节
+
+//一段相同输入
+struct InputRun
+{
+	PlayerInput input;
+	uint32_t count;
+};
+
+//录制：每个逻辑帧记录一次输入
+class InputRecorder
+{
+private:
+	std::vector<InputRun> runs;
+	uint32_t frameCount;
+
+public:
+	InputRecorder() :frameCount(0) {}
+
+	void record(PlayerInput input)
+	{
+		if (!runs.empty() && runs.back().input == input)
+		{
+			runs.back().count++;
+		}
+		else
+		{
+			runs.push_back({ input, 1 });
+		}
+		frameCount++;
+	}
+
+	uint32_t getFrameCount() const
+	{
+		return frameCount;
+	}
+
+	//写入文件，失败返回 false；seed 为录制时的战斗种子，回放时须用同一个种子才能复现 Boss 的随机出招
+	bool save(const char* path, const Boss01Tuning& tuning, uint64_t seed) const;
+};
+
+//回放：按录制顺序逐帧给出输入
+class InputReplay
+{
+private:
+	std::vector<InputRun> runs;
+	Boss01Tuning tuning;
+	uint64_t seed;
+	uint32_t frameCount;
+	size_t runIndex;      // 当前所在段
+	uint32_t runOffset;   // 当前段内已回放的帧数
+	uint32_t played;
+
+public:
+	InputReplay() :seed(0), frameCount(0), runIndex(0), runOffset(0), played(0) {}
+
+	//读取文件，格式不对或版本不支持时返回 false
+	bool load(const char* path);
+
+	//下一帧输入，回放结束后返回 0
+	PlayerInput next()
+	{
+		if (runIndex >= runs.size())
+		{
+			return 0;
+		}
+		PlayerInput input = runs[runIndex].input;
+		played++;
+		if (++runOffset >= runs[runIndex].count)
+		{
+			runIndex++;
+			runOffset = 0;
+		}
+		return input;
+	}
+
+	bool finished() const
+	{
+		return runIndex >= runs.size();
+	}
+
+	//从头开始回放
+	void rewind()
+	{
+		runIndex = 0;
+		runOffset = 0;
+		played = 0;
+	}
+
+	const Boss01Tuning& getTuning() const { return tuning; }
+	uint64_t getSeed() const { return seed; }
+	uint32_t getFrameCount() const { return frameCount; }
+	uint32_t getPlayedFrames() const { return played; }
+};
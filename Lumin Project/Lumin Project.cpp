@@ -9,961 +9,277 @@
 #include <ctime>
 #include <cstdio>
 #include <string>
+#include <cstring>
+#include <cstdlib>
 #include <memory>
 
+#include "GameConfig.h"
+#include "PlayerInput.h"
+#include "Fight.h"
+#include "InputReplay.h"
+#include "InputPolicy.h"
+#include "NetTransport.h"
+#include "Rollback.h"
+#include "PatternLibrary.h"
+#include "Benchmark.h"
+#include "Profiler.h"
+
+//窗口版入口；Headless 配置（LUMIN_HEADLESS）使用 Headless.cpp 中的入口
+#ifndef LUMIN_HEADLESS
 #include "raylib.h"
 
-//定义全局常量
-const int SCREEN_WIDTH = 800;
-const int SCREEN_HEIGHT = 600;
-const int PLAYER_SIZE = 20;
-const int BOSS_SIZE = 60;
-
-enum GameState {
-	PLAYING,
-	GAME_OVER
-};
-
-//定义预警攻击阶段
-enum AttackPhase
+//读取键盘当前按住的方向键（攻击键的按下沿由主循环单独处理）
+PlayerInput readKeyboardInput()
 {
-	WARNING,
-	ACTIVE,
-	COOLDOWN
-};
-
-//基类攻击
-class Attack
+	PlayerInput input = 0;
+	if (IsKeyDown(KEY_W)) input |= INPUT_UP;
+	if (IsKeyDown(KEY_S)) input |= INPUT_DOWN;
+	if (IsKeyDown(KEY_A)) input |= INPUT_LEFT;
+	if (IsKeyDown(KEY_D)) input |= INPUT_RIGHT;
+	return input;
+}
+
+int main(int argc, char* argv[])
 {
-	//基类基础属性
-protected:
-	AttackPhase phase;
-	int timer;
-	float x, y;
-	float radius;
-	float damage;
-
-	//构造函数与析构函数
-public:
-	Attack(float cx, float cy, float r, float dmg = 1.0f)
-		:phase(WARNING), timer(0), x(cx), y(cy), radius(r), damage(dmg) {
-	}
-	virtual ~Attack() {}
-
-	//更新计时器状态
-	virtual void update(float playerX, float playerY)
-	{
-		timer++;
-	}
-
-	//绘制攻击
-	virtual void draw() = 0;
-
-	//碰撞检测
-	virtual bool checkCollision(float playerX, float playerY, float playerSize)
-	{
-		return false;
-	}
-
-	//安全性之通过函数接口访问类成员
-	AttackPhase getPhase() const
-	{
-		return phase;
-	}
-
-	float getDamage() const
-	{
-		return damage;
-	}
-
-	float getX() const { return x; }
-	float getY() const { return y; }
-	float getRadius() const { return radius; }
-
-	//计算与玩家距离
-protected:
-	float distanceTo(float playerX, float playerY)
+	// 命令行性能测试：--bench [名称]
+	if (argc > 1 && strcmp(argv[1], "--bench") == 0)
 	{
-		float dx = playerX - x;
-		float dy = playerY - y;
-		return sqrtf(dx * dx + dy * dy);
+		return runBenchmarks(argc > 2 ? argv[2] : "all");
 	}
 
-};
-
-//派生类攻击
-class CircleAttack :public Attack
-{
-private:
-	int warningTime;
-	int activeTime;
-
-public:
-	CircleAttack(float cx, float cy, float r, float dmg = 25.0f)
-		:Attack(cx, cy, r, dmg), warningTime(75), activeTime(25) {
-	}
-
-	void update(float playerX, float playerY) override
+	// 录像：--record 文件 录下每个逻辑帧的输入，--replay 文件 按录像回放
+	// 多人：--players N --bosses M，1 号玩家用键盘，其余玩家由脚本操控
+	// 联机：--net 本机编号 全部玩家地址（如 --net 0 192.168.1.2:7000,192.168.1.3:7000），每台机器操控自己的玩家
+	// 出招：--pattern 文件或内置名称（spiral、ring、homing、stress 等，见 PatternLibrary.h）代替 Boss 的内置出招（联机时各台机器须使用同一个脚本）
+	// 种子：--seed S 固定 Boss 的随机出招；单机默认取当前时间，联机默认为 0（各台机器须相同）
+	const char* recordPath = nullptr;
+	const char* seedText = nullptr;
+	const char* patternPath = nullptr;
+	const char* replayPath = nullptr;
+	int playerCount = 1;
+	int bossCount = 1;
+	int netPlayer = -1;
+	std::vector<std::string> netAddresses;
+	for (int i = 1; i + 1 < argc; i++)
 	{
-		Attack::update(playerX, playerY);
-
-		if (phase == WARNING && timer > warningTime)
-		{
-			phase = ACTIVE;
-			timer = 0;
-		}
-		else if (phase == ACTIVE && timer > activeTime)
+		if (strcmp(argv[i], "--record") == 0) recordPath = argv[++i];
+		else if (strcmp(argv[i], "--replay") == 0) replayPath = argv[++i];
+		else if (strcmp(argv[i], "--players") == 0) playerCount = std::max(1, atoi(argv[++i]));
+		else if (strcmp(argv[i], "--bosses") == 0) bossCount = std::max(1, atoi(argv[++i]));
+		else if (strcmp(argv[i], "--pattern") == 0) patternPath = argv[++i];
+		else if (strcmp(argv[i], "--seed") == 0) seedText = argv[++i];
+		else if (strcmp(argv[i], "--net") == 0 && i + 2 < argc)
 		{
-			phase = COOLDOWN;
-			timer = 0;
+			netPlayer = atoi(argv[++i]);
+			netAddresses = splitAddressList(argv[++i]);
+			playerCount = (int)netAddresses.size();
 		}
 	}
-
-	void draw() override
+	if ((playerCount > 1 || bossCount > 1) && (recordPath || replayPath))
 	{
-
-		// WARNING: 显示黄色圆环（外圈）
-		if (phase == WARNING)
-		{
-			DrawCircleLines((int)x, (int)y, radius, BLACK);
-			DrawText("!", (int)x - 6, (int)y - 6, 20, YELLOW);
-		}
-		// ACTIVE: 红色填充圈
-		else if (phase == ACTIVE)
-		{
-			DrawCircle((int)x, (int)y, radius, Fade(RED, 0.25f));
-			DrawCircleLines((int)x, (int)y, radius, RED);
-		}
-		// COOLDOWN: 轻微灰色淡化
-		else if (phase == COOLDOWN)
-		{
-			DrawCircleLines((int)x, (int)y, radius, LIGHTGRAY);
-		}
+		printf("--record、--replay 只支持一对一战斗\n");
+		return 1;
 	}
 
-	bool checkCollision(float playerX, float playerY, float playerSize) override
+	PatternProgram customPattern;
+	const PatternProgram* pattern = nullptr;
+	if (patternPath)
 	{
-		if (phase != ACTIVE)
+		std::string error;
+		if (!loadBoss01Pattern(patternPath, customPattern, error))
 		{
-			return false;
+			printf("出招脚本 %s: %s\n", patternPath, error.c_str());
+			return 1;
 		}
-		return distanceTo(playerX, playerY) < (radius + playerSize / 2.0f);
+		pattern = &customPattern;
 	}
 
-};
+	uint64_t seed = seedText ? strtoull(seedText, nullptr, 10) : (netPlayer >= 0 ? 0 : (uint64_t)time(nullptr));
 
-//可反弹攻击类型
-class BounceBulletAttack : public Attack
-{
-private:
-	float speed;           // 子弹速度
-	float directionX;      // X方向向量
-	float directionY;      // Y方向向量
-	int bounceCount;       // 当前反弹次数
-	int maxBounces;        // 最大反弹次数
-	float rotation;        // 旋转角度
-	float rotationSpeed;   // 旋转速度（每秒弧度）
-	int warningTime;       // 预警时间（帧数）
-
-public:
-	BounceBulletAttack(float cx, float cy, float dirX, float dirY, float spd = 10.0f, int maxBounce = 4, float dmg = 15.0f)
-		: Attack(cx, cy, 10.0f, dmg),  // 子弹半径为8
-		directionX(dirX), directionY(dirY),
-		speed(spd), bounceCount(0), maxBounces(maxBounce),
-		rotation(0.0f), rotationSpeed(0.1f), warningTime(30)  // 预警时间设为60帧（1秒）
+	UdpTransport udp;
+	std::unique_ptr<RollbackSession> session;
+	if (netPlayer >= 0)
 	{
-		phase = WARNING;  // 改为先进入预警阶段
-	}
-
-	void update(float playerX, float playerY) override
-	{
-		Attack::update(playerX, playerY);
-
-		// 预警阶段结束后进入激活阶段
-		if (phase == WARNING && timer > warningTime)
+		if (!udp.open(netPlayer, netAddresses))
 		{
-			phase = ACTIVE;
-			timer = 0;  // 重置计时器
-		}
-		// 激活阶段才更新位置和旋转
-		else if (phase == ACTIVE)
-		{
-			// 更新位置
-			x += directionX * speed;
-			y += directionY * speed;
-
-			// 更新旋转
-			rotation += rotationSpeed;
-			if (rotation > 2 * M_PI) rotation -= 2 * M_PI;
-
-			// 边界检测与反弹
-			checkWallCollision();
-
-			// 超过最大反弹次数或飞出屏幕过远则进入冷却（销毁）
-			if (bounceCount >= maxBounces || isOutOfBounds())
-			{
-				phase = COOLDOWN;
-			}
+			printf("无法打开联机端口\n");
+			return 1;
 		}
+		RollbackConfig config;
+		config.playerCount = playerCount;
+		config.bossCount = bossCount;
+		config.localPlayer = netPlayer;
+		config.pattern = pattern;
+		config.seed = seed;
+		session.reset(new RollbackSession(udp, config));
 	}
 
-	void draw() override
+	InputRecorder recorder;
+	InputReplay replay;
+	Boss01Tuning tuning;
+	if (replayPath)
 	{
-		if (phase == WARNING)
+		if (!replay.load(replayPath))
 		{
-			// 预警阶段在BOSS位置显示"!"
-			DrawText("!", (int)x - 6, (int)y - 6, 20, YELLOW);
-
-			// 绘制延伸至屏幕边缘的方向指示器（全屏幕长度）
-			// 计算射线与屏幕边缘的交点
-			float t;
-			float edgeX, edgeY;
-
-			// 计算射线与屏幕边界的交点（使用射线与直线相交算法）
-			if (directionX > 0)
-			{
-				t = (SCREEN_WIDTH - x) / directionX;
-			}
-			else if (directionX < 0)
-			{
-				t = (-x) / directionX;
-			}
-			else
-			{
-				t = FLT_MAX; // 垂直方向射线，先不考虑X方向
-			}
-
-			// 检查Y方向边界
-			float tY;
-			if (directionY > 0)
-			{
-				tY = (SCREEN_HEIGHT - y) / directionY;
-			}
-			else if (directionY < 0)
-			{
-				tY = (-y) / directionY;
-			}
-			else
-			{
-				tY = FLT_MAX; // 水平方向射线，先不考虑Y方向
-			}
-
-			// 取较小的t值，确定先与哪个边界相交
-			t = fminf(t, tY);
-			edgeX = x + directionX * t;
-			edgeY = y + directionY * t;
-
-			// 绘制从起点到屏幕边缘的预警线
-			DrawLineV({ x, y }, { edgeX, edgeY }, Fade(BLACK, 0.5f));
-		}
-		else if (phase == ACTIVE)
-		{
-			// 绘制旋转的三角形子弹
-			Vector2 points[3];
-			float triSize = radius * 2;  // 三角形大小
-
-			// 计算旋转后的三角形顶点
-			points[0] = { x + cosf(rotation) * triSize, y + sinf(rotation) * triSize };
-			points[1] = { x + cosf(rotation + 2 * M_PI / 3) * triSize, y + sinf(rotation + 2 * M_PI / 3) * triSize };
-			points[2] = { x + cosf(rotation + 4 * M_PI / 3) * triSize, y + sinf(rotation + 4 * M_PI / 3) * triSize };
-
-			DrawTriangle(points[0], points[1], points[2], ORANGE);
-			DrawTriangleLines(points[0], points[1], points[2], ORANGE);
+			printf("无法读取录像: %s\n", replayPath);
+			return 1;
 		}
+		tuning = replay.getTuning();
+		seed = replay.getSeed();
 	}
 
-	// 其余方法保持不变...
-	bool checkCollision(float playerX, float playerY, float playerSize) override
-	{
-		if (phase != ACTIVE) return false;
-		return distanceTo(playerX, playerY) < (radius + playerSize / 2.0f);
-	}
-
-private:
-	void checkWallCollision()
-	{
-		// 左右边界反弹
-		if (x - radius < 0)
-		{
-			x = radius;  // 防止卡在墙内
-			directionX = -directionX;
-			bounceCount++;
-		}
-		else if (x + radius > SCREEN_WIDTH)
-		{
-			x = SCREEN_WIDTH - radius;
-			directionX = -directionX;
-			bounceCount++;
-		}
-
-		// 上下边界反弹
-		if (y - radius < 0)
-		{
-			y = radius;
-			directionY = -directionY;
-			bounceCount++;
-		}
-		else if (y + radius > SCREEN_HEIGHT)
-		{
-			y = SCREEN_HEIGHT - radius;
-			directionY = -directionY;
-			bounceCount++;
-		}
-	}
-
-	bool isOutOfBounds()
-	{
-		return x < -50 || x > SCREEN_WIDTH + 50 || y < -50 || y > SCREEN_HEIGHT + 50;
-	}
-};
-
-
-// 新增瞄准圆形攻击类
-class AimedCircleAttack : public Attack
-{
-private:
-	int warningTime;  // 短预警时间
-	int activeTime;
-
-public:
-	AimedCircleAttack(float cx, float cy, float r, float dmg = 15.0f)
-		: Attack(cx, cy, r, dmg), warningTime(20), activeTime(20) {
-	}  // 短预警时间（0.5秒）
-
-	void update(float playerX, float playerY) override
-	{
-		Attack::update(playerX, playerY);
-
-		if (phase == WARNING && timer > warningTime)
-		{
-			phase = ACTIVE;
-			timer = 0;
-		}
-		else if (phase == ACTIVE && timer > activeTime)
-		{
-			phase = COOLDOWN;
-			timer = 0;
-		}
-	}
-
-	void draw() override
-	{
-		if (phase == WARNING)
-		{
-			DrawCircleLines((int)x, (int)y, radius, ORANGE);
-			DrawText("!", (int)x - 6, (int)y - 6, 16, ORANGE);
-		}
-		else if (phase == ACTIVE)
-		{
-			DrawCircle((int)x, (int)y, radius, Fade(ORANGE, 0.3f));
-			DrawCircleLines((int)x, (int)y, radius, ORANGE);
-		}
-		else if (phase == COOLDOWN)
-		{
-			DrawCircleLines((int)x, (int)y, radius, LIGHTGRAY);
-		}
-	}
+	// 不再限制帧率，由垂直同步决定渲染速度；逻辑以固定 LOGIC_TICK_RATE 运行
+	SetConfigFlags(FLAG_VSYNC_HINT);
+	InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Demo - Boss & Player (raylib)");
 
-	bool checkCollision(float playerX, float playerY, float playerSize) override
+	Fight fight(tuning, playerCount, bossCount, pattern, seed);
+	std::vector<std::unique_ptr<InputPolicy>> bots;
+	for (int i = 1; i < playerCount; i++)
 	{
-		if (phase != ACTIVE)
-			return false;
-		return distanceTo(playerX, playerY) < (radius + playerSize / 2.0f);
+		bots.push_back(makeInputPolicy("chase", 0, i));
 	}
-};
+	std::vector<PlayerInput> inputs(playerCount);
 
+	// 固定步长：累计真实时间，每满 LOGIC_DT 执行一次逻辑帧
+	double accumulator = 0.0;
+	double previousTime = GetTime();
+	bool attackQueued = false;   // 攻击键按下沿保留到下一个逻辑帧，避免本渲染帧没有逻辑帧时丢失
 
-//基类Boss
-class Boss
-{
-protected:
-	float x, y;
-	float hp, maxHp;
-	std::string name;
-	int attackDelay;
-	bool damageCooldown;
-	int damageTimer;
-	std::vector<std::shared_ptr<Attack>> attacks;
-
-public:
-	Boss(float cx, float cy, float health, const std::string n)
-		:x(cx), y(cy), hp(health), maxHp(health), name(n), attackDelay(0), damageCooldown(false), damageTimer(35) {
-	}
-	virtual ~Boss() {}
-
-	virtual void update(float playerX, float playerY, float playerHp)
+	while (!WindowShouldClose())
 	{
-		if (attackDelay > 0)
-		{
-			attackDelay--;
-		}
-		if (attackDelay == 0)
-		{
-			doAttack(playerX, playerY);
-			attackDelay = getAttackDelay();
-		}
-
-
+		int64_t frameStartNs = Profiler::nowNs();
 
-		//以下小段涉及攻击生成部分正在研究
-		for (auto it = attacks.begin(); it != attacks.end();)
+		// F3 开关性能分析叠加层，F4 导出最近的 Chrome trace
+		if (IsKeyPressed(KEY_F3))
 		{
-			(*it)->update(playerX, playerY);
-
-			if ((*it)->getPhase() == COOLDOWN)
-			{
-				it = attacks.erase(it);
-			}
-			else
-			{
-				++it;
-			}
+			gProfiler.setEnabled(!gProfiler.isEnabled());
 		}
-
-		if (damageCooldown)
+		if (IsKeyPressed(KEY_F4) && gProfiler.isEnabled())
 		{
-			damageTimer--;
-			if (damageTimer <= 0)
+			const char* tracePath = "profile_trace.json";
+			if (gProfiler.writeChromeTrace(tracePath))
 			{
-				damageCooldown = false;
-				damageTimer = 35;
+				printf("已导出性能 trace: %s\n", tracePath);
 			}
 		}
 
-	}
-
-
-
-	virtual void draw()
-	{
-		//绘制Boss各种东西
-		DrawCircle((int)x, (int)y, BOSS_SIZE / 2, MAROON);
-		// 名称与血条
-		std::string hpText = name + " HP: " + std::to_string((int)hp);
-		DrawText(hpText.c_str(), (int)x - 40, (int)y - BOSS_SIZE / 2 - 20, 10, RAYWHITE);
-
-		// 血条
-		float barWidth = 80;
-		float hpRatio = (maxHp > 0) ? (hp / maxHp) : 0;
-		DrawRectangle((int)(x - barWidth / 2), (int)(y + BOSS_SIZE / 2 + 6), (int)barWidth, 6, DARKGRAY);
-		DrawRectangle((int)(x - barWidth / 2), (int)(y + BOSS_SIZE / 2 + 6), (int)(barWidth * hpRatio), 6, RED);
-	}
-
-	void drawAttacks()
-	{
-		for (auto& attack : attacks)
+		double now = GetTime();
+		double frameTime = now - previousTime;
+		previousTime = now;
+		if (frameTime > MAX_FRAME_TIME)
 		{
-			attack->draw();
+			frameTime = MAX_FRAME_TIME;
 		}
-	}
+		accumulator += frameTime;
 
-	bool checkHit(float playerX, float playerY, float playerSize)
-	{
-		for (auto& attack : attacks)
+		if (IsKeyPressed(KEY_SPACE))
 		{
-			if (attack->checkCollision(playerX, playerY, playerSize))
-			{
-				return true;
-			}
+			attackQueued = true;
 		}
-		return false;
-	}
 
-	// 提供访问攻击以便处理伤害
-	const std::vector<std::shared_ptr<Attack>>& getAttacks() const
-	{
-		return attacks;
-	}
-
-	void takeDamage(float damage)
-	{
-		if (!damageCooldown)
+		// 逻辑帧
 		{
-			hp -= damage;
-			damageCooldown = true;
-			if (hp < 0)
+			PROFILE_SCOPE(PROFILE_LOGIC);
+			while (accumulator >= LOGIC_DT)
 			{
-				hp = 0;
-			}
-		}
+				accumulator -= LOGIC_DT;
 
-	}
-
-	float getX() const
-	{
-		return x;
-	}
-	float getY() const
-	{
-		return y;
-	}
-	float getHp() const
-	{
-		return hp;
-	}
-	std::string getName() const
-	{
-		return name;
-	}
-
-	virtual void doAttack(float playerX, float playerY) = 0;
-	virtual int getAttackDelay() = 0;
-
-};
-
-class Boss01 : public Boss
-{
-private:
-	int attackPattern;
-	int aimedAttackCounter;  // 瞄准攻击计数器
-	bool isDoingAimedAttack; // 是否正在进行连续瞄准攻击
-	int chainAttackInterval; // 连续攻击的间隔
-
-public:
-	Boss01(float cx, float cy)
-		: Boss(cx, cy, 250.0f, "Boss01"), attackPattern(0),
-		aimedAttackCounter(0), isDoingAimedAttack(false), chainAttackInterval(0)
-	{
-		attackDelay = getAttackDelay() / 2;
-	}
-
-	// 计算与玩家的距离
-	float getDistanceToPlayer(float playerX, float playerY)
-	{
-		float dx = playerX - x;
-		float dy = playerY - y;
-		return sqrtf(dx * dx + dy * dy);
-	}
-
-	virtual void update(float playerX, float playerY, float playerHp) override
-	{
-		// 重写update方法，单独处理连续攻击的间隔逻辑
-		if (isDoingAimedAttack)
-		{
-			if (chainAttackInterval > 0)
-			{
-				chainAttackInterval--;
-			}
-			else
-			{
-				// 到达间隔时间，生成新攻击
-				doAimedAttack(playerX, playerY);
-			}
-		}
-		else
-		{
-			// 普通攻击间隔逻辑
-			if (attackDelay > 0)
-			{
-				attackDelay--;
-			}
-			if (attackDelay == 0)
-			{
-				doAttack(playerX, playerY);
-				attackDelay = getAttackDelay();
-			}
-		}
-
-		// 处理攻击更新
-		for (auto it = attacks.begin(); it != attacks.end();)
-		{
-			(*it)->update(playerX, playerY);
-
-			if ((*it)->getPhase() == COOLDOWN)
-			{
-				it = attacks.erase(it);
-			}
-			else
-			{
-				++it;
-			}
-		}
-
-		if (damageCooldown)
-		{
-			damageTimer--;
-			if (damageTimer <= 0)
-			{
-				damageCooldown = false;
-				damageTimer = 35;
-			}
-		}
-	}
-
-	// 单独的连续瞄准攻击生成函数
-	void doAimedAttack(float playerX, float playerY)
-	{
-		float r = 50.0f;
-		auto atk = std::make_shared<AimedCircleAttack>(playerX, playerY, r, 10.0f);
-		attacks.push_back(atk);
-
-		aimedAttackCounter++;
-
-		if (aimedAttackCounter >= 8)
-		{
-			// 结束连续攻击
-			isDoingAimedAttack = false;
-			aimedAttackCounter = 0;
-			attackDelay = getAttackDelay(); // 恢复普通攻击间隔
-		}
-		else
-		{
-			// 关键修改：将连续攻击间隔缩短到10帧
-			// 攻击生命周期40帧，间隔10帧，会同时存在4个重叠攻击
-			chainAttackInterval = 15;
-		}
-	}
-
-	virtual void doAttack(float playerX, float playerY) override
-	{
-		float distance = getDistanceToPlayer(playerX, playerY);
+				// 联机：只提交本地输入，等待对方时按键留到下一个逻辑帧
+				if (session)
+				{
+					PlayerInput input = readKeyboardInput();
+					if (attackQueued)
+					{
+						input |= INPUT_ATTACK;
+					}
+					if (session->advance(input))
+					{
+						attackQueued = false;
+					}
+					continue;
+				}
 
-		// 远距离：使用瞄准攻击
-		if (distance > 100.0f)
-		{
-			if (attackPattern % 3 == 0)  // 每3次攻击使用1次反弹子弹
-			{
-				// 反弹子弹逻辑保持不变...
-				float dx = playerX - x;
-				float dy = playerY - y;
-				float dist = sqrtf(dx * dx + dy * dy);
-				if (dist > 0)
+				if (fight.isOver())
 				{
-					dx /= dist;
-					dy /= dist;
+					continue;
 				}
 
-				for (int i = -1; i <= 1; i++)
+				PlayerInput input;
+				if (replayPath)
 				{
-					float angleOffset = i * 0.2f;
-					float dirX = dx * cosf(angleOffset) - dy * sinf(angleOffset);
-					float dirY = dx * sinf(angleOffset) + dy * cosf(angleOffset);
-					auto bullet = std::make_shared<BounceBulletAttack>(x, y, dirX, dirY, 3.5f, 8);
-					attacks.push_back(bullet);
+					input = replay.next();
 				}
-			}
-			else  // 开始连续瞄准攻击
-			{
-				isDoingAimedAttack = true;
-				aimedAttackCounter = 0;
-				chainAttackInterval = 0; // 立即生成第一个攻击
-			}
-		}
-		else  // 近距离攻击逻辑保持不变
-		{
-			if (attackPattern % 3 == 0)
-			{
-				float dx = playerX - x;
-				float dy = playerY - y;
-				float dist = sqrtf(dx * dx + dy * dy);
-				if (dist > 0)
+				else
 				{
-					dx /= dist;
-					dy /= dist;
+					input = readKeyboardInput();
+					if (attackQueued)
+					{
+						input |= INPUT_ATTACK;
+						attackQueued = false;
+					}
 				}
 
-				for (int i = -1; i <= 1; i++)
+				if (recordPath)
 				{
-					float angleOffset = i * 0.2f;
-					float dirX = dx * cosf(angleOffset) - dy * sinf(angleOffset);
-					float dirY = dx * sinf(angleOffset) + dy * cosf(angleOffset);
-					auto bullet = std::make_shared<BounceBulletAttack>(x, y, dirX, dirY, 3.5f, 8);
-					attacks.push_back(bullet);
+					recorder.record(input);
 				}
-			}
-			else
-			{
-				float r = 175.0f;
-				float dmg = 25.0f;
-				auto atk = std::make_shared<CircleAttack>(x, y, r, dmg);
-				attacks.push_back(atk);
+				inputs[0] = input;
+				for (int i = 1; i < playerCount; i++)
+				{
+					inputs[i] = bots[i - 1]->next(fight);
+				}
+				fight.tick(inputs.data());
 			}
 		}
 
-		attackPattern++;
-	}
-
-	virtual int getAttackDelay() override
-	{
-		return 180;  // 基础攻击间隔保持不变
-	}
-};
-
-//玩家类
-// 修改Player类的私有成员，添加攻击方向和位移相关变量
-class Player
-{
-private:
-	float x, y;
-	float hp, maxHp;
-	float speed;
-	bool isAttacking;
-	int attackTimer;
-	bool damageCooldown;
-	int damageTimer;
-	float attackDirX;  // 攻击方向X
-	float attackDirY;  // 攻击方向Y
-	bool attackDisplaced;  // 是否已经完成攻击位移
-
-public:
-	Player()
-		:x(100), y(100), hp(100), maxHp(100), speed(4), isAttacking(false),
-		attackTimer(0), damageCooldown(false), damageTimer(35),
-		attackDirX(0), attackDirY(0), attackDisplaced(false) {
-	}
-
-	void update()
-	{
-		// 记录攻击前的移动方向作为攻击方向
-		float moveDirX = 0, moveDirY = 0;
-		if (IsKeyDown(KEY_W)) moveDirY -= 1;
-		if (IsKeyDown(KEY_S)) moveDirY += 1;
-		if (IsKeyDown(KEY_A)) moveDirX -= 1;
-		if (IsKeyDown(KEY_D)) moveDirX += 1;
-
-		// 如果没有移动输入，默认向上为攻击方向
-		if (moveDirX == 0 && moveDirY == 0) {
-			moveDirY = -1;  // 默认向上
-		}
-		else {
-			// 标准化方向向量
-			float len = sqrtf(moveDirX * moveDirX + moveDirY * moveDirY);
-			moveDirX /= len;
-			moveDirY /= len;
-		}
+		// 两个逻辑帧之间的插值比例
+		float alpha = (float)(accumulator / LOGIC_DT);
 
-		// 攻击逻辑
-		if (IsKeyPressed(KEY_SPACE) && !isAttacking)
-		{
-			isAttacking = true;
-			attackTimer = 15;  // 攻击持续时间缩短为15帧
-			attackDirX = moveDirX;
-			attackDirY = moveDirY;
-			attackDisplaced = false;  // 重置位移标记
-		}
+		// 渲染
+		BeginDrawing();
+		ClearBackground(RAYWHITE);
 
-		// 攻击过程处理
-		if (isAttacking)
+		if (session)
 		{
-			// 攻击开始时执行一次位移
-			if (!attackDisplaced) {
-				x += attackDirX * 15;  // 向前位移15像素
-				y += attackDirY * 15;
-				attackDisplaced = true;
-			}
-
-			attackTimer--;
-			if (attackTimer <= 0)
-			{
-				isAttacking = false;
-			}
+			session->draw(alpha);
 		}
-		// 非攻击状态下的移动
 		else
 		{
-			if (IsKeyDown(KEY_W)) y -= speed;
-			if (IsKeyDown(KEY_S)) y += speed;
-			if (IsKeyDown(KEY_A)) x -= speed;
-			if (IsKeyDown(KEY_D)) x += speed;
+			fight.draw(alpha);
 		}
-
-		// 边界检测
-		x = std::max((float)PLAYER_SIZE, std::min((float)SCREEN_WIDTH - PLAYER_SIZE, x));
-		y = std::max((float)PLAYER_SIZE, std::min((float)SCREEN_HEIGHT - PLAYER_SIZE, y));
-
-		if (damageCooldown)
+		if (gProfiler.isEnabled())
 		{
-			damageTimer--;
-			if (damageTimer <= 0)
-			{
-				damageCooldown = false;
-				damageTimer = 35;
-			}
+			gProfiler.drawOverlay(SCREEN_WIDTH - PROFILE_HISTORY - 30, 10);
 		}
-	}
 
-	void draw()
-	{
-		// 绘制玩家主体
-		Color playerColor = damageCooldown ? RED : BLUE;
-		DrawCircle((int)x, (int)y, PLAYER_SIZE / 2, playerColor);
+		EndDrawing();
 
-		// 绘制半圆形攻击范围
-		if (isAttacking)
+		if (gProfiler.isEnabled())
 		{
-			const int segments = 20;  // 半圆的线段数量
-			const float radius = PLAYER_SIZE / 2 + 25;  // 攻击范围半径
-			const float startAngle = atan2f(attackDirY, attackDirX) - M_PI / 2;  // 半圆起始角度
-			const float endAngle = startAngle + M_PI;  // 半圆结束角度（180度）
-
-			// 绘制半圆弧线
-			for (int i = 0; i < segments; i++)
-			{
-				float angle1 = startAngle + (endAngle - startAngle) * i / segments;
-				float angle2 = startAngle + (endAngle - startAngle) * (i + 1) / segments;
-
-				Vector2 p1 = {
-					x + cosf(angle1) * radius,
-					y + sinf(angle1) * radius
-				};
-				Vector2 p2 = {
-					x + cosf(angle2) * radius,
-					y + sinf(angle2) * radius
-				};
-				DrawLineV(p1, p2, GREEN);
-			}
-
-			// 绘制连接玩家到半圆两端的线段（形成扇形）
-			Vector2 end1 = {
-				x + cosf(startAngle) * radius,
-				y + sinf(startAngle) * radius
-			};
-			Vector2 end2 = {
-				x + cosf(endAngle) * radius,
-				y + sinf(endAngle) * radius
-			};
-			DrawLineV({ x, y }, end1, GREEN);
-			DrawLineV({ x, y }, end2, GREEN);
+			gProfiler.record(PROFILE_FRAME, frameStartNs, Profiler::nowNs());
+			gProfiler.endFrame();
 		}
-
-		// 血条绘制
-		float barW = 80;
-		float hpR = (maxHp > 0) ? (hp / maxHp) : 0;
-		DrawRectangle((int)(x - barW / 2), (int)(y + PLAYER_SIZE / 2 + 6), (int)barW, 6, DARKGRAY);
-		DrawRectangle((int)(x - barW / 2), (int)(y + PLAYER_SIZE / 2 + 6), (int)(barW * hpR), 6, GREEN);
 	}
 
-	bool checkHit(float bossX, float bossY, float bossSize)
-	{
-		if (!isAttacking) return false;
-
-		// 计算Boss相对于玩家的位置
-		float dx = bossX - x;
-		float dy = bossY - y;
-		float dist = sqrtf(dx * dx + dy * dy);
-		float bossRadius = bossSize / 2;
-		float attackRadius = PLAYER_SIZE / 2 + 20;
-
-		// 距离检测
-		if (dist > attackRadius + bossRadius) return false;
-
-		// 角度检测（是否在半圆形攻击范围内）
-		float bossAngle = atan2f(dy, dx);
-		float attackStartAngle = atan2f(attackDirY, attackDirX) - M_PI / 2;
-		float attackEndAngle = attackStartAngle + M_PI;
-
-		// 处理角度环绕问题
-		if (attackStartAngle < 0) attackStartAngle += 2 * M_PI;
-		if (attackEndAngle < 0) attackEndAngle += 2 * M_PI;
-		if (bossAngle < 0) bossAngle += 2 * M_PI;
-
-		bool inAngleRange;
-		if (attackStartAngle <= attackEndAngle)
-		{
-			inAngleRange = (bossAngle >= attackStartAngle && bossAngle <= attackEndAngle);
-		}
-		else
-		{
-			inAngleRange = (bossAngle >= attackStartAngle || bossAngle <= attackEndAngle);
-		}
+	gAttackRenderer.unload();
+	CloseWindow();
 
-		return inAngleRange;
+	if (session)
+	{
+		printf("frames: %d  state hash: %016llx\n", session->getFrame(), (unsigned long long)session->getFight().stateHash());
 	}
-
-	// 其他原有方法保持不变...
-	void takeDamage(float damage)
+	if (recordPath || replayPath)
 	{
-		if (!damageCooldown)
-		{
-			hp -= damage;
-			damageCooldown = true;
-			if (hp < 0) hp = 0;
-		}
+		printf("frames: %d  state hash: %016llx\n", fight.getFrame(), (unsigned long long)fight.stateHash());
 	}
 
-	float getHp() const { return hp; }
-	float getX() const { return x; }
-	float getY() const { return y; }
-};
-
-int main()
-{
-	InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Demo - Boss & Player (raylib)");
-	SetTargetFPS(60);
-
-	Player player;
-	Boss01 boss(SCREEN_WIDTH / 2.0f, 120.0f);
-	GameState gameState = PLAYING;  // 初始化游戏状态为正在播放
-
-	// 把玩家放在屏幕中间偏下
-	player = Player();
-	// 使用局部时间控制（本示例仍使用帧计数器）
-
-	while (!WindowShouldClose())
+	if (recordPath && !recorder.save(recordPath, tuning, seed))
 	{
-		// 检查游戏是否应该结束
-		if (player.getHp() <= 0 || boss.getHp() <= 0)
-		{
-			gameState = GAME_OVER;
-		}
-
-		// 只有在游戏进行中才更新逻辑
-		if (gameState == PLAYING)
-		{
-			// 逻辑更新
-			player.update();
-			boss.update(player.getX(), player.getY(), player.getHp());
-
-			// Boss 的攻击命中检测：遍历每个攻击并应用伤害（若在 ACTIVE 且碰撞）
-			for (auto& atk : boss.getAttacks())
-			{
-				if (atk->checkCollision(player.getX(), player.getY(), PLAYER_SIZE))
-				{
-					player.takeDamage(atk->getDamage());
-					// 暂不立即移除攻击，攻击生命周期由 Attack 管理
-				}
-			}
-
-			// 玩家攻击命中 Boss
-			if (player.checkHit(boss.getX(), boss.getY(), BOSS_SIZE))
-			{
-				boss.takeDamage(15.0f);
-			}
-		}
-
-		// 渲染
-		BeginDrawing();
-		ClearBackground(RAYWHITE);
-
-		// 绘制场景
-		boss.draw();
-		boss.drawAttacks();
-		player.draw();
-
-		// HUD
-		DrawText(TextFormat("FPS: %d", GetFPS()), 10, 10, 12, DARKGRAY);
-		DrawText(TextFormat("Player HP: %d", (int)player.getHp()), 10, 30, 12, DARKGRAY);
-		DrawText(TextFormat("%s HP: %d", boss.getName().c_str(), (int)boss.getHp()), 10, 50, 12, DARKGRAY);
-
-		// 若任一死亡，显示结束信息
-		if (gameState == GAME_OVER)
-		{
-			if (player.getHp() <= 0)
-			{
-				DrawText("You Died", SCREEN_WIDTH / 2 - 60, SCREEN_HEIGHT / 2 - 10, 20, RED);
-			}
-			else if (boss.getHp() <= 0)
-			{
-				DrawText("Boss Defeated!", SCREEN_WIDTH / 2 - 90, SCREEN_HEIGHT / 2 - 10, 20, GREEN);
-			}
-			DrawText("Press ESC to exit", SCREEN_WIDTH / 2 - 80, SCREEN_HEIGHT / 2 + 30, 16, DARKGRAY);
-		}
-
-		EndDrawing();
+		printf("无法写入录像: %s\n", recordPath);
+		return 1;
 	}
 
-	
-	CloseWindow();
-
 	return 0;
-}
\ No newline at end of file
+}
+
+#endif
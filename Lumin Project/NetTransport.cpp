@@ -0,0 +1,189 @@
+﻿// NetTransport.cpp : UDP 传输层的平台相关部分（Windows 用 Winsock，其余平台用 BSD socket）
+//
+
+#define _CRT_SECURE_NO_WARNINGS
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+typedef SOCKET SocketHandle;
+typedef int SocketLength;
+static const SocketHandle INVALID_HANDLE = INVALID_SOCKET;
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int SocketHandle;
+typedef socklen_t SocketLength;
+static const SocketHandle INVALID_HANDLE = -1;
+#endif
+
+#include "NetTransport.h"
+
+namespace
+{
+	void closeSocket(SocketHandle s)
+	{
+#ifdef _WIN32
+		closesocket(s);
+#else
+		close(s);
+#endif
+	}
+
+	bool setNonBlocking(SocketHandle s)
+	{
+#ifdef _WIN32
+		u_long mode = 1;
+		return ioctlsocket(s, FIONBIO, &mode) == 0;
+#else
+		int flags = fcntl(s, F_GETFL, 0);
+		return flags >= 0 && fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+	}
+
+	//把 "主机:端口" 解析成 IPv4 地址
+	bool resolve(const std::string& text, sockaddr_in& out)
+	{
+		size_t colon = text.rfind(':');
+		if (colon == std::string::npos)
+		{
+			return false;
+		}
+		std::string host = text.substr(0, colon);
+		int port = atoi(text.c_str() + colon + 1);
+		if (port <= 0 || port > 65535)
+		{
+			return false;
+		}
+
+		addrinfo hints;
+		memset(&hints, 0, sizeof(hints));
+		hints.ai_family = AF_INET;
+		hints.ai_socktype = SOCK_DGRAM;
+		addrinfo* result = nullptr;
+		if (getaddrinfo(host.empty() ? "127.0.0.1" : host.c_str(), nullptr, &hints, &result) != 0 || !result)
+		{
+			return false;
+		}
+		memcpy(&out, result->ai_addr, sizeof(out));
+		out.sin_port = htons((unsigned short)port);
+		freeaddrinfo(result);
+		return true;
+	}
+}
+
+struct UdpTransport::Impl
+{
+	SocketHandle socket = INVALID_HANDLE;
+	std::vector<sockaddr_in> peers;
+	bool started = false;
+};
+
+UdpTransport::UdpTransport()
+	:impl(new Impl())
+{
+}
+
+UdpTransport::~UdpTransport()
+{
+	if (impl->socket != INVALID_HANDLE)
+	{
+		closeSocket(impl->socket);
+	}
+#ifdef _WIN32
+	if (impl->started)
+	{
+		WSACleanup();
+	}
+#endif
+}
+
+bool UdpTransport::open(int localPlayer, const std::vector<std::string>& addresses)
+{
+#ifdef _WIN32
+	WSADATA data;
+	if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+	{
+		return false;
+	}
+#endif
+	impl->started = true;
+
+	if (localPlayer < 0 || localPlayer >= (int)addresses.size())
+	{
+		return false;
+	}
+	impl->peers.resize(addresses.size());
+	for (size_t i = 0; i < addresses.size(); i++)
+	{
+		if (!resolve(addresses[i], impl->peers[i]))
+		{
+			printf("无法解析地址: %s\n", addresses[i].c_str());
+			return false;
+		}
+	}
+
+	impl->socket = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (impl->socket == INVALID_HANDLE || !setNonBlocking(impl->socket))
+	{
+		return false;
+	}
+	// 绑定所有网卡上自己的端口
+	sockaddr_in local;
+	memset(&local, 0, sizeof(local));
+	local.sin_family = AF_INET;
+	local.sin_addr.s_addr = htonl(INADDR_ANY);
+	local.sin_port = impl->peers[localPlayer].sin_port;
+	if (bind(impl->socket, (const sockaddr*)&local, sizeof(local)) != 0)
+	{
+		printf("无法绑定端口: %d\n", ntohs(local.sin_port));
+		return false;
+	}
+	return true;
+}
+
+void UdpTransport::send(int peer, const uint8_t* data, int size)
+{
+	if (impl->socket == INVALID_HANDLE || peer < 0 || peer >= (int)impl->peers.size())
+	{
+		return;
+	}
+	sendto(impl->socket, (const char*)data, size, 0, (const sockaddr*)&impl->peers[peer], sizeof(sockaddr_in));
+}
+
+int UdpTransport::receive(int& peer, uint8_t* buffer, int capacity)
+{
+	if (impl->socket == INVALID_HANDLE)
+	{
+		return 0;
+	}
+	for (;;)
+	{
+		sockaddr_in from;
+		SocketLength fromLength = sizeof(from);
+		int size = (int)recvfrom(impl->socket, (char*)buffer, capacity, 0, (sockaddr*)&from, &fromLength);
+		if (size <= 0)
+		{
+			// 没有数据（或 Windows 上对端未开时的 ICMP 错误），本次不再读
+			return 0;
+		}
+		for (size_t i = 0; i < impl->peers.size(); i++)
+		{
+			if (impl->peers[i].sin_port == from.sin_port && impl->peers[i].sin_addr.s_addr == from.sin_addr.s_addr)
+			{
+				peer = (int)i;
+				return size;
+			}
+		}
+	}
+}
@@ -0,0 +1,203 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Random.h"
+
+//联机传输层：只负责把一个数据包送到第几号玩家，不保证送达与顺序
+//对端统一用玩家编号表示，上层（RollbackSession）不关心地址
+class Transport
+{
+public:
+	virtual ~Transport() {}
+
+	//发给第 peer 号玩家
+	virtual void send(int peer, const uint8_t* data, int size) = 0;
+
+	//取一个收到的数据包，没有时返回 0；peer 为发送方编号
+	virtual int receive(int& peer, uint8_t* buffer, int capacity) = 0;
+};
+
+//UDP 传输：addresses 按玩家编号列出全部玩家的 "主机:端口"，自己那一项用于绑定端口
+//非阻塞收发，不认识的来源地址直接丢弃
+class UdpTransport : public Transport
+{
+private:
+	struct Impl;
+	std::unique_ptr<Impl> impl;
+
+public:
+	UdpTransport();
+	~UdpTransport();
+
+	//绑定并解析全部地址，失败返回 false
+	bool open(int localPlayer, const std::vector<std::string>& addresses);
+
+	void send(int peer, const uint8_t* data, int size) override;
+	int receive(int& peer, uint8_t* buffer, int capacity) override;
+};
+
+//把 "a:1,b:2" 拆成地址列表
+inline std::vector<std::string> splitAddressList(const char* list)
+{
+	std::vector<std::string> result;
+	std::string current;
+	for (const char* c = list; ; c++)
+	{
+		if (*c == ',' || *c == '\0')
+		{
+			if (!current.empty())
+			{
+				result.push_back(current);
+			}
+			current.clear();
+			if (*c == '\0')
+			{
+				break;
+			}
+		}
+		else
+		{
+			current += *c;
+		}
+	}
+	return result;
+}
+
+//进程内的模拟网络：所有玩家的传输层共用一份，数据包直接放进对方的收件箱
+class LoopbackNetwork
+{
+private:
+	struct Packet
+	{
+		int from;
+		std::vector<uint8_t> data;
+	};
+	std::vector<std::deque<Packet>> inboxes;
+
+public:
+	LoopbackNetwork(int playerCount)
+		:inboxes(playerCount) {
+	}
+
+	void post(int from, int to, const uint8_t* data, int size)
+	{
+		inboxes[to].push_back({ from, std::vector<uint8_t>(data, data + size) });
+	}
+
+	int take(int to, int& from, uint8_t* buffer, int capacity)
+	{
+		std::deque<Packet>& inbox = inboxes[to];
+		while (!inbox.empty())
+		{
+			Packet packet = std::move(inbox.front());
+			inbox.pop_front();
+			// 超长的包与 UDP 一样被截断丢弃
+			if ((int)packet.data.size() <= capacity)
+			{
+				from = packet.from;
+				memcpy(buffer, packet.data.data(), packet.data.size());
+				return (int)packet.data.size();
+			}
+		}
+		return 0;
+	}
+};
+
+class LoopbackTransport : public Transport
+{
+private:
+	LoopbackNetwork& network;
+	int localPlayer;
+
+public:
+	LoopbackTransport(LoopbackNetwork& net, int player)
+		:network(net), localPlayer(player) {
+	}
+
+	void send(int peer, const uint8_t* data, int size) override
+	{
+		network.post(localPlayer, peer, data, size);
+	}
+
+	int receive(int& peer, uint8_t* buffer, int capacity) override
+	{
+		return network.take(localPlayer, peer, buffer, capacity);
+	}
+};
+
+//模拟的网络状况
+struct NetConditions
+{
+	double latencyMs = 0.0;   // 单程延迟
+	double jitterMs = 0.0;    // 延迟在 [latency, latency + jitter] 间均匀分布，会造成乱序
+	float lossRate = 0.0f;    // 丢包率
+};
+
+//给任意传输层套上延迟、抖动与丢包，用于在一台机器上测试
+//时间由调用方提供（clockMs 指向的毫秒数），测试工具可以用虚拟时钟让结果可复现
+class ConditionedTransport : public Transport
+{
+private:
+	struct Pending
+	{
+		double deliverAt;
+		int peer;
+		std::vector<uint8_t> data;
+	};
+
+	Transport& inner;
+	NetConditions conditions;
+	RandomStream rng;
+	const double* clockMs;
+	std::vector<Pending> pending;
+
+public:
+	//rng 通常取 randomStream(RANDOM_NETWORK, 连接编号)
+	ConditionedTransport(Transport& t, const NetConditions& c, const RandomStream& r, const double* clock)
+		:inner(t), conditions(c), rng(r), clockMs(clock) {
+	}
+
+	void send(int peer, const uint8_t* data, int size) override
+	{
+		if (conditions.lossRate > 0.0f && rng.nextFloat() < conditions.lossRate)
+		{
+			return;
+		}
+		double delay = conditions.latencyMs + conditions.jitterMs * rng.nextFloat();
+		pending.push_back({ *clockMs + delay, peer, std::vector<uint8_t>(data, data + size) });
+	}
+
+	int receive(int& peer, uint8_t* buffer, int capacity) override
+	{
+		flush();
+		return inner.receive(peer, buffer, capacity);
+	}
+
+	//把到期的数据包交给内层传输层
+	void flush()
+	{
+		size_t kept = 0;
+		for (size_t i = 0; i < pending.size(); i++)
+		{
+			if (pending[i].deliverAt <= *clockMs)
+			{
+				inner.send(pending[i].peer, pending[i].data.data(), (int)pending[i].data.size());
+			}
+			else
+			{
+				if (kept != i)
+				{
+					pending[kept] = std::move(pending[i]);
+				}
+				kept++;
+			}
+		}
+		pending.resize(kept);
+	}
+};
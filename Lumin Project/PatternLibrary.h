@@ -0,0 +1,87 @@
+﻿#pragma once
+
+#include <cstring>
+#include <string>
+
+#include "Boss.h"
+
+//内置出招脚本库：--pattern 后面可以写库中的名称，也可以写脚本文件路径
+//除 boss01 外都是弹幕脚本，参数取自 Boss01Tuning，可以用 --bullet-speed 等照常调整
+struct PatternLibraryEntry
+{
+	const char* name;
+	const char* description;
+	const char* source;
+};
+
+inline const PatternLibraryEntry* patternLibrary(int* count)
+{
+	static const PatternLibraryEntry entries[] = {
+		{ "boss01", "Boss01 原有出招（默认）", BOSS01_DEFAULT_PATTERN },
+		{ "spiral", "六臂旋转弹幕",
+			"wait $attackDelay / 2\n"
+			"repeat\n"
+			"    ring 6 $bulletSpeed 3 $circleDamage / 5\n"
+			"    turn 0.12\n"
+			"    wait 3\n"
+			"end\n" },
+		{ "ring", "每 45 帧一圈 64 颗子弹，每圈错开半格",
+			"wait $attackDelay / 2\n"
+			"repeat\n"
+			"    ring 64 $bulletSpeed 2 $circleDamage / 5\n"
+			"    turn 0.049\n"
+			"    wait 45\n"
+			"end\n" },
+		{ "homing", "追踪子弹齐射，远处时夹带瞄准攻击",
+			"wait $attackDelay / 2\n"
+			"repeat\n"
+			"    homing 12 3 0.04 $aimedDamage\n"
+			"    turn 0.26\n"
+			"    wait 60\n"
+			"    if far $nearDistance\n"
+			"        jitter 40\n"
+			"        aim $aimedRadius $aimedDamage\n"
+			"    end\n"
+			"    wait 30\n"
+			"end\n" },
+		{ "stress", "压力测试：四个 Boss 同时使用时场上保持一万颗以上子弹（不造成伤害）",
+			"wait 1\n"
+			"repeat\n"
+			"    repeat 4\n"
+			"        ring 8 2.5 4 0\n"
+			"        turn 0.1\n"
+			"        wait 2\n"
+			"    end\n"
+			"    ring 64 2 4 0\n"
+			"    homing 8 3 0.03 0\n"
+			"end\n" },
+	};
+	*count = (int)(sizeof(entries) / sizeof(entries[0]));
+	return entries;
+}
+
+//按名称查找内置脚本，找不到返回空
+inline const char* findPatternSource(const char* name)
+{
+	int count;
+	const PatternLibraryEntry* entries = patternLibrary(&count);
+	for (int i = 0; i < count; i++)
+	{
+		if (strcmp(entries[i].name, name) == 0)
+		{
+			return entries[i].source;
+		}
+	}
+	return nullptr;
+}
+
+//按名称或文件路径载入 Boss01 脚本，失败时 error 给出原因
+inline bool loadBoss01Pattern(const char* nameOrPath, PatternProgram& out, std::string& error)
+{
+	const char* source = findPatternSource(nameOrPath);
+	if (source)
+	{
+		return compileBoss01Pattern(source, out, error);
+	}
+	return loadPatternFile(nameOrPath, boss01ParamNames(), BOSS01_PARAM_COUNT, out, error);
+}
@@ -0,0 +1,351 @@
+﻿// PatternScript.cpp : 出招脚本的编译（文本 -> 字节码）
+//
+
+#define _CRT_SECURE_NO_WARNINGS
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include "PatternScript.h"
+
+namespace
+{
+	//还没回填跳转地址的块
+	struct OpenBlock
+	{
+		enum Kind { REPEAT, IF, ELSE } kind;
+		size_t patchAt;       // 需要回填的两字节地址所在位置
+		size_t bodyStart;     // repeat：循环体开始位置
+		int line;
+		bool waitedBefore;    // 进入块之前是否一定执行过 wait
+		bool thenWaited;      // else：if 分支结束时是否一定执行过 wait
+		bool runsOnce;        // repeat：循环体至少执行一次（无限重复或常数次数不小于 1）
+	};
+
+	class PatternCompiler
+	{
+	private:
+		const char* const* paramNames;
+		int paramCount;
+		PatternProgram& program;
+		std::string& error;
+		std::vector<OpenBlock> blocks;
+		int line;
+		int loopDepth;
+		bool waited;          // 从所在 repeat 循环体开头到这里，是否每条路径都执行过 wait
+
+	public:
+		PatternCompiler(const char* const* names, int count, PatternProgram& out, std::string& err)
+			:paramNames(names), paramCount(count), program(out), error(err), line(0), loopDepth(0), waited(false) {
+		}
+
+		bool compile(const char* source)
+		{
+			program.code.clear();
+			program.operands.clear();
+			program.instructionDepth.clear();
+
+			std::istringstream input(source);
+			std::string text;
+			while (std::getline(input, text))
+			{
+				line++;
+				size_t hash = text.find('#');
+				if (hash != std::string::npos)
+				{
+					text.erase(hash);
+				}
+				std::vector<std::string> tokens;
+				std::istringstream words(text);
+				std::string word;
+				while (words >> word)
+				{
+					tokens.push_back(word);
+				}
+				if (!tokens.empty() && !compileLine(tokens))
+				{
+					return false;
+				}
+			}
+			if (!blocks.empty())
+			{
+				line = blocks.back().line;
+				return fail("这里开始的块缺少 end");
+			}
+			emitOp(PATTERN_HALT);
+			if (program.code.size() > 0xFFFF)
+			{
+				return fail("脚本太长");
+			}
+			return true;
+		}
+
+	private:
+		bool compileLine(const std::vector<std::string>& t)
+		{
+			size_t pos = 1;
+			const std::string& cmd = t[0];
+			if (cmd == "wait")
+			{
+				emitOp(PATTERN_WAIT);
+				if (!operands(t, pos, 1)) return false;
+				waited = true;
+			}
+			else if (cmd == "spawn" || cmd == "aim")
+			{
+				emitOp(cmd == "spawn" ? PATTERN_SPAWN : PATTERN_AIM);
+				if (!operands(t, pos, 2)) return false;
+			}
+			else if (cmd == "spread")
+			{
+				emitOp(PATTERN_SPREAD);
+				if (!operands(t, pos, 5)) return false;
+			}
+			else if (cmd == "jitter" || cmd == "turn")
+			{
+				emitOp(cmd == "jitter" ? PATTERN_JITTER : PATTERN_TURN);
+				if (!operands(t, pos, 1)) return false;
+			}
+			else if (cmd == "ring" || cmd == "homing")
+			{
+				emitOp(cmd == "ring" ? PATTERN_RING : PATTERN_HOMING);
+				if (!operands(t, pos, 4)) return false;
+			}
+			else if (cmd == "repeat")
+			{
+				if (loopDepth >= PATTERN_MAX_DEPTH)
+				{
+					return fail("repeat 嵌套太深");
+				}
+				emitOp(PATTERN_REPEAT);     // repeat 本身在外层
+				loopDepth++;
+				bool runsOnce = true;
+				if (pos == t.size())
+				{
+					emit(PATTERN_FOREVER);
+				}
+				else
+				{
+					if (!operands(t, pos, 1))
+					{
+						return false;
+					}
+					const PatternOperand& count = program.operands[program.code.back()];
+					runsOnce = count.param < 0 && count.op == 0 && count.base >= 1.0f;
+				}
+				blocks.push_back({ OpenBlock::REPEAT, program.code.size(), program.code.size() + 2, line, waited, false, runsOnce });
+				emitAddress(0);
+				waited = false;
+			}
+			else if (cmd == "if")
+			{
+				if (t.size() < 2 || (t[1] != "far" && t[1] != "near" && t[1] != "chance"))
+				{
+					return fail("if 后面应为 far、near 或 chance");
+				}
+				pos = 2;
+				emitOp(t[1] == "far" ? PATTERN_IF_FAR : (t[1] == "near" ? PATTERN_IF_NEAR : PATTERN_IF_CHANCE));
+				if (!operands(t, pos, 1)) return false;
+				blocks.push_back({ OpenBlock::IF, program.code.size(), 0, line, waited, false, false });
+				emitAddress(0);
+			}
+			else if (cmd == "else")
+			{
+				if (blocks.empty() || blocks.back().kind != OpenBlock::IF)
+				{
+					return fail("else 前面没有 if");
+				}
+				// if 成立的分支执行完跳过 else 分支；不成立时跳到 else 分支开头
+				emitOp(PATTERN_JUMP);
+				size_t jumpAt = program.code.size();
+				emitAddress(0);
+				patch(blocks.back().patchAt, program.code.size());
+				OpenBlock& b = blocks.back();
+				b = { OpenBlock::ELSE, jumpAt, 0, b.line, b.waitedBefore, waited, false };
+				waited = b.waitedBefore;
+			}
+			else if (cmd == "end")
+			{
+				if (blocks.empty())
+				{
+					return fail("多余的 end");
+				}
+				OpenBlock b = blocks.back();
+				blocks.pop_back();
+				if (b.kind == OpenBlock::REPEAT)
+				{
+					// 循环体回到开头之前一定要等待，否则一帧内会不停地重复执行（并不停地生成攻击）
+					if (!waited)
+					{
+						line = b.line;
+						return fail("repeat 的循环体中有不经过 wait 的路径");
+					}
+					emitOp(PATTERN_NEXT);
+					emitAddress(b.bodyStart);
+					loopDepth--;
+					// 无限重复之后的指令执行不到；其余情况只有循环体一定执行时才算等待过
+					waited = b.runsOnce || b.waitedBefore;
+				}
+				else if (b.kind == OpenBlock::ELSE)
+				{
+					waited = b.thenWaited && waited;
+				}
+				else
+				{
+					// 没有 else 的 if 可能整个跳过
+					waited = b.waitedBefore;
+				}
+				patch(b.patchAt, program.code.size());
+			}
+			else
+			{
+				return fail("未知指令 " + cmd);
+			}
+
+			if (pos != t.size())
+			{
+				return fail("多余的内容 " + t[pos]);
+			}
+			return true;
+		}
+
+		//读取 count 个数值
+		bool operands(const std::vector<std::string>& t, size_t& pos, int count)
+		{
+			for (int i = 0; i < count; i++)
+			{
+				PatternOperand o = { -1, 0.0f, 0, 0.0f };
+				if (pos >= t.size() || !term(t[pos], o.param, o.base))
+				{
+					return fail(pos >= t.size() ? std::string("缺少数值") : "无法识别的数值 " + t[pos]);
+				}
+				pos++;
+				if (pos + 1 < t.size() && t[pos].size() == 1 && strchr("+-*/~", t[pos][0]))
+				{
+					int rhsParam;
+					if (!term(t[pos + 1], rhsParam, o.rhs) || rhsParam >= 0)
+					{
+						return fail("运算符右边只能是常数");
+					}
+					o.op = t[pos][0];
+					if (o.op == '/' && o.rhs == 0.0f)
+					{
+						return fail("除数不能为 0");
+					}
+					pos += 2;
+				}
+				if (!emitOperand(o))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		//常数或 $参数名
+		bool term(const std::string& s, int& param, float& value)
+		{
+			param = -1;
+			value = 0.0f;
+			if (s.size() > 1 && s[0] == '$')
+			{
+				for (int i = 0; i < paramCount; i++)
+				{
+					if (s.compare(1, std::string::npos, paramNames[i]) == 0)
+					{
+						param = i;
+						return true;
+					}
+				}
+				return false;
+			}
+			char* end = nullptr;
+			value = strtof(s.c_str(), &end);
+			return end && *end == '\0' && end != s.c_str();
+		}
+
+		//相同的数值只存一份
+		bool emitOperand(const PatternOperand& o)
+		{
+			for (size_t i = 0; i < program.operands.size(); i++)
+			{
+				const PatternOperand& e = program.operands[i];
+				if (e.param == o.param && e.base == o.base && e.op == o.op && e.rhs == o.rhs)
+				{
+					emit((uint8_t)i);
+					return true;
+				}
+			}
+			if ((int)program.operands.size() >= PATTERN_MAX_OPERANDS)
+			{
+				return fail("不同的数值太多");
+			}
+			program.operands.push_back(o);
+			emit((uint8_t)(program.operands.size() - 1));
+			return true;
+		}
+
+		//操作码：同时记下指令开头与所在的 repeat 层数，快照恢复时据此校验进度
+		void emitOp(PatternOp o)
+		{
+			emit(o);
+			program.instructionDepth.back() = (uint8_t)(loopDepth + 1);
+		}
+
+		void emit(uint8_t b)
+		{
+			program.code.push_back(b);
+			program.instructionDepth.push_back(0);
+		}
+
+		void emitAddress(size_t address)
+		{
+			emit((uint8_t)address);
+			emit((uint8_t)(address >> 8));
+		}
+
+		void patch(size_t at, size_t address)
+		{
+			program.code[at] = (uint8_t)address;
+			program.code[at + 1] = (uint8_t)(address >> 8);
+		}
+
+		bool fail(const std::string& message)
+		{
+			error = "第 " + std::to_string(line) + " 行：" + message;
+			return false;
+		}
+	};
+}
+
+bool compilePattern(const char* source, const char* const* paramNames, int paramCount, PatternProgram& out, std::string& error)
+{
+	PatternCompiler compiler(paramNames, paramCount, out, error);
+	return compiler.compile(source);
+}
+
+bool loadPatternFile(const char* path, const char* const* paramNames, int paramCount, PatternProgram& out, std::string& error)
+{
+	FILE* f = fopen(path, "rb");
+	if (!f)
+	{
+		error = std::string("无法读取 ") + path;
+		return false;
+	}
+	std::string text;
+	char buffer[4096];
+	size_t n;
+	while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+	{
+		text.append(buffer, n);
+	}
+	fclose(f);
+
+	// 跳过 UTF-8 BOM
+	if (text.size() >= 3 && (unsigned char)text[0] == 0xEF && (unsigned char)text[1] == 0xBB && (unsigned char)text[2] == 0xBF)
+	{
+		text.erase(0, 3);
+	}
+	return compilePattern(text.c_str(), paramNames, paramCount, out, error);
+}
@@ -0,0 +1,371 @@
+﻿#pragma once
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "AttackPool.h"
+#include "Random.h"
+
+//出招脚本：一行一条指令，# 之后为注释，缩进随意
+//  wait N                    等 N 个逻辑帧再继续（至少 1 帧）
+//  spawn 半径 伤害            在自身位置放圆形攻击
+//  aim 半径 伤害              在目标位置放瞄准圆形攻击
+//  spread 数量 夹角 速度 反弹次数 伤害
+//                            朝目标方向发射扇形排列的反弹子弹，相邻两颗之间夹角为"夹角"（弧度）
+//  ring 数量 速度 反弹次数 伤害
+//                            从自身位置向四周均匀发射一圈反弹子弹，第一颗朝向当前发射角
+//  homing 数量 速度 转向 伤害  向四周均匀发射一圈追踪子弹，每帧最多转向"转向"弧度，碰墙即消失
+//  turn 弧度                 发射角增加该弧度（ring、homing 使用），每次 ring 之后 turn 即成旋转弹幕
+//  jitter 半径               之后的 aim、spread 把目标位置随机偏移到该半径内（0 为不偏移）
+//  repeat N ... end          重复 N 次；省略 N 时无限重复
+//  if far 距离 ... [else ...] end
+//  if near 距离 ... [else ...] end
+//                            按与目标的距离分支（far：大于该距离，near：不大于）
+//  if chance 概率 ... [else ...] end
+//                            按概率随机选择出招
+//数值可以是常数、$参数名，或两者之间的一次 + - * / ~ 运算（运算符两边要有空格），例如 $attackDelay / 2；除数不能为 0
+//  a ~ b 表示在 a 上加 [-b, b) 之间的随机数，例如 spread 5 $bulletSpread ~ 0.05 ...
+//随机数来自各 Boss 自己的随机数流，同一种子下结果可复现
+//参数名由使用脚本的 Boss 提供，取值在运行时读取，中途换参数后立即生效
+//脚本从战斗开始（第 0 帧）执行到第一个 wait，之后每帧推进一次
+//repeat 的循环体回到开头之前必须一定会执行到 wait（各个 if 分支都要有），否则编译失败
+//每帧最多生成 PATTERN_SPAWN_BUDGET 个攻击：spread、ring、homing 只发射剩余的数量，用完后强制等一帧
+
+//字节码：一个字节的操作码，后面跟一个字节的操作数下标（指向 PatternProgram::operands）或两个字节的跳转地址
+enum PatternOp : uint8_t
+{
+	PATTERN_WAIT,       // 操作数：帧数
+	PATTERN_SPAWN,      // 操作数：半径、伤害
+	PATTERN_AIM,        // 操作数：半径、伤害
+	PATTERN_SPREAD,     // 操作数：数量、夹角、速度、反弹次数、伤害
+	PATTERN_JITTER,     // 操作数：目标偏移半径
+	PATTERN_RING,       // 操作数：数量、速度、反弹次数、伤害
+	PATTERN_HOMING,     // 操作数：数量、速度、转向、伤害
+	PATTERN_TURN,       // 操作数：发射角增量
+	PATTERN_REPEAT,     // 操作数：次数（PATTERN_FOREVER 为无限）；地址：循环结束后的位置
+	PATTERN_NEXT,       // 地址：循环体开始位置
+	PATTERN_IF_FAR,     // 操作数：距离；地址：条件不成立时跳到的位置
+	PATTERN_IF_NEAR,
+	PATTERN_IF_CHANCE,  // 操作数：概率；地址同上
+	PATTERN_JUMP,       // 地址
+	PATTERN_HALT        // 脚本结束，之后不再出招
+};
+
+const uint8_t PATTERN_FOREVER = 0xFF;
+const int PATTERN_MAX_DEPTH = 4;                  // repeat 最多嵌套层数
+const int PATTERN_MAX_OPERANDS = 255;
+const int PATTERN_STEP_LIMIT = 1024;              // 每帧最多执行的指令数，防止没有 wait 的死循环卡住逻辑帧
+const int PATTERN_SPAWN_BUDGET = 1024;            // 每帧最多生成的攻击数，用完后强制等一帧，攻击数量不会无限增长
+
+//数值：参数或常数，可再与一个常数做一次运算
+struct PatternOperand
+{
+	int param;      // 参数下标，-1 表示用常数 base
+	float base;
+	char op;        // 0、'+'、'-'、'*'、'/'、'~'
+	float rhs;
+
+	float eval(const float* params, RandomStream& rng) const
+	{
+		float v = (param >= 0) ? params[param] : base;
+		switch (op)
+		{
+		case '+': return v + rhs;
+		case '-': return v - rhs;
+		case '*': return v * rhs;
+		case '/': return v / rhs;
+		case '~': return v + rng.nextRange(-rhs, rhs);
+		default: return v;
+		}
+	}
+};
+
+//编译好的脚本，只读，多个 Boss（以及多个线程）可以共用一份
+struct PatternProgram
+{
+	std::vector<uint8_t> code;
+	std::vector<PatternOperand> operands;
+	std::vector<uint8_t> instructionDepth;   // 与 code 等长：指令开头处为所在 repeat 层数 + 1，操作数与地址处为 0
+};
+
+//一层 repeat 的进度
+struct PatternLoop
+{
+	uint16_t start;      // 循环体开始位置
+	int32_t remaining;   // 剩余次数，-1 为无限
+};
+
+//每个 Boss 一份的执行状态，平凡可复制，直接放进快照
+struct PatternState
+{
+	int32_t wait;        // 还要等多少帧
+	uint16_t pc;
+	uint8_t depth;
+	uint8_t halted;
+	float jitter;        // 目标偏移半径
+	float angle;         // ring、homing 的发射角（弧度）
+	PatternLoop loops[PATTERN_MAX_DEPTH];
+};
+
+//脚本执行时能看到的外部状态
+struct PatternContext
+{
+	const float* params;
+	float selfX, selfY;
+	float targetX, targetY;
+	AttackPool* attacks;
+	RandomStream* rng;
+};
+
+//编译脚本，失败时返回 false 并在 error 中给出行号与原因
+bool compilePattern(const char* source, const char* const* paramNames, int paramCount, PatternProgram& out, std::string& error);
+
+//读取并编译脚本文件
+bool loadPatternFile(const char* path, const char* const* paramNames, int paramCount, PatternProgram& out, std::string& error);
+
+//数值转为整数（次数、帧数等）：NaN 当作 0，超出范围的截断，避免浮点转整数的未定义行为
+inline int patternInt(float v)
+{
+	if (!(v == v))
+	{
+		return 0;
+	}
+	return (int)std::max(-1.0e9f, std::min(1.0e9f, v));
+}
+
+//从快照恢复的进度是否能在这份脚本上安全执行：pc 须是指令开头且层数与所在位置相符，
+//每层循环的开头须紧跟在同一层的 repeat 指令之后，剩余次数与该 repeat 是否无限重复相符
+//快照可能来自外部文件，不合法的进度会让 runPattern 越界读取 code 与 operands
+//（有限次数的剩余次数只检查范围：次数可以来自参数，无法与脚本逐一对照）
+inline bool patternStateValid(const PatternProgram& program, const PatternState& s)
+{
+	const std::vector<uint8_t>& depthAt = program.instructionDepth;
+	if (s.depth > PATTERN_MAX_DEPTH || s.pc >= depthAt.size() || depthAt[s.pc] != s.depth + 1)
+	{
+		return false;
+	}
+	for (int i = 0; i < s.depth; i++)
+	{
+		const PatternLoop& loop = s.loops[i];
+		// 各层循环由外向内嵌套，当前位置在最内层的循环体中（同时保证 start 没有越界）
+		if (loop.start > s.pc || (i > 0 && loop.start <= s.loops[i - 1].start))
+		{
+			return false;
+		}
+		int repeatAt = (int)loop.start - 4;
+		if (repeatAt < 0 || depthAt[repeatAt] != i + 1 || program.code[repeatAt] != PATTERN_REPEAT)
+		{
+			return false;
+		}
+		bool forever = program.code[repeatAt + 1] == PATTERN_FOREVER;
+		if (forever ? loop.remaining != -1 : loop.remaining < 1)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+inline void resetPattern(PatternState& s)
+{
+	s = PatternState();
+}
+
+//推进一帧：等待结束后执行到下一个 wait，不申请内存
+inline void runPattern(const PatternProgram& program, PatternState& s, const PatternContext& ctx)
+{
+	if (s.halted || (s.wait > 0 && --s.wait > 0))
+	{
+		return;
+	}
+
+	const uint8_t* code = program.code.data();
+	const PatternOperand* operands = program.operands.data();
+	auto value = [&](int offset)
+	{
+		return operands[code[s.pc + offset]].eval(ctx.params, *ctx.rng);
+	};
+	// aim、spread 使用的目标位置，按 jitter 在圆内随机偏移
+	auto aimAt = [&](float* x, float* y)
+	{
+		*x = ctx.targetX;
+		*y = ctx.targetY;
+		if (s.jitter > 0.0f)
+		{
+			float r = s.jitter * sqrtf(ctx.rng->nextFloat());
+			float a = ctx.rng->nextFloat() * (float)(2.0 * M_PI);
+			*x += r * cosf(a);
+			*y += r * sinf(a);
+		}
+	};
+	auto address = [&](int offset)
+	{
+		return (uint16_t)(code[s.pc + offset] | (code[s.pc + offset + 1] << 8));
+	};
+
+	int budget = PATTERN_SPAWN_BUDGET;
+	for (int steps = 0; steps < PATTERN_STEP_LIMIT && budget > 0; steps++)
+	{
+		switch ((PatternOp)code[s.pc])
+		{
+		case PATTERN_WAIT:
+		{
+			int frames = patternInt(value(1));
+			s.wait = frames > 1 ? frames : 1;
+			s.pc += 2;
+			return;
+		}
+		// 带随机数的数值按操作数顺序逐个求值（函数实参的求值顺序随编译器而变，会让不同平台结果不同）
+		case PATTERN_SPAWN:
+		{
+			float radius = value(1);
+			float damage = value(2);
+			ctx.attacks->spawnCircle(ctx.selfX, ctx.selfY, radius, damage);
+			budget--;
+			s.pc += 3;
+			break;
+		}
+		case PATTERN_AIM:
+		{
+			float radius = value(1);
+			float damage = value(2);
+			float x, y;
+			aimAt(&x, &y);
+			ctx.attacks->spawnAimedCircle(x, y, radius, damage);
+			budget--;
+			s.pc += 3;
+			break;
+		}
+		case PATTERN_SPREAD:
+		{
+			int count = std::max(0, std::min(patternInt(value(1)), budget));
+			float angle = value(2);
+			float speed = value(3);
+			int bounces = patternInt(value(4));
+			float damage = value(5);
+			float tx, ty;
+			aimAt(&tx, &ty);
+			float dx = tx - ctx.selfX;
+			float dy = ty - ctx.selfY;
+			float dist = sqrtf(dx * dx + dy * dy);
+			if (dist > 0)
+			{
+				dx /= dist;
+				dy /= dist;
+			}
+			// 以目标方向为中心左右对称排开
+			for (int i = 0; i < count; i++)
+			{
+				float angleOffset = (i - (count - 1) * 0.5f) * angle;
+				float dirX = dx * cosf(angleOffset) - dy * sinf(angleOffset);
+				float dirY = dx * sinf(angleOffset) + dy * cosf(angleOffset);
+				ctx.attacks->spawnBounceBullet(ctx.selfX, ctx.selfY, dirX, dirY, speed, bounces, damage);
+			}
+			budget -= count;
+			s.pc += 6;
+			break;
+		}
+		case PATTERN_JITTER:
+			s.jitter = value(1);
+			s.pc += 2;
+			break;
+		case PATTERN_RING:
+		case PATTERN_HOMING:
+		{
+			int count = std::max(0, std::min(patternInt(value(1)), budget));
+			float speed = value(2);
+			float third = value(3);     // ring：反弹次数；homing：转向
+			float damage = value(4);
+			float step = count > 0 ? (float)(2.0 * M_PI) / count : 0.0f;
+			for (int i = 0; i < count; i++)
+			{
+				float a = s.angle + step * i;
+				float dirX = cosf(a), dirY = sinf(a);
+				if (code[s.pc] == PATTERN_RING)
+				{
+					ctx.attacks->spawnBounceBullet(ctx.selfX, ctx.selfY, dirX, dirY, speed, patternInt(third), damage);
+				}
+				else
+				{
+					ctx.attacks->spawnHomingBullet(ctx.selfX, ctx.selfY, dirX, dirY, speed, third, damage);
+				}
+			}
+			budget -= count;
+			s.pc += 5;
+			break;
+		}
+		case PATTERN_TURN:
+		{
+			// 保持在 [0, 2π) 内，长时间旋转也不损失精度；fmodf 的结果与被除数同号，反向旋转时要补一圈
+			const float fullTurn = (float)(2.0 * M_PI);
+			float angle = fmodf(s.angle + value(1), fullTurn);
+			if (angle < 0.0f)
+			{
+				// 很小的负数加一圈会舍入成正好 2π
+				angle += fullTurn;
+				angle = angle < fullTurn ? angle : 0.0f;
+			}
+			s.angle = angle;
+			s.pc += 2;
+			break;
+		}
+		case PATTERN_REPEAT:
+		{
+			bool forever = code[s.pc + 1] == PATTERN_FOREVER;
+			int times = forever ? -1 : patternInt(value(1));
+			if (!forever && times <= 0)
+			{
+				s.pc = address(2);
+				break;
+			}
+			PatternLoop& loop = s.loops[s.depth++];
+			loop.start = (uint16_t)(s.pc + 4);
+			loop.remaining = times;
+			s.pc += 4;
+			break;
+		}
+		case PATTERN_NEXT:
+		{
+			PatternLoop& loop = s.loops[s.depth - 1];
+			if (loop.remaining < 0 || --loop.remaining > 0)
+			{
+				s.pc = loop.start;
+			}
+			else
+			{
+				s.depth--;
+				s.pc += 3;
+			}
+			break;
+		}
+		case PATTERN_IF_FAR:
+		case PATTERN_IF_NEAR:
+		{
+			float dx = ctx.targetX - ctx.selfX;
+			float dy = ctx.targetY - ctx.selfY;
+			bool isFar = sqrtf(dx * dx + dy * dy) > value(1);
+			bool pass = (code[s.pc] == PATTERN_IF_FAR) ? isFar : !isFar;
+			s.pc = pass ? (uint16_t)(s.pc + 4) : address(2);
+			break;
+		}
+		case PATTERN_IF_CHANCE:
+		{
+			float chance = value(1);
+			s.pc = (ctx.rng->nextFloat() < chance) ? (uint16_t)(s.pc + 4) : address(2);
+			break;
+		}
+		case PATTERN_JUMP:
+			s.pc = address(1);
+			break;
+		default:
+			s.halted = 1;
+			return;
+		}
+	}
+	// 一帧内指令太多或生成的攻击太多，强制等一帧，下一帧从这里接着执行
+	s.wait = 1;
+}
@@ -0,0 +1,192 @@
+﻿#pragma once
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <algorithm>
+
+#ifndef LUMIN_HEADLESS
+#include "raylib.h"
+#endif
+#include "GameConfig.h"
+#include "PlayerInput.h"
+#include "TrigCache.h"
+#include "Ecs.h"
+#include "EcsSystems.h"
+
+//玩家近战攻击参数
+const int PLAYER_ATTACK_FRAMES = 15;                       // 攻击持续时间（帧）
+const float PLAYER_ATTACK_LUNGE = 15.0f;                   // 攻击开始时向前位移的距离
+const float PLAYER_ATTACK_RADIUS = PLAYER_SIZE / 2 + 20;   // 攻击判定半径
+const float PLAYER_ATTACK_DAMAGE = 15.0f;
+
+//玩家类：位置、生命值、无敌帧都放在 EcsWorld 的组件中，这里只保留输入控制逻辑
+//攻击时生成一个带 Lifetime 的近战攻击实体，存活期间即为攻击中
+class Player
+{
+private:
+	EcsWorld* world;
+	Entity entity;
+	Entity swing;      // 当前的近战攻击实体，没有攻击时已失效
+	float speed;
+
+public:
+	Player(EcsWorld* w, float startX = 100, float startY = 100)
+		:world(w), swing(NULL_ENTITY), speed(4)
+	{
+		entity = world->create(CHARACTER_COMPONENTS);
+		world->get<Transform>(entity) = { startX, startY, startX, startY };
+		world->get<Health>(entity) = { 100, 100 };
+		world->get<DamageCooldown>(entity) = { false, 35, 35 };
+		world->get<Hitbox>(entity) = { PLAYER_SIZE / 2.0f, 0.0f };
+	}
+
+	//拷贝整个战斗时，实体句柄不变，只需指向新的世界
+	void attach(EcsWorld* w)
+	{
+		world = w;
+	}
+
+	//每个逻辑帧调用一次，input 为本帧的按键位掩码
+	//上一帧位置与无敌帧倒计时由系统统一处理
+	void update(PlayerInput input)
+	{
+		Transform& t = world->get<Transform>(entity);
+
+		// 记录攻击前的移动方向作为攻击方向
+		float moveDirX = 0, moveDirY = 0;
+		if (input & INPUT_UP) moveDirY -= 1;
+		if (input & INPUT_DOWN) moveDirY += 1;
+		if (input & INPUT_LEFT) moveDirX -= 1;
+		if (input & INPUT_RIGHT) moveDirX += 1;
+
+		// 如果没有移动输入，默认向上为攻击方向
+		if (moveDirX == 0 && moveDirY == 0) {
+			moveDirY = -1;  // 默认向上
+		}
+		else {
+			// 标准化方向向量
+			float len = sqrtf(moveDirX * moveDirX + moveDirY * moveDirY);
+			moveDirX /= len;
+			moveDirY /= len;
+		}
+
+		bool startAttack = false;
+		if (isAttacking())
+		{
+			// 攻击过程中不能移动
+		}
+		else if (input & INPUT_ATTACK)
+		{
+			// 攻击开始时向攻击方向位移一次
+			t.x += moveDirX * PLAYER_ATTACK_LUNGE;
+			t.y += moveDirY * PLAYER_ATTACK_LUNGE;
+			startAttack = true;
+		}
+		// 非攻击状态下的移动
+		else
+		{
+			if (input & INPUT_UP) t.y -= speed;
+			if (input & INPUT_DOWN) t.y += speed;
+			if (input & INPUT_LEFT) t.x -= speed;
+			if (input & INPUT_RIGHT) t.x += speed;
+		}
+
+		// 边界检测
+		t.x = std::max((float)PLAYER_SIZE, std::min((float)SCREEN_WIDTH - PLAYER_SIZE, t.x));
+		t.y = std::max((float)PLAYER_SIZE, std::min((float)SCREEN_HEIGHT - PLAYER_SIZE, t.y));
+
+		if (startAttack)
+		{
+			// 攻击期间玩家不动，攻击实体固定在位移后的位置
+			float x = t.x, y = t.y;
+			swing = world->create(MELEE_ATTACK_COMPONENTS);
+			world->get<Transform>(swing) = { x, y, x, y };
+			world->get<Hitbox>(swing) = { PLAYER_ATTACK_RADIUS, PLAYER_ATTACK_DAMAGE };
+			world->get<AttackState>(swing) = { ACTIVE, 0, moveDirX, moveDirY };
+			world->get<Lifetime>(swing) = { PLAYER_ATTACK_FRAMES };
+		}
+	}
+
+#ifndef LUMIN_HEADLESS
+	//alpha 为当前渲染时刻在上一逻辑帧与本逻辑帧之间的插值比例
+	void draw(float alpha = 1.0f)
+	{
+		const Transform& t = world->get<Transform>(entity);
+		float drawX = t.prevX + (t.x - t.prevX) * alpha;
+		float drawY = t.prevY + (t.y - t.prevY) * alpha;
+
+		// 绘制玩家主体
+		Color playerColor = world->get<DamageCooldown>(entity).active ? RED : BLUE;
+		DrawCircle((int)drawX, (int)drawY, PLAYER_SIZE / 2, playerColor);
+
+		// 绘制半圆形攻击范围
+		if (isAttacking())
+		{
+			const float radius = PLAYER_SIZE / 2 + 25;  // 攻击范围半径
+			const AttackState& attack = world->get<AttackState>(swing);
+
+			// 攻击方向是单位向量，把预先算好的单位半圆旋转到攻击方向即可，不需要 atan2f/cosf/sinf
+			const UnitSemicircle& arc = UnitSemicircle::get();
+			Rotation dir = { attack.dirX, attack.dirY };
+			Vector2 points[ARC_SEGMENTS + 1];
+			for (int i = 0; i <= ARC_SEGMENTS; i++)
+			{
+				Rotation p = dir * arc.point[i];
+				points[i] = { drawX + p.c * radius, drawY + p.s * radius };
+			}
+
+			// 绘制半圆弧线
+			for (int i = 0; i < ARC_SEGMENTS; i++)
+			{
+				DrawLineV(points[i], points[i + 1], GREEN);
+			}
+
+			// 绘制连接玩家到半圆两端的线段（形成扇形）
+			DrawLineV({ drawX, drawY }, points[0], GREEN);
+			DrawLineV({ drawX, drawY }, points[ARC_SEGMENTS], GREEN);
+		}
+
+		// 血条绘制
+		float barW = 80;
+		const Health& health = world->get<Health>(entity);
+		float hpR = (health.maxHp > 0) ? (health.hp / health.maxHp) : 0;
+		DrawRectangle((int)(drawX - barW / 2), (int)(drawY + PLAYER_SIZE / 2 + 6), (int)barW, 6, DARKGRAY);
+		DrawRectangle((int)(drawX - barW / 2), (int)(drawY + PLAYER_SIZE / 2 + 6), (int)(barW * hpR), 6, GREEN);
+	}
+
+#endif
+
+	bool isAttacking() const
+	{
+		return world->isAlive(swing);
+	}
+
+	void save(SnapshotWriter& out) const
+	{
+		out.value(entity);
+		out.value(swing);
+		out.value(speed);
+	}
+
+	//句柄须指向世界中合适的实体（世界先于玩家恢复）：玩家本身须存活，近战攻击可以已失效
+	void load(SnapshotReader& in)
+	{
+		in.value(entity);
+		in.value(swing);
+		in.value(speed);
+		if (!world->hasAll(entity, CHARACTER_COMPONENTS) || (world->isAlive(swing) && !world->hasAll(swing, MELEE_ATTACK_COMPONENTS)))
+		{
+			in.ok = false;
+		}
+	}
+
+	void takeDamage(float damage)
+	{
+		applyDamage(*world, entity, damage);
+	}
+
+	Entity getEntity() const { return entity; }
+	float getHp() const { return world->get<Health>(entity).hp; }
+	float getX() const { return world->get<Transform>(entity).x; }
+	float getY() const { return world->get<Transform>(entity).y; }
+};
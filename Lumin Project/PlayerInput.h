@@ -0,0 +1,13 @@
+﻿#pragma once
+
+//玩家输入：每个逻辑帧一个按键位掩码，逻辑层不直接读取键盘
+enum InputBits
+{
+	INPUT_UP = 1 << 0,
+	INPUT_DOWN = 1 << 1,
+	INPUT_LEFT = 1 << 2,
+	INPUT_RIGHT = 1 << 3,
+	INPUT_ATTACK = 1 << 4    // 本逻辑帧触发攻击（按下沿）
+};
+
+typedef unsigned char PlayerInput;
@@ -0,0 +1,158 @@
+﻿// Profiler.cpp : 性能分析器的统计、trace 导出与叠加层绘制
+//
+
+#define _CRT_SECURE_NO_WARNINGS
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#ifndef LUMIN_HEADLESS
+#include "raylib.h"
+#endif
+#include "Profiler.h"
+
+Profiler gProfiler;
+
+Profiler::Profiler()
+	:enabled(false), originNs(0), historyHead(0), historyCount(0), traceHead(0), traceWrapped(false)
+{
+	memset(currentMs, 0, sizeof(currentMs));
+	memset(historyMs, 0, sizeof(historyMs));
+}
+
+void Profiler::setEnabled(bool on)
+{
+	// trace 缓冲区第一次打开时才分配，关闭时不占内存
+	if (on && trace.empty())
+	{
+		trace.resize(PROFILE_TRACE_CAPACITY);
+		originNs = nowNs();
+	}
+	enabled = on;
+	memset(currentMs, 0, sizeof(currentMs));
+}
+
+void Profiler::endFrame()
+{
+	if (!enabled)
+	{
+		return;
+	}
+	for (int z = 0; z < PROFILE_ZONE_COUNT; z++)
+	{
+		historyMs[z][historyHead] = (float)currentMs[z];
+		currentMs[z] = 0.0;
+	}
+	historyHead = (historyHead + 1) % PROFILE_HISTORY;
+	historyCount = std::min(historyCount + 1, PROFILE_HISTORY);
+}
+
+float Profiler::average(ProfileZone zone, int frames) const
+{
+	int n = std::min(frames, historyCount);
+	if (n == 0)
+	{
+		return 0.0f;
+	}
+	float sum = 0.0f;
+	for (int k = 1; k <= n; k++)
+	{
+		sum += historyMs[zone][(historyHead - k + PROFILE_HISTORY) % PROFILE_HISTORY];
+	}
+	return sum / n;
+}
+
+float Profiler::percentile(ProfileZone zone, float p) const
+{
+	if (historyCount == 0)
+	{
+		return 0.0f;
+	}
+	float sorted[PROFILE_HISTORY];
+	for (int k = 0; k < historyCount; k++)
+	{
+		sorted[k] = historyMs[zone][(historyHead - 1 - k + PROFILE_HISTORY) % PROFILE_HISTORY];
+	}
+	int i = (int)(p * (historyCount - 1) + 0.5f);
+	std::nth_element(sorted, sorted + i, sorted + historyCount);
+	return sorted[i];
+}
+
+const char* Profiler::zoneName(ProfileZone zone)
+{
+	switch (zone)
+	{
+	case PROFILE_FRAME: return "frame";
+	case PROFILE_LOGIC: return "logic";
+	case PROFILE_PLAYER_UPDATE: return "player.update";
+	case PROFILE_BOSS_UPDATE: return "boss.update";
+	case PROFILE_ATTACK_UPDATE: return "attacks.update";
+	case PROFILE_COLLISION: return "collision";
+	case PROFILE_DRAW_BOSS: return "boss.draw";
+	case PROFILE_DRAW_ATTACKS: return "drawAttacks";
+	case PROFILE_DRAW_PLAYER: return "player.draw";
+	case PROFILE_DRAW_HUD: return "hud";
+	default: return "?";
+	}
+}
+
+bool Profiler::writeChromeTrace(const char* path) const
+{
+	FILE* f = fopen(path, "w");
+	if (!f)
+	{
+		return false;
+	}
+
+	// 环形缓冲区按时间顺序输出：写满过时从 traceHead 开始
+	int count = traceWrapped ? PROFILE_TRACE_CAPACITY : traceHead;
+	int first = traceWrapped ? traceHead : 0;
+
+	fprintf(f, "{\"traceEvents\":[\n");
+	for (int k = 0; k < count; k++)
+	{
+		const ProfileEvent& e = trace[(first + k) % PROFILE_TRACE_CAPACITY];
+		fprintf(f, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+			zoneName((ProfileZone)e.zone), e.startNs / 1000.0, e.durationNs / 1000.0, k + 1 < count ? "," : "");
+	}
+	fprintf(f, "],\"displayTimeUnit\":\"ms\"}\n");
+	fclose(f);
+	return true;
+}
+
+#ifndef LUMIN_HEADLESS
+void Profiler::drawOverlay(int x, int y) const
+{
+	const int graphW = PROFILE_HISTORY;
+	const int graphH = 60;
+	const float graphMaxMs = 33.3f;   // 曲线上限：30 FPS
+	const int panelH = graphH + 40 + 12 * (PROFILE_ZONE_COUNT - 1);
+
+	DrawRectangle(x, y, graphW + 20, panelH, Fade(BLACK, 0.7f));
+
+	// 帧时间曲线，最新一帧在最右边
+	int gx = x + 10, gy = y + 10;
+	DrawRectangleLines(gx, gy, graphW, graphH, GRAY);
+	int budgetY = gy + graphH - (int)(graphH * (1000.0f / 60.0f) / graphMaxMs);
+	DrawLine(gx, budgetY, gx + graphW, budgetY, Fade(GREEN, 0.6f));
+	for (int k = 0; k < historyCount; k++)
+	{
+		float ms = historyMs[PROFILE_FRAME][(historyHead - 1 - k + PROFILE_HISTORY) % PROFILE_HISTORY];
+		int h = std::min(graphH, (int)(graphH * ms / graphMaxMs));
+		int px = gx + graphW - 1 - k;
+		DrawLine(px, gy + graphH, px, gy + graphH - h, ms > 1000.0f / 60.0f ? RED : SKYBLUE);
+	}
+
+	int ty = gy + graphH + 6;
+	DrawText(TextFormat("frame p50 %.2f ms  p99 %.2f ms", percentile(PROFILE_FRAME, 0.5f), percentile(PROFILE_FRAME, 0.99f)),
+		gx, ty, 10, RAYWHITE);
+	ty += 16;
+
+	// 各子系统最近 60 帧的平均耗时
+	for (int z = PROFILE_LOGIC; z < PROFILE_ZONE_COUNT; z++)
+	{
+		DrawText(TextFormat("%-16s %7.3f ms", zoneName((ProfileZone)z), average((ProfileZone)z, 60)), gx, ty, 10, LIGHTGRAY);
+		ty += 12;
+	}
+}
+#endif
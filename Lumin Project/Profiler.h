@@ -0,0 +1,126 @@
+﻿#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+//性能分析：按子系统记录每帧耗时，可显示叠加层，也可导出 Chrome trace（chrome://tracing）
+//关闭时每个计时点只多一次判断，不读时钟
+//只在主线程使用；批量模拟的工作线程里分析器保持关闭
+
+enum ProfileZone
+{
+	PROFILE_FRAME,          // 整个渲染帧（含等待垂直同步）
+	PROFILE_LOGIC,          // 本帧所有逻辑帧
+	PROFILE_PLAYER_UPDATE,
+	PROFILE_BOSS_UPDATE,
+	PROFILE_ATTACK_UPDATE,  // 攻击更新与移除（包含在 Boss 更新内）
+	PROFILE_COLLISION,
+	PROFILE_DRAW_BOSS,
+	PROFILE_DRAW_ATTACKS,
+	PROFILE_DRAW_PLAYER,
+	PROFILE_DRAW_HUD,
+	PROFILE_ZONE_COUNT
+};
+
+const int PROFILE_HISTORY = 240;               // 保留最近多少帧
+const int PROFILE_TRACE_CAPACITY = 1 << 16;    // trace 环形缓冲区的事件数
+
+struct ProfileEvent
+{
+	int zone;
+	int64_t startNs;
+	int64_t durationNs;
+};
+
+class Profiler
+{
+private:
+	bool enabled;
+	int64_t originNs;
+	double currentMs[PROFILE_ZONE_COUNT];                 // 当前帧累计
+	float historyMs[PROFILE_ZONE_COUNT][PROFILE_HISTORY]; // 最近若干帧
+	int historyHead;
+	int historyCount;
+	std::vector<ProfileEvent> trace;
+	int traceHead;
+	bool traceWrapped;
+
+public:
+	Profiler();
+
+	static int64_t nowNs()
+	{
+		using namespace std::chrono;
+		return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+	}
+
+	bool isEnabled() const
+	{
+		return enabled;
+	}
+
+	void setEnabled(bool on);
+
+	//记录一段耗时
+	void record(ProfileZone zone, int64_t startNs, int64_t endNs)
+	{
+		currentMs[zone] += (endNs - startNs) / 1e6;
+
+		ProfileEvent& e = trace[traceHead];
+		e.zone = zone;
+		e.startNs = startNs - originNs;
+		e.durationNs = endNs - startNs;
+		if (++traceHead >= PROFILE_TRACE_CAPACITY)
+		{
+			traceHead = 0;
+			traceWrapped = true;
+		}
+	}
+
+	//一帧结束，把本帧累计写入历史
+	void endFrame();
+
+	//最近 frames 帧的平均耗时（毫秒）
+	float average(ProfileZone zone, int frames) const;
+
+	//最近所有帧的百分位耗时（毫秒），p 取 0~1
+	float percentile(ProfileZone zone, float p) const;
+
+	//导出 Chrome trace JSON，失败返回 false
+	bool writeChromeTrace(const char* path) const;
+
+	static const char* zoneName(ProfileZone zone);
+
+#ifndef LUMIN_HEADLESS
+	//绘制叠加层：帧时间曲线、p50/p99 与各子系统平均耗时
+	void drawOverlay(int x, int y) const;
+#endif
+};
+
+extern Profiler gProfiler;
+
+//作用域计时：构造时开始，析构时记录
+class ProfileScope
+{
+private:
+	ProfileZone zone;
+	int64_t startNs;
+
+public:
+	ProfileScope(ProfileZone z)
+		:zone(z), startNs(gProfiler.isEnabled() ? Profiler::nowNs() : -1) {
+	}
+
+	~ProfileScope()
+	{
+		if (startNs >= 0)
+		{
+			gProfiler.record(zone, startNs, Profiler::nowNs());
+		}
+	}
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(zone) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(zone)
@@ -0,0 +1,145 @@
+﻿#pragma once
+
+#include <cstdint>
+
+//计数器式随机数（Philox4x32-10）：第 n 个随机数只由（种子, 流编号, n）决定，与其他流、其他线程无关
+//同一个种子下不同用途、不同对象各用一条流，互不影响：给某个 Boss 加一次抽取不会改变其他 Boss 或玩家脚本的结果
+//状态平凡可复制，直接放进快照；每次生成四个 32 位数，平均每次抽取只需几纳秒
+
+//流编号的高 32 位为用途，低 32 位为对象编号（第几个 Boss、第几个玩家等）
+enum RandomPurpose : uint32_t
+{
+	RANDOM_BOSS = 1,        // Boss 出招（每个 Boss 一条）
+	RANDOM_INPUT = 2,       // 输入脚本（每个玩家一条）
+	RANDOM_NETWORK = 3,     // 模拟网络的延迟与丢包（每个连接一条）
+	RANDOM_FIGHT_SEED = 4   // 批量模拟中各场战斗的种子（按战斗序号随机访问）
+};
+
+inline uint64_t randomStream(RandomPurpose purpose, uint32_t index)
+{
+	return ((uint64_t)purpose << 32) | index;
+}
+
+class RandomStream
+{
+private:
+	uint32_t key[2];
+	uint32_t counter[4];     // [0..1] 块序号，[2..3] 流编号
+	uint32_t block[4];       // 当前块的输出
+	uint32_t used;           // 当前块已用掉的个数
+
+public:
+	RandomStream()
+	{
+		reset(0, 0);
+	}
+
+	RandomStream(uint64_t seed, uint64_t stream)
+	{
+		reset(seed, stream);
+	}
+
+	void reset(uint64_t seed, uint64_t stream)
+	{
+		key[0] = (uint32_t)seed;
+		key[1] = (uint32_t)(seed >> 32);
+		counter[0] = 0;
+		counter[1] = 0;
+		counter[2] = (uint32_t)stream;
+		counter[3] = (uint32_t)(stream >> 32);
+		used = 4;
+	}
+
+	uint32_t next32()
+	{
+		if (used == 4)
+		{
+			philox(counter, key, block);
+			if (++counter[0] == 0)
+			{
+				counter[1]++;
+			}
+			used = 0;
+		}
+		return block[used++];
+	}
+
+	uint64_t next()
+	{
+		uint64_t lo = next32();
+		return lo | ((uint64_t)next32() << 32);
+	}
+
+	//[0, 1) 之间的浮点数
+	float nextFloat()
+	{
+		return (next32() >> 8) / 16777216.0f;
+	}
+
+	//[lo, hi) 之间的浮点数
+	float nextRange(float lo, float hi)
+	{
+		return lo + (hi - lo) * nextFloat();
+	}
+
+	//[lo, hi] 之间的整数
+	int nextInt(int lo, int hi)
+	{
+		if (hi <= lo)
+		{
+			return lo;
+		}
+		// 乘法取高位代替取模，偏差可以忽略
+		return lo + (int)(((uint64_t)next32() * (uint64_t)(hi - lo + 1)) >> 32);
+	}
+
+	//随机访问：流中第 index 个 64 位随机数，不需要保存状态（用于按序号给各场战斗分配种子）
+	static uint64_t at(uint64_t seed, uint64_t stream, uint64_t index)
+	{
+		uint32_t k[2] = { (uint32_t)seed, (uint32_t)(seed >> 32) };
+		uint32_t c[4] = { (uint32_t)index, (uint32_t)(index >> 32), (uint32_t)stream, (uint32_t)(stream >> 32) };
+		uint32_t out[4];
+		philox(c, k, out);
+		return out[0] | ((uint64_t)out[1] << 32);
+	}
+
+	//Philox4x32 十轮，常数与 Random123 相同；手工展开，不依赖编译器是否展开循环
+	static void philox(const uint32_t* ctr, const uint32_t* k, uint32_t* out)
+	{
+		uint32_t c[4] = { ctr[0], ctr[1], ctr[2], ctr[3] };
+		uint32_t k0 = k[0], k1 = k[1];
+		philoxRound(c, k0, k1); bumpKey(k0, k1);
+		philoxRound(c, k0, k1); bumpKey(k0, k1);
+		philoxRound(c, k0, k1); bumpKey(k0, k1);
+		philoxRound(c, k0, k1); bumpKey(k0, k1);
+		philoxRound(c, k0, k1); bumpKey(k0, k1);
+		philoxRound(c, k0, k1); bumpKey(k0, k1);
+		philoxRound(c, k0, k1); bumpKey(k0, k1);
+		philoxRound(c, k0, k1); bumpKey(k0, k1);
+		philoxRound(c, k0, k1); bumpKey(k0, k1);
+		philoxRound(c, k0, k1);
+		out[0] = c[0];
+		out[1] = c[1];
+		out[2] = c[2];
+		out[3] = c[3];
+	}
+
+private:
+	static void philoxRound(uint32_t* c, uint32_t k0, uint32_t k1)
+	{
+		uint64_t p0 = (uint64_t)0xD2511F53u * c[0];
+		uint64_t p1 = (uint64_t)0xCD9E8D57u * c[2];
+		uint32_t n0 = (uint32_t)(p1 >> 32) ^ c[1] ^ k0;
+		uint32_t n2 = (uint32_t)(p0 >> 32) ^ c[3] ^ k1;
+		c[0] = n0;
+		c[1] = (uint32_t)p1;
+		c[2] = n2;
+		c[3] = (uint32_t)p0;
+	}
+
+	static void bumpKey(uint32_t& k0, uint32_t& k1)
+	{
+		k0 += 0x9E3779B9u;
+		k1 += 0xBB67AE85u;
+	}
+};
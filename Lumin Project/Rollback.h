@@ -0,0 +1,404 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+#include "PlayerInput.h"
+#include "Fight.h"
+#include "NetTransport.h"
+
+//联机配置：所有玩家必须使用相同的人数、Boss 数、参数与输入延迟
+struct RollbackConfig
+{
+	int playerCount = 2;
+	int bossCount = 1;
+	int localPlayer = 0;
+	int inputDelay = 2;        // 本地输入延后几帧生效，延迟越大回滚越少、手感越钝
+	Boss01Tuning tuning;
+	const PatternProgram* pattern = nullptr;   // Boss 出招脚本，为空时使用内置脚本
+	uint64_t seed = 0;                         // 战斗种子
+};
+
+//联机统计
+struct RollbackStats
+{
+	int rollbacks = 0;           // 发生回滚的次数
+	int resimulatedFrames = 0;   // 回滚后重新模拟的帧数
+	int stalls = 0;              // 因等待对方输入而没有推进的次数
+	int packetsSent = 0;
+	int packetsReceived = 0;
+	long long bytesSent = 0;
+	int hashChecks = 0;          // 与对方核对过的确认帧状态数
+	int desyncs = 0;             // 核对不一致的次数
+	long long snapshotNs = 0;
+	int snapshots = 0;
+	long long restoreNs = 0;
+	int restores = 0;
+};
+
+//数据包格式（小端）：
+//  "LN"   魔数
+//  u8     版本号
+//  u8     发送方玩家编号
+//  i32    ack：发送方已连续收到接收方第几帧之前的全部输入
+//  i32    本包第一帧输入的帧号
+//  u8     输入个数，之后每帧一个 u8 按键位掩码
+//  i32    最近一个确认帧的帧号（没有时为 -1）
+//  u64    该帧的状态哈希
+//每个包都带上对方还没确认收到的全部本地输入，丢包时下一个包自然补上，不需要重传机制
+struct InputPacket
+{
+	int sender;
+	int ack;
+	int firstFrame;
+	int count;
+	PlayerInput inputs[64];
+	int hashFrame;
+	uint64_t hash;
+
+	static const int MAX_INPUTS = 64;
+	static const int MAX_SIZE = 4 + 4 + 4 + 1 + MAX_INPUTS + 4 + 8;
+
+	int encode(uint8_t* out) const
+	{
+		int n = 0;
+		auto put32 = [&](uint32_t v)
+		{
+			for (int i = 0; i < 4; i++) out[n++] = (uint8_t)(v >> (8 * i));
+		};
+		out[n++] = 'L';
+		out[n++] = 'N';
+		out[n++] = 1;
+		out[n++] = (uint8_t)sender;
+		put32((uint32_t)ack);
+		put32((uint32_t)firstFrame);
+		out[n++] = (uint8_t)count;
+		for (int i = 0; i < count; i++) out[n++] = inputs[i];
+		put32((uint32_t)hashFrame);
+		put32((uint32_t)hash);
+		put32((uint32_t)(hash >> 32));
+		return n;
+	}
+
+	//格式不对时返回 false
+	bool decode(const uint8_t* in, int size)
+	{
+		int n = 0;
+		auto get32 = [&]()
+		{
+			uint32_t v = 0;
+			for (int i = 0; i < 4; i++) v |= (uint32_t)in[n++] << (8 * i);
+			return v;
+		};
+		if (size < 13 || in[0] != 'L' || in[1] != 'N' || in[2] != 1)
+		{
+			return false;
+		}
+		n = 3;
+		sender = in[n++];
+		ack = (int)get32();
+		firstFrame = (int)get32();
+		count = in[n++];
+		if (count > MAX_INPUTS || size != n + count + 12)
+		{
+			return false;
+		}
+		for (int i = 0; i < count; i++) inputs[i] = in[n++];
+		hashFrame = (int)get32();
+		hash = get32();
+		hash |= (uint64_t)get32() << 32;
+		return true;
+	}
+};
+
+//回滚联机：每帧只交换按键位掩码
+//还没收到的对方输入按"沿用上一帧的方向键、不按攻击"预测并先行模拟；
+//对方的真实输入到达后，若与预测不同，就恢复到那一帧的快照，用真实输入重新模拟到当前帧
+//预测最多领先确认帧 MAX_ROLLBACK 帧，超过就停下等待（退化为锁步）
+class RollbackSession
+{
+public:
+	static const int MAX_ROLLBACK = 8;
+	static const int SNAPSHOT_COUNT = MAX_ROLLBACK + 1;
+	static const int HISTORY = 128;     // 输入与哈希环形缓冲的帧数
+	static const int MAX_INPUT_DELAY = 16;
+
+private:
+	struct InputSlot
+	{
+		int frame;            // 该槽位存的是哪一帧，-1 表示空
+		PlayerInput input;
+	};
+	struct HashSlot
+	{
+		int frame;
+		uint64_t hash;
+	};
+
+	Transport& transport;
+	int playerCount;
+	int localPlayer;
+	int inputDelay;
+	Fight fight;
+	int frame;                             // 下一个要模拟的帧
+	int rollbackTo;                        // 需要从哪一帧重新模拟，INT_MAX 表示不需要
+	std::vector<InputSlot> known;          // [玩家 * HISTORY + 帧 % HISTORY] 已确认的输入
+	std::vector<PlayerInput> used;         // [帧 % HISTORY * 玩家数 + 玩家] 模拟时实际用的输入
+	std::vector<int> received;             // 每个玩家：这一帧之前的输入已全部确认
+	std::vector<int> peerAck;              // 每个对端：已确认收到本地第几帧之前的输入
+	std::vector<FightSnapshot> snapshots;  // [帧 % SNAPSHOT_COUNT] 执行该帧之前的状态
+	std::vector<HashSlot> frameHashes;     // [帧 % HISTORY] 执行该帧之前的状态哈希，确认后即为最终值
+	std::vector<HashSlot> confirmedHashes; // [帧 % HISTORY] 确认帧的状态哈希
+	int confirmedFrame;                    // 这一帧之前的全部输入都已确认且已按真实输入模拟
+	std::vector<PlayerInput> frameInputs;
+	RollbackStats stats;
+
+public:
+	RollbackSession(Transport& t, const RollbackConfig& config)
+		:transport(t), playerCount(std::max(1, config.playerCount)), localPlayer(config.localPlayer),
+		inputDelay(std::min(std::max(0, config.inputDelay), (int)MAX_INPUT_DELAY)),
+		fight(config.tuning, config.playerCount, config.bossCount, config.pattern, config.seed), frame(0), rollbackTo(INT_MAX),
+		known(playerCount * HISTORY, InputSlot{ -1, 0 }), used(playerCount * HISTORY, 0),
+		received(playerCount, 0), peerAck(playerCount, 0),
+		snapshots(SNAPSHOT_COUNT), frameHashes(HISTORY, HashSlot{ -1, 0 }),
+		confirmedHashes(HISTORY, HashSlot{ -1, 0 }), confirmedFrame(0), frameInputs(playerCount, 0)
+	{
+		// 输入延迟内的前几帧所有玩家都没有按键
+		for (int p = 0; p < playerCount; p++)
+		{
+			for (int f = 0; f < inputDelay; f++)
+			{
+				storeInput(p, f, 0);
+			}
+		}
+	}
+
+	//执行一个本地逻辑帧，local 为本地玩家这一帧的输入（延后 inputDelay 帧生效）
+	//等待对方输入而没有推进时返回 false，调用方应在下一帧重新提交输入
+	bool advance(PlayerInput local)
+	{
+		poll();
+		if (frame - confirmedFrame >= MAX_ROLLBACK)
+		{
+			stats.stalls++;
+			sendInputs();
+			return false;
+		}
+
+		storeInput(localPlayer, frame + inputDelay, local);
+		simulateFrame();
+		updateConfirmed();
+		sendInputs();
+		return true;
+	}
+
+	//只收发数据、不推进帧：本地已经跑完但对方还在追赶时使用
+	void idle()
+	{
+		poll();
+		sendInputs();
+	}
+
+	const Fight& getFight() const { return fight; }
+	int getFrame() const { return frame; }
+	int getConfirmedFrame() const { return confirmedFrame; }
+	int getLocalPlayer() const { return localPlayer; }
+	int getInputDelay() const { return inputDelay; }
+	const RollbackStats& getStats() const { return stats; }
+
+#ifndef LUMIN_HEADLESS
+	//绘制当前（可能是预测的）状态，并在右下角显示联机信息
+	void draw(float alpha)
+	{
+		fight.draw(alpha);
+		DrawText(TextFormat("P%d  frame %d  confirmed %d  rollbacks %d  stalls %d", localPlayer + 1, frame, confirmedFrame,
+			stats.rollbacks, stats.stalls), 10, SCREEN_HEIGHT - 20, 12, DARKGRAY);
+	}
+#endif
+
+	//该帧的确认状态哈希，还没有确认或已被覆盖时返回 false
+	bool getConfirmedHash(int f, uint64_t* hash) const
+	{
+		if (f < 0 || confirmedHashes[f % HISTORY].frame != f)
+		{
+			return false;
+		}
+		*hash = confirmedHashes[f % HISTORY].hash;
+		return true;
+	}
+
+private:
+	//收取所有数据包，需要时回滚并重新模拟到当前帧
+	void poll()
+	{
+		uint8_t buffer[InputPacket::MAX_SIZE];
+		int peer = -1;
+		int size;
+		while ((size = transport.receive(peer, buffer, sizeof(buffer))) > 0)
+		{
+			InputPacket packet;
+			if (peer < 0 || peer >= playerCount || peer == localPlayer || !packet.decode(buffer, size) || packet.sender != peer)
+			{
+				continue;
+			}
+			stats.packetsReceived++;
+			peerAck[peer] = std::max(peerAck[peer], packet.ack);
+			for (int i = 0; i < packet.count; i++)
+			{
+				storeInput(peer, packet.firstFrame + i, packet.inputs[i]);
+			}
+			uint64_t mine;
+			if (getConfirmedHash(packet.hashFrame, &mine))
+			{
+				stats.hashChecks++;
+				if (mine != packet.hash)
+				{
+					stats.desyncs++;
+				}
+			}
+		}
+
+		if (rollbackTo < frame)
+		{
+			int target = frame;
+			restoreSnapshot(rollbackTo);
+			while (frame < target)
+			{
+				simulateFrame();
+			}
+			stats.rollbacks++;
+			stats.resimulatedFrames += target - rollbackTo;
+		}
+		rollbackTo = INT_MAX;
+		updateConfirmed();
+	}
+
+	//记录玩家 p 在第 f 帧的真实输入；已经按预测模拟过且预测错了时标记回滚
+	void storeInput(int p, int f, PlayerInput input)
+	{
+		if (f < received[p] || f >= received[p] + HISTORY)
+		{
+			return;
+		}
+		InputSlot& slot = known[p * HISTORY + f % HISTORY];
+		if (slot.frame == f)
+		{
+			return;
+		}
+		slot.frame = f;
+		slot.input = input;
+		if (f < frame && used[(f % HISTORY) * playerCount + p] != input)
+		{
+			rollbackTo = std::min(rollbackTo, f);
+		}
+		while (known[p * HISTORY + received[p] % HISTORY].frame == received[p])
+		{
+			received[p]++;
+		}
+	}
+
+	//玩家 p 在第 f 帧的输入：已确认的用真实值，否则沿用最近确认的方向键，攻击键只在按下的那一帧有效所以不预测
+	PlayerInput inputFor(int p, int f) const
+	{
+		const InputSlot& slot = known[p * HISTORY + f % HISTORY];
+		if (slot.frame == f)
+		{
+			return slot.input;
+		}
+		int last = received[p] - 1;
+		if (last < 0)
+		{
+			return 0;
+		}
+		return known[p * HISTORY + last % HISTORY].input & ~INPUT_ATTACK;
+	}
+
+	void simulateFrame()
+	{
+		saveSnapshot(frame);
+		for (int p = 0; p < playerCount; p++)
+		{
+			frameInputs[p] = inputFor(p, frame);
+			used[(frame % HISTORY) * playerCount + p] = frameInputs[p];
+		}
+		fight.tick(frameInputs.data());
+		frame++;
+	}
+
+	void saveSnapshot(int f)
+	{
+		auto t0 = std::chrono::steady_clock::now();
+		fight.save(snapshots[f % SNAPSHOT_COUNT]);
+		stats.snapshotNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+		stats.snapshots++;
+		frameHashes[f % HISTORY] = { f, fight.stateHash() };
+	}
+
+	void restoreSnapshot(int f)
+	{
+		auto t0 = std::chrono::steady_clock::now();
+		fight.restore(snapshots[f % SNAPSHOT_COUNT]);
+		frame = f;
+		stats.restoreNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+		stats.restores++;
+	}
+
+	//推进确认帧，并记下新确认帧的状态哈希供双方核对
+	void updateConfirmed()
+	{
+		int c = frame;
+		for (int p = 0; p < playerCount; p++)
+		{
+			c = std::min(c, received[p]);
+		}
+		for (int f = confirmedFrame + 1; f <= c; f++)
+		{
+			if (f == frame)
+			{
+				confirmedHashes[f % HISTORY] = { f, fight.stateHash() };
+			}
+			else if (frameHashes[f % HISTORY].frame == f)
+			{
+				confirmedHashes[f % HISTORY] = frameHashes[f % HISTORY];
+			}
+		}
+		confirmedFrame = std::max(confirmedFrame, c);
+	}
+
+	//给每个对端发送它还没确认收到的本地输入
+	void sendInputs()
+	{
+		int last = received[localPlayer];
+		for (int peer = 0; peer < playerCount; peer++)
+		{
+			if (peer == localPlayer)
+			{
+				continue;
+			}
+			InputPacket packet;
+			packet.sender = localPlayer;
+			packet.ack = received[peer];
+			packet.firstFrame = std::max(peerAck[peer], last - InputPacket::MAX_INPUTS);
+			packet.count = std::max(0, last - packet.firstFrame);
+			for (int i = 0; i < packet.count; i++)
+			{
+				packet.inputs[i] = inputFor(localPlayer, packet.firstFrame + i);
+			}
+			packet.hashFrame = -1;
+			packet.hash = 0;
+			if (confirmedFrame > 0 && getConfirmedHash(confirmedFrame, &packet.hash))
+			{
+				packet.hashFrame = confirmedFrame;
+			}
+
+			uint8_t buffer[InputPacket::MAX_SIZE];
+			int size = packet.encode(buffer);
+			transport.send(peer, buffer, size);
+			stats.packetsSent++;
+			stats.bytesSent += size;
+		}
+	}
+};
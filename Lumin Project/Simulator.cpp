@@ -0,0 +1,171 @@
+﻿// Simulator.cpp : 多线程批量战斗模拟，用于 Boss 数值平衡
+//
+
+#define _CRT_SECURE_NO_WARNINGS
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <vector>
+
+#include "Simulator.h"
+#include "InputPolicy.h"
+
+uint64_t fightSeed(uint64_t baseSeed, int index)
+{
+	return RandomStream::at(baseSeed, randomStream(RANDOM_FIGHT_SEED, 0), (uint64_t)index);
+}
+
+FightResult runFight(const SimulationConfig& config, int index)
+{
+	// 战斗与输入脚本共用这一场的种子，两者各自的随机数流互不影响
+	uint64_t seed = fightSeed(config.seed, index);
+	Fight fight(config.tuning, 1, 1, config.pattern, seed);
+	std::unique_ptr<InputPolicy> policy = makeInputPolicy(config.policyName, seed);
+	while (!fight.isOver() && fight.getFrame() < config.maxFrames)
+	{
+		fight.tick(policy->next(fight));
+	}
+
+	FightResult r;
+	r.winner = fight.getWinner();
+	r.frames = fight.getFrame();
+	r.damageToPlayer = fight.getDamageTakenByPlayer();
+	r.damageToBoss = fight.getDamageDealtToBoss();
+	return r;
+}
+
+int runSimulation(const SimulationConfig& config, std::vector<FightResult>& results)
+{
+	int threadCount = config.threadCount;
+	if (threadCount <= 0)
+	{
+		threadCount = (int)std::thread::hardware_concurrency();
+		if (threadCount <= 0)
+		{
+			threadCount = 1;
+		}
+	}
+
+	results.assign(config.fightCount, FightResult());
+	int batch = std::max(1, config.batchSize);
+	int taskCount = (config.fightCount + batch - 1) / batch;
+
+	// 每个任务写入自己那一段结果，线程之间没有共享的可变状态
+	WorkStealingScheduler scheduler;
+	scheduler.run(taskCount, threadCount, [&](int task, int worker)
+	{
+		int first = task * batch;
+		int last = std::min(first + batch, config.fightCount);
+		for (int i = first; i < last; i++)
+		{
+			results[i] = runFight(config, i);
+		}
+	});
+	return threadCount;
+}
+
+namespace
+{
+	//已排序数组的百分位数
+	float percentile(const std::vector<float>& sorted, float p)
+	{
+		if (sorted.empty())
+		{
+			return 0.0f;
+		}
+		int i = (int)(p * (sorted.size() - 1) + 0.5f);
+		return sorted[i];
+	}
+
+	float mean(const std::vector<float>& v)
+	{
+		double sum = 0.0;
+		for (float x : v)
+		{
+			sum += x;
+		}
+		return v.empty() ? 0.0f : (float)(sum / v.size());
+	}
+
+	void printStats(const char* label, std::vector<float> values)
+	{
+		std::sort(values.begin(), values.end());
+		printf("%-22s n=%-7d mean=%8.1f  p10=%8.1f  p50=%8.1f  p90=%8.1f\n", label, (int)values.size(),
+			mean(values), percentile(values, 0.1f), percentile(values, 0.5f), percentile(values, 0.9f));
+	}
+
+	//分桶直方图，用字符条显示
+	void printHistogram(const char* label, const std::vector<float>& values, float maxValue, int buckets)
+	{
+		// 上限不大于 0（例如 --boss-hp 0）时无法分桶，全部计入一个桶
+		if (!(maxValue > 0.0f))
+		{
+			maxValue = 0.0f;
+			buckets = 1;
+		}
+		std::vector<int> counts(buckets, 0);
+		for (float v : values)
+		{
+			// 先在浮点上截断再转整数，超出范围或 NaN 时转换是未定义行为
+			float t = (buckets > 1) ? v / maxValue * buckets : 0.0f;
+			int b = !(t > 0.0f) ? 0 : (t >= buckets - 1 ? buckets - 1 : (int)t);
+			counts[b]++;
+		}
+		int peak = std::max(1, *std::max_element(counts.begin(), counts.end()));
+
+		printf("%s\n", label);
+		for (int b = 0; b < buckets; b++)
+		{
+			float lo = maxValue * b / buckets;
+			float hi = maxValue * (b + 1) / buckets;
+			int bar = counts[b] * 40 / peak;
+			printf("  [%6.0f, %6.0f%c %7d ", lo, hi, b == buckets - 1 ? ']' : ')', counts[b]);
+			for (int k = 0; k < bar; k++)
+			{
+				putchar('#');
+			}
+			putchar('\n');
+		}
+	}
+}
+
+void printSimulationReport(const SimulationConfig& config, const std::vector<FightResult>& results, int threadCount, double seconds)
+{
+	int playerWins = 0, bossWins = 0, timeouts = 0;
+	long long totalFrames = 0;
+	std::vector<float> timeToKill, timeToDeath, damageToPlayer, damageToBoss;
+
+	for (const FightResult& r : results)
+	{
+		totalFrames += r.frames;
+		damageToPlayer.push_back(r.damageToPlayer);
+		damageToBoss.push_back(r.damageToBoss);
+		if (r.winner == WINNER_PLAYER)
+		{
+			playerWins++;
+			timeToKill.push_back(r.frames / (float)LOGIC_TICK_RATE);
+		}
+		else if (r.winner == WINNER_BOSS)
+		{
+			bossWins++;
+			timeToDeath.push_back(r.frames / (float)LOGIC_TICK_RATE);
+		}
+		else
+		{
+			timeouts++;
+		}
+	}
+
+	int n = (int)results.size();
+	double rate = n > 0 ? 100.0 / n : 0.0;
+	printf("fights: %d  policy: %s  seed: %llu  threads: %d\n", n, config.policyName, (unsigned long long)config.seed, threadCount);
+	printf("wall time: %.3f s  (%.0f fights/s, %.0f frames/s)\n", seconds, n / std::max(seconds, 1e-9), totalFrames / std::max(seconds, 1e-9));
+	printf("player win: %.1f%%  boss win: %.1f%%  timeout: %.1f%%\n", playerWins * rate, bossWins * rate, timeouts * rate);
+	printStats("time to kill boss (s)", timeToKill);
+	printStats("time to death (s)", timeToDeath);
+	printStats("damage to player", damageToPlayer);
+	printStats("damage to boss", damageToBoss);
+	printHistogram("damage to player distribution:", damageToPlayer, 100.0f, 10);
+	printHistogram("damage to boss distribution:", damageToBoss, config.tuning.maxHp, 10);
+}
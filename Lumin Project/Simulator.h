@@ -0,0 +1,123 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Fight.h"
+
+//批量模拟配置
+struct SimulationConfig
+{
+	int fightCount = 1000;
+	int threadCount = 0;              // 0 表示使用全部核心
+	int batchSize = 8;                // 每个任务包含的战斗数
+	int maxFrames = LOGIC_TICK_RATE * 60 * 10;
+	uint64_t seed = 1;
+	const char* policyName = "sloppy";
+	Boss01Tuning tuning;
+	const PatternProgram* pattern = nullptr;   // Boss 出招脚本，为空时使用内置脚本，各线程共用
+};
+
+//单场战斗的结果
+struct FightResult
+{
+	FightWinner winner;
+	int frames;
+	float damageToPlayer;
+	float damageToBoss;
+};
+
+//工作窃取调度器：每个线程有自己的任务队列，从队尾取任务；
+//自己的队列空了就从其他线程的队头偷任务，战斗时长不一也能让所有核心保持忙碌
+class WorkStealingScheduler
+{
+private:
+	struct WorkerQueue
+	{
+		std::mutex mutex;
+		std::deque<int> tasks;
+	};
+	std::vector<std::unique_ptr<WorkerQueue>> queues;
+
+public:
+	//执行 taskCount 个任务，每个任务调用 fn(taskIndex, workerIndex)
+	template<typename Fn>
+	void run(int taskCount, int threadCount, Fn fn)
+	{
+		queues.clear();
+		for (int w = 0; w < threadCount; w++)
+		{
+			queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+		}
+		// 任务按轮流方式预先分配到各线程
+		for (int t = 0; t < taskCount; t++)
+		{
+			queues[t % threadCount]->tasks.push_back(t);
+		}
+
+		std::vector<std::thread> threads;
+		for (int w = 0; w < threadCount; w++)
+		{
+			threads.emplace_back([this, w, &fn]()
+			{
+				int task;
+				while (popLocal(w, task) || steal(w, task))
+				{
+					fn(task, w);
+				}
+			});
+		}
+		for (std::thread& t : threads)
+		{
+			t.join();
+		}
+	}
+
+private:
+	bool popLocal(int worker, int& task)
+	{
+		WorkerQueue& q = *queues[worker];
+		std::lock_guard<std::mutex> lock(q.mutex);
+		if (q.tasks.empty())
+		{
+			return false;
+		}
+		task = q.tasks.back();
+		q.tasks.pop_back();
+		return true;
+	}
+
+	//任务在开始前全部入队，运行中不再产生新任务，所以一圈都偷不到就可以退出
+	bool steal(int worker, int& task)
+	{
+		int n = (int)queues.size();
+		for (int k = 1; k < n; k++)
+		{
+			WorkerQueue& q = *queues[(worker + k) % n];
+			std::lock_guard<std::mutex> lock(q.mutex);
+			if (!q.tasks.empty())
+			{
+				task = q.tasks.front();
+				q.tasks.pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+};
+
+//第 index 场战斗的种子，由总种子派生，与线程数和执行顺序无关
+uint64_t fightSeed(uint64_t baseSeed, int index);
+
+//运行单场战斗
+FightResult runFight(const SimulationConfig& config, int index);
+
+//多线程运行全部战斗，results 按战斗编号存放；返回实际使用的线程数
+int runSimulation(const SimulationConfig& config, std::vector<FightResult>& results);
+
+//输出胜率、击杀时间与伤害分布
+void printSimulationReport(const SimulationConfig& config, const std::vector<FightResult>& results, int threadCount, double seconds);
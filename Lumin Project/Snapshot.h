@@ -0,0 +1,197 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+//状态快照：整场战斗按固定顺序写成一段连续的字节，恢复时按同样顺序读回
+//组件、攻击数组等都是平凡可复制的 SoA 数组，每条数组写一个长度再整段 memcpy，没有逐对象的序列化
+//字节按本机内存布局存放，只保证同一个程序内（或同一构建的两台机器之间）通用
+
+//一段快照数据，缓冲区反复使用：保存到同一个快照对象时不再申请内存
+class FightSnapshot
+{
+private:
+	std::vector<uint8_t> buffer;
+	size_t length;
+
+	friend class SnapshotWriter;
+
+public:
+	FightSnapshot()
+		:length(0) {
+	}
+
+	const uint8_t* data() const
+	{
+		return buffer.data();
+	}
+
+	size_t size() const
+	{
+		return length;
+	}
+
+	bool empty() const
+	{
+		return length == 0;
+	}
+
+	//从外部（文件等）载入快照字节，内容在恢复时校验
+	void assign(const uint8_t* bytes, size_t size)
+	{
+		buffer.assign(bytes, bytes + size);
+		length = size;
+	}
+
+	//快照字节的哈希（FNV-1a），用于快速比较两个快照是否相同
+	uint64_t hash() const
+	{
+		uint64_t h = 1469598103934665603ull;
+		for (size_t i = 0; i < length; i++)
+		{
+			h = (h ^ buffer[i]) * 1099511628211ull;
+		}
+		return h;
+	}
+};
+
+//按顺序写入快照
+class SnapshotWriter
+{
+private:
+	FightSnapshot& snapshot;
+	uint8_t* base;
+	size_t capacity;
+	size_t pos;
+
+public:
+	explicit SnapshotWriter(FightSnapshot& s)
+		:snapshot(s), base(s.buffer.data()), capacity(s.buffer.size()), pos(0) {
+	}
+
+	~SnapshotWriter()
+	{
+		snapshot.length = pos;
+	}
+
+	template<typename T>
+	void value(const T& v)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "快照只能直接写入平凡可复制的类型");
+		bytes(&v, sizeof(T));
+	}
+
+	//长度加内容
+	template<typename T>
+	void array(const std::vector<T>& v)
+	{
+		uint32_t n = (uint32_t)v.size();
+		value(n);
+		column(v);
+	}
+
+	//只写内容：SoA 中等长的各条数组共用前面写过的一个长度
+	template<typename T>
+	void column(const std::vector<T>& v)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "快照只能直接写入平凡可复制的类型");
+		if (!v.empty())
+		{
+			bytes(v.data(), v.size() * sizeof(T));
+		}
+	}
+
+private:
+	void bytes(const void* src, size_t size)
+	{
+		if (pos + size > capacity)
+		{
+			grow(size);
+		}
+		memcpy(base + pos, src, size);
+		pos += size;
+	}
+
+	void grow(size_t size)
+	{
+		std::vector<uint8_t>& buffer = snapshot.buffer;
+		buffer.resize(std::max(pos + size, buffer.size() * 2));
+		base = buffer.data();
+		capacity = buffer.size();
+	}
+};
+
+//按顺序读出快照，数据不够时 ok 变为 false，之后读到的都是零
+class SnapshotReader
+{
+private:
+	const uint8_t* cur;
+	const uint8_t* end;
+
+public:
+	bool ok;
+
+	explicit SnapshotReader(const FightSnapshot& s)
+		:cur(s.data()), end(s.data() + s.size()), ok(true) {
+	}
+
+	template<typename T>
+	void value(T& v)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "快照只能直接读出平凡可复制的类型");
+		if (!bytes(&v, sizeof(T)))
+		{
+			memset((void*)&v, 0, sizeof(T));
+		}
+	}
+
+	//读出长度与内容，返回长度
+	template<typename T>
+	uint32_t array(std::vector<T>& v)
+	{
+		uint32_t n = 0;
+		value(n);
+		column(v, n);
+		return (uint32_t)v.size();
+	}
+
+	//读出 n 个元素的内容，长度由调用方给出（与 SnapshotWriter::column 对应）
+	template<typename T>
+	void column(std::vector<T>& v, uint32_t n)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "快照只能直接读出平凡可复制的类型");
+		if (!ok || n > (size_t)(end - cur) / sizeof(T))
+		{
+			ok = false;
+			v.clear();
+			return;
+		}
+		// 缩小 vector 不会释放容量，恢复到同一场战斗时不申请内存
+		v.resize(n);
+		if (n > 0)
+		{
+			bytes(v.data(), n * sizeof(T));
+		}
+	}
+
+	bool finished() const
+	{
+		return cur == end;
+	}
+
+private:
+	bool bytes(void* dst, size_t size)
+	{
+		if (!ok || (size_t)(end - cur) < size)
+		{
+			ok = false;
+			return false;
+		}
+		memcpy(dst, cur, size);
+		cur += size;
+		return true;
+	}
+};
@@ -0,0 +1,81 @@
+﻿#pragma once
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+//旋转缓存：用 (cos, sin) 对代替角度保存朝向
+//旋转叠加是一次复数乘法，绘制时每个顶点只需几次乘加，不再逐顶点调用 cosf/sinf
+struct Rotation
+{
+	float c, s;
+
+	static Rotation fromAngle(float angle)
+	{
+		return { cosf(angle), sinf(angle) };
+	}
+
+	//叠加旋转（复数乘法）
+	Rotation operator*(const Rotation& o) const
+	{
+		return { c * o.c - s * o.s, c * o.s + s * o.c };
+	}
+
+	//反复相乘会累积舍入误差，用一步牛顿迭代把模长拉回 1
+	Rotation renormalized() const
+	{
+		float k = 1.5f - 0.5f * (c * c + s * s);
+		return { c * k, s * k };
+	}
+};
+
+//三角形子弹三个顶点相对朝向的偏角（0°、120°、240°），预先乘上本帧统一的偏转
+struct TriangleCorners
+{
+	Rotation corner[3];
+
+	TriangleCorners(Rotation offset = { 1.0f, 0.0f })
+	{
+		static const Rotation base[3] = {
+			{ 1.0f, 0.0f },
+			{ -0.5f, 0.866025404f },    // 120°
+			{ -0.5f, -0.866025404f }    // 240°
+		};
+		for (int k = 0; k < 3; k++)
+		{
+			corner[k] = offset * base[k];
+		}
+	}
+
+	//以 (x, y) 为中心、朝向 r、外接圆半径 size 的三角形顶点
+	void vertices(float x, float y, Rotation r, float size, float* vx, float* vy) const
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			Rotation v = r * corner[k];
+			vx[k] = x + v.c * size;
+			vy[k] = y + v.s * size;
+		}
+	}
+};
+
+//玩家攻击半圆：相对攻击方向 -90° 到 +90° 的单位圆顶点，只计算一次
+const int ARC_SEGMENTS = 20;   // 半圆的线段数量
+
+struct UnitSemicircle
+{
+	Rotation point[ARC_SEGMENTS + 1];
+
+	UnitSemicircle()
+	{
+		for (int k = 0; k <= ARC_SEGMENTS; k++)
+		{
+			point[k] = Rotation::fromAngle((float)(-M_PI / 2 + M_PI * k / ARC_SEGMENTS));
+		}
+	}
+
+	static const UnitSemicircle& get()
+	{
+		static const UnitSemicircle table;
+		return table;
+	}
+};
@@ -0,0 +1,125 @@
+﻿#include <string.h>
+#include "Animation.h"
+
+// 动作定义：精灵图、横向帧数、每帧秒数、是否循环、优先级、播完后的动作
+// 现有的精灵图都是单帧，换成横向排列的帧序列后只需修改帧数
+typedef struct AnimationDef
+{
+	SpriteId sprite;
+	int frameCount;
+	float frameTime;
+	bool loop;
+	int priority;
+	AnimAction next;
+} AnimationDef;
+
+static const AnimationDef animationDefs[ANIM_COUNT] = {
+	[ANIM_IDLE] = { SPRITE_IDLE, 1, 0.20f, true, 0, ANIM_IDLE },
+	[ANIM_WALK_UP] = { SPRITE_BACK, 1, 0.12f, true, 0, ANIM_WALK_UP },
+	[ANIM_WALK_DOWN] = { SPRITE_FORWARD, 1, 0.12f, true, 0, ANIM_WALK_DOWN },
+	[ANIM_RUN_LEFT] = { SPRITE_RUN_LEFT, 1, 0.10f, true, 0, ANIM_RUN_LEFT },
+	[ANIM_RUN_RIGHT] = { SPRITE_RUN_RIGHT, 1, 0.10f, true, 0, ANIM_RUN_RIGHT },
+	[ANIM_JUMP] = { SPRITE_JUMP, 1, 0.40f, false, 1, ANIM_IDLE },
+	[ANIM_ATTACK] = { SPRITE_ATTACK, 1, 0.30f, false, 1, ANIM_IDLE },
+	[ANIM_BLOCK] = { SPRITE_BLOCK, 1, 0.20f, true, 0, ANIM_BLOCK },
+	[ANIM_HURT] = { SPRITE_HURT, 1, 0.30f, false, 2, ANIM_IDLE },
+	[ANIM_DEATH] = { SPRITE_DEATH, 1, 0.50f, false, 3, ANIM_DEATH },
+};
+
+void LoadAnimationSet(AnimationSet* set, const SpriteAtlas* atlas)
+{
+	memset(set, 0, sizeof(*set));
+	set->atlas = atlas;
+	for (int a = 0; a < ANIM_COUNT; a++)
+	{
+		const AnimationDef* def = &animationDefs[a];
+		AnimationClip* clip = &set->clips[a];
+		clip->firstFrame = set->frameCount;
+		clip->frameTime = def->frameTime;
+		clip->loop = def->loop;
+		clip->priority = def->priority;
+		clip->next = def->next;
+
+		Rectangle src = atlas->rects[def->sprite];
+		float width = src.width / def->frameCount;
+		for (int f = 0; f < def->frameCount && set->frameCount < ANIMATION_MAX_FRAMES; f++)
+		{
+			AnimationFrame* frame = &set->frames[set->frameCount++];
+			frame->sprite = def->sprite;
+			frame->rect = (Rectangle){ src.x + width * f, src.y, width, src.height };
+		}
+		clip->frameCount = set->frameCount - clip->firstFrame;
+	}
+}
+
+void ResetAnimator(Animator* animator, AnimAction action)
+{
+	animator->action = (unsigned char)action;
+	animator->frame = 0;
+	animator->timer = 0.0f;
+}
+
+bool IsAnimationFinished(const Animator* animator, const AnimationSet* set)
+{
+	const AnimationClip* clip = &set->clips[animator->action];
+	return !clip->loop && animator->frame == clip->frameCount - 1 && animator->timer >= clip->frameTime;
+}
+
+bool PlayAnimation(Animator* animator, const AnimationSet* set, AnimAction action)
+{
+	if (animator->action == action)
+	{
+		return false;
+	}
+	const AnimationClip* current = &set->clips[animator->action];
+	if (!current->loop && set->clips[action].priority < current->priority)
+	{
+		return false;
+	}
+	ResetAnimator(animator, action);
+	return true;
+}
+
+void UpdateAnimators(Animator* animators, int count, const AnimationSet* set, float dt)
+{
+	for (int i = 0; i < count; i++)
+	{
+		Animator* animator = &animators[i];
+		const AnimationClip* clip = &set->clips[animator->action];
+		animator->timer += dt;
+		while (animator->timer >= clip->frameTime)
+		{
+			if (animator->frame + 1 < clip->frameCount)
+			{
+				animator->frame++;
+				animator->timer -= clip->frameTime;
+			}
+			else if (clip->loop)
+			{
+				animator->frame = 0;
+				animator->timer -= clip->frameTime;
+			}
+			else if (clip->next != animator->action)
+			{
+				// 单次动作播完，剩余时间计入下一个动作
+				float rest = animator->timer - clip->frameTime;
+				ResetAnimator(animator, clip->next);
+				animator->timer = rest;
+				clip = &set->clips[animator->action];
+			}
+			else
+			{
+				// 停在最后一帧
+				animator->timer = clip->frameTime;
+				break;
+			}
+		}
+	}
+}
+
+void DrawAnimator(const AnimationSet* set, const Animator* animator, Vector2 feet, Color tint)
+{
+	const AnimationFrame* frame = &set->frames[set->clips[animator->action].firstFrame + animator->frame];
+	Vector2 pos = { feet.x - frame->rect.width / 2, feet.y - frame->rect.height };
+	DrawTextureRec(set->atlas->textures[frame->sprite], frame->rect, pos, tint);
+}
@@ -0,0 +1,75 @@
+﻿#pragma once
+
+#include <stdbool.h>
+#include <raylib.h>
+#include "SpriteAtlas.h"
+
+#define ANIMATION_MAX_FRAMES 64
+
+// 角色动作
+typedef enum AnimAction
+{
+	ANIM_IDLE,
+	ANIM_WALK_UP,
+	ANIM_WALK_DOWN,
+	ANIM_RUN_LEFT,
+	ANIM_RUN_RIGHT,
+	ANIM_JUMP,
+	ANIM_ATTACK,
+	ANIM_BLOCK,
+	ANIM_HURT,
+	ANIM_DEATH,
+	ANIM_COUNT
+} AnimAction;
+
+// 一个动作的播放参数：帧连续存放在 AnimationSet::frames 中
+typedef struct AnimationClip
+{
+	int firstFrame;
+	int frameCount;
+	float frameTime;          // 每帧秒数
+	bool loop;
+	int priority;             // 单次动作（包括停在最后一帧的）只能被优先级不低于它的动作打断
+	AnimAction next;          // 单次动作播完后切换到的动作；等于自身时停在最后一帧
+} AnimationClip;
+
+typedef struct AnimationFrame
+{
+	SpriteId sprite;
+	Rectangle rect;           // 图集中的子矩形
+} AnimationFrame;
+
+// 所有角色共享的动画定义：只在加载时由图集计算一次
+typedef struct AnimationSet
+{
+	const SpriteAtlas* atlas;
+	AnimationClip clips[ANIM_COUNT];
+	AnimationFrame frames[ANIMATION_MAX_FRAMES];
+	int frameCount;
+} AnimationSet;
+
+// 每个角色只保存播放状态（8 字节），更新与绘制都不分配内存
+typedef struct Animator
+{
+	unsigned char action;     // AnimAction
+	unsigned char frame;      // 动作内的帧序号
+	float timer;              // 当前帧已播放的秒数
+} Animator;
+
+// 由图集计算每个动作的帧矩形；精灵图按横向等宽切成若干帧
+void LoadAnimationSet(AnimationSet* set, const SpriteAtlas* atlas);
+
+void ResetAnimator(Animator* animator, AnimAction action);
+
+// 请求切换动作：与当前动作相同或被更高优先级的单次动作挡住时返回 false
+// 停在最后一帧的动作（如死亡）会一直挡住低优先级动作，需要 ResetAnimator 才能恢复
+bool PlayAnimation(Animator* animator, const AnimationSet* set, AnimAction action);
+
+// 单次动作是否已经播完（循环动作总是返回 false）
+bool IsAnimationFinished(const Animator* animator, const AnimationSet* set);
+
+// 推进 count 个角色的动画
+void UpdateAnimators(Animator* animators, int count, const AnimationSet* set, float dt);
+
+// 以 feet 为当前帧底边中点绘制
+void DrawAnimator(const AnimationSet* set, const Animator* animator, Vector2 feet, Color tint);
@@ -0,0 +1,228 @@
+﻿#define _CRT_SECURE_NO_WARNINGS
+#include <string.h>
+#include "AsyncLoader.h"
+#include "CompressedTexture.h"
+
+// 取出最早请求的待解码槽位，没有时返回 -1（需持有锁）
+static int takeQueued(AsyncLoader* loader)
+{
+	int best = -1;
+	for (int i = 0; i < ASYNC_MAX_SLOTS; i++)
+	{
+		AsyncSlot* s = &loader->slots[i];
+		if (s->state == ASYNC_QUEUED && (best < 0 || s->ticket < loader->slots[best].ticket))
+		{
+			best = i;
+		}
+	}
+	return best;
+}
+
+static int workerMain(void* arg)
+{
+	AsyncLoader* loader = (AsyncLoader*)arg;
+	char path[ASYNC_MAX_PATH];
+
+	mtx_lock(&loader->lock);
+	while (!loader->stopping)
+	{
+		int slot = takeQueued(loader);
+		if (slot < 0)
+		{
+			cnd_wait(&loader->wake, &loader->lock);
+			continue;
+		}
+
+		AsyncSlot* s = &loader->slots[slot];
+		s->state = ASYNC_DECODING;
+		memcpy(path, s->path, sizeof(path));
+		mtx_unlock(&loader->lock);
+
+		// 解码不持有锁，主线程照常渲染；.ltex 只读文件不解码
+		Image image = LoadTextureImage(path);
+
+		mtx_lock(&loader->lock);
+		if (s->cancelled)
+		{
+			if (image.data != NULL)
+			{
+				UnloadImage(image);
+			}
+			s->cancelled = false;
+			s->state = ASYNC_EMPTY;
+		}
+		else if (image.data == NULL)
+		{
+			s->state = ASYNC_FAILED;
+		}
+		else
+		{
+			s->image = image;
+			s->state = ASYNC_DECODED;
+		}
+	}
+	mtx_unlock(&loader->lock);
+	return 0;
+}
+
+bool StartAsyncLoader(AsyncLoader* loader)
+{
+	memset(loader, 0, sizeof(*loader));
+	if (mtx_init(&loader->lock, mtx_plain) != thrd_success)
+	{
+		return false;
+	}
+	if (cnd_init(&loader->wake) != thrd_success)
+	{
+		mtx_destroy(&loader->lock);
+		return false;
+	}
+	if (thrd_create(&loader->worker, workerMain, loader) != thrd_success)
+	{
+		cnd_destroy(&loader->wake);
+		mtx_destroy(&loader->lock);
+		return false;
+	}
+	return true;
+}
+
+void StopAsyncLoader(AsyncLoader* loader)
+{
+	mtx_lock(&loader->lock);
+	loader->stopping = true;
+	cnd_signal(&loader->wake);
+	mtx_unlock(&loader->lock);
+	thrd_join(loader->worker, NULL);
+
+	for (int i = 0; i < ASYNC_MAX_SLOTS; i++)
+	{
+		AsyncSlot* s = &loader->slots[i];
+		if (s->state == ASYNC_DECODED)
+		{
+			UnloadImage(s->image);
+		}
+		else if (s->state == ASYNC_READY)
+		{
+			UnloadTexture(s->texture);
+		}
+		s->state = ASYNC_EMPTY;
+	}
+	cnd_destroy(&loader->wake);
+	mtx_destroy(&loader->lock);
+}
+
+int RequestTexture(AsyncLoader* loader, const char* path)
+{
+	if (strlen(path) >= ASYNC_MAX_PATH)
+	{
+		return -1;
+	}
+
+	mtx_lock(&loader->lock);
+	int freeSlot = -1;
+	for (int i = 0; i < ASYNC_MAX_SLOTS; i++)
+	{
+		AsyncSlot* s = &loader->slots[i];
+		if (s->state == ASYNC_EMPTY)
+		{
+			if (freeSlot < 0)
+			{
+				freeSlot = i;
+			}
+		}
+		else if (strcmp(s->path, path) == 0)
+		{
+			// 正在解码时被释放又被请求：取消丢弃
+			s->cancelled = false;
+			mtx_unlock(&loader->lock);
+			return i;
+		}
+	}
+
+	if (freeSlot >= 0)
+	{
+		AsyncSlot* s = &loader->slots[freeSlot];
+		strcpy(s->path, path);
+		s->state = ASYNC_QUEUED;
+		s->cancelled = false;
+		s->ticket = loader->nextTicket++;
+		cnd_signal(&loader->wake);
+	}
+	mtx_unlock(&loader->lock);
+	return freeSlot;
+}
+
+void ReleaseTexture(AsyncLoader* loader, int slot)
+{
+	if (slot < 0 || slot >= ASYNC_MAX_SLOTS)
+	{
+		return;
+	}
+
+	mtx_lock(&loader->lock);
+	AsyncSlot* s = &loader->slots[slot];
+	switch (s->state)
+	{
+	case ASYNC_DECODING:
+		s->cancelled = true;   // 由工作线程在解码完成后回收
+		break;
+	case ASYNC_DECODED:
+		UnloadImage(s->image);
+		s->state = ASYNC_EMPTY;
+		break;
+	case ASYNC_READY:
+		UnloadTexture(s->texture);
+		s->state = ASYNC_EMPTY;
+		break;
+	default:
+		s->state = ASYNC_EMPTY;
+		break;
+	}
+	mtx_unlock(&loader->lock);
+}
+
+void PumpAsyncLoader(AsyncLoader* loader, int maxUploads)
+{
+	for (int i = 0; i < ASYNC_MAX_SLOTS && maxUploads > 0; i++)
+	{
+		AsyncSlot* s = &loader->slots[i];
+
+		mtx_lock(&loader->lock);
+		bool decoded = (s->state == ASYNC_DECODED);
+		Image image = s->image;
+		mtx_unlock(&loader->lock);
+		if (!decoded)
+		{
+			continue;
+		}
+
+		// 只有主线程会把 DECODED 改成其他状态，上传时不需要持有锁
+		Texture2D texture = UploadTextureImage(image);
+		UnloadImage(image);
+
+		mtx_lock(&loader->lock);
+		s->texture = texture;
+		s->state = (texture.id != 0) ? ASYNC_READY : ASYNC_FAILED;
+		mtx_unlock(&loader->lock);
+		maxUploads--;
+	}
+}
+
+bool IsTextureReady(AsyncLoader* loader, int slot)
+{
+	if (slot < 0 || slot >= ASYNC_MAX_SLOTS)
+	{
+		return false;
+	}
+	mtx_lock(&loader->lock);
+	bool ready = (loader->slots[slot].state == ASYNC_READY);
+	mtx_unlock(&loader->lock);
+	return ready;
+}
+
+// READY 之后纹理只会被主线程修改，直接读取
+Texture2D GetLoadedTexture(AsyncLoader* loader, int slot)
+{
+	Texture2D none = { 0 };
+	return IsTextureReady(loader, slot) ? loader->slots[slot].texture : none;
+}
@@ -0,0 +1,55 @@
+﻿#pragma once
+
+#include <stdbool.h>
+#include <threads.h>
+#include <raylib.h>
+
+#define ASYNC_MAX_SLOTS 32
+#define ASYNC_MAX_PATH 260
+
+// 后台纹理加载：工作线程只负责把图片文件解码成 CPU 端的 Image（.ltex 直接读入），
+// 主线程（持有 OpenGL 上下文）每帧调用 PumpAsyncLoader 把解码好的图片上传为纹理
+typedef enum AsyncState
+{
+	ASYNC_EMPTY,      // 空闲槽位
+	ASYNC_QUEUED,     // 等待工作线程解码
+	ASYNC_DECODING,   // 正在解码
+	ASYNC_DECODED,    // 已解码，等待主线程上传
+	ASYNC_READY,      // 纹理可用
+	ASYNC_FAILED      // 文件不存在或解码失败
+} AsyncState;
+
+typedef struct AsyncSlot
+{
+	char path[ASYNC_MAX_PATH];
+	AsyncState state;
+	bool cancelled;            // 解码过程中被释放，解码完成后直接丢弃
+	unsigned int ticket;       // 请求顺序，先请求先解码
+	Image image;
+	Texture2D texture;
+} AsyncSlot;
+
+typedef struct AsyncLoader
+{
+	AsyncSlot slots[ASYNC_MAX_SLOTS];
+	unsigned int nextTicket;
+	bool stopping;
+	mtx_t lock;                // 保护 slots 的 state / cancelled / image
+	cnd_t wake;                // 有新请求或需要退出时通知工作线程
+	thrd_t worker;
+} AsyncLoader;
+
+bool StartAsyncLoader(AsyncLoader* loader);
+// 结束工作线程并释放所有图片与纹理，需在 CloseWindow 之前调用
+void StopAsyncLoader(AsyncLoader* loader);
+
+// 请求加载（重复请求同一路径返回同一槽位），返回槽位编号，槽位用尽返回 -1
+int RequestTexture(AsyncLoader* loader, const char* path);
+// 释放槽位：纹理与图片都会被回收，之后可重新请求
+void ReleaseTexture(AsyncLoader* loader, int slot);
+
+// 主线程每帧调用：最多上传 maxUploads 张已解码的图片，避免一帧里上传过多造成卡顿
+void PumpAsyncLoader(AsyncLoader* loader, int maxUploads);
+
+bool IsTextureReady(AsyncLoader* loader, int slot);
+Texture2D GetLoadedTexture(AsyncLoader* loader, int slot);
@@ -0,0 +1,332 @@
+﻿#define _CRT_SECURE_NO_WARNINGS
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "CollisionMask.h"
+
+#define LMASK_MAGIC "LMSK"
+#define LMASK_VERSION 1
+#define LMASK_HEADER_SIZE 16
+
+// 扫掠时走出一个方块后再前进的一小段距离，保证落进下一个方块
+#define MASK_STEP_EPSILON 1e-3f
+
+static void writeU32(unsigned char* p, uint32_t v)
+{
+	p[0] = (unsigned char)v;
+	p[1] = (unsigned char)(v >> 8);
+	p[2] = (unsigned char)(v >> 16);
+	p[3] = (unsigned char)(v >> 24);
+}
+
+static uint32_t readU32(const unsigned char* p)
+{
+	return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static bool allocMask(CollisionMask* mask, int width, int height)
+{
+	memset(mask, 0, sizeof(*mask));
+	mask->width = width;
+	mask->height = height;
+	mask->wordsPerRow = (width + 63) / 64;
+	mask->cellCols = (width + MASK_CELL_SIZE - 1) / MASK_CELL_SIZE;
+	mask->cellRows = (height + MASK_CELL_SIZE - 1) / MASK_CELL_SIZE;
+	mask->blockCols = (width + MASK_BLOCK_SIZE - 1) / MASK_BLOCK_SIZE;
+	mask->blockRows = (height + MASK_BLOCK_SIZE - 1) / MASK_BLOCK_SIZE;
+	mask->bits = (uint64_t*)calloc((size_t)mask->wordsPerRow * height, sizeof(uint64_t));
+	mask->cells = (unsigned char*)calloc((size_t)mask->cellCols * mask->cellRows, 1);
+	mask->blocks = (unsigned char*)calloc((size_t)mask->blockCols * mask->blockRows, 1);
+	if (mask->bits == NULL || mask->cells == NULL || mask->blocks == NULL)
+	{
+		UnloadCollisionMask(mask);
+		return false;
+	}
+	return true;
+}
+
+static void setBlocked(CollisionMask* mask, int x, int y)
+{
+	mask->bits[(size_t)y * mask->wordsPerRow + x / 64] |= (uint64_t)1 << (x % 64);
+}
+
+// 每行补齐的位算作不可通行，和地图外保持一致
+static void blockPadding(CollisionMask* mask)
+{
+	int used = mask->width % 64;
+	if (used == 0)
+	{
+		return;
+	}
+	uint64_t padding = ~(((uint64_t)1 << used) - 1);
+	for (int y = 0; y < mask->height; y++)
+	{
+		mask->bits[(size_t)y * mask->wordsPerRow + mask->wordsPerRow - 1] |= padding;
+	}
+}
+
+static MaskState combine(bool anyBlocked, bool allBlocked)
+{
+	return allBlocked ? MASK_FULL : (anyBlocked ? MASK_MIXED : MASK_EMPTY);
+}
+
+// 由位图计算两层粗网格；超出地图的部分算作不可通行
+static void buildLevels(CollisionMask* mask)
+{
+	for (int cy = 0; cy < mask->cellRows; cy++)
+	{
+		for (int cx = 0; cx < mask->cellCols; cx++)
+		{
+			// 一个格子的每一行正好是某个 64 位字中的 16 位
+			int word = cx * MASK_CELL_SIZE / 64;
+			int shift = cx * MASK_CELL_SIZE % 64;
+			bool anyBlocked = false, allBlocked = true;
+			for (int r = 0; r < MASK_CELL_SIZE; r++)
+			{
+				int y = cy * MASK_CELL_SIZE + r;
+				uint64_t row = (y < mask->height) ? (mask->bits[(size_t)y * mask->wordsPerRow + word] >> shift) & 0xFFFF : 0xFFFF;
+				anyBlocked |= (row != 0);
+				allBlocked &= (row == 0xFFFF);
+			}
+			mask->cells[cy * mask->cellCols + cx] = (unsigned char)combine(anyBlocked, allBlocked);
+		}
+	}
+
+	const int per = MASK_BLOCK_SIZE / MASK_CELL_SIZE;
+	for (int by = 0; by < mask->blockRows; by++)
+	{
+		for (int bx = 0; bx < mask->blockCols; bx++)
+		{
+			bool anyBlocked = false, allBlocked = true;
+			for (int cy = by * per; cy < (by + 1) * per; cy++)
+			{
+				for (int cx = bx * per; cx < (bx + 1) * per; cx++)
+				{
+					MaskState state = (cx < mask->cellCols && cy < mask->cellRows) ? (MaskState)mask->cells[cy * mask->cellCols + cx] : MASK_FULL;
+					anyBlocked |= (state != MASK_EMPTY);
+					allBlocked &= (state == MASK_FULL);
+				}
+			}
+			mask->blocks[by * mask->blockCols + bx] = (unsigned char)combine(anyBlocked, allBlocked);
+		}
+	}
+}
+
+bool BuildCollisionMask(CollisionMask* mask, const TileMap* map, const char* imagePath)
+{
+	int width = (int)GetTileMapWidth(map);
+	int height = (int)GetTileMapHeight(map);
+	if (width <= 0 || height <= 0 || !allocMask(mask, width, height))
+	{
+		return false;
+	}
+
+	for (int i = 0; i < map->objectCount; i++)
+	{
+		const MapObject* obj = &map->objects[i];
+		if (obj->type != MAP_OBJECT_COLLISION)
+		{
+			continue;
+		}
+		int x0 = (int)fmaxf(floorf(obj->rect.x), 0.0f);
+		int y0 = (int)fmaxf(floorf(obj->rect.y), 0.0f);
+		int x1 = (int)fminf(ceilf(obj->rect.x + obj->rect.width), (float)width);
+		int y1 = (int)fminf(ceilf(obj->rect.y + obj->rect.height), (float)height);
+		for (int y = y0; y < y1; y++)
+		{
+			for (int x = x0; x < x1; x++)
+			{
+				setBlocked(mask, x, y);
+			}
+		}
+	}
+
+	if (imagePath != NULL)
+	{
+		Image image = LoadImage(imagePath);
+		if (image.data == NULL)
+		{
+			printf(u8"无法读取遮罩图: %s\n", imagePath);
+			UnloadCollisionMask(mask);
+			return false;
+		}
+		ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+		const unsigned char* pixels = (const unsigned char*)image.data;
+		for (int y = 0; y < height; y++)
+		{
+			int sy = (int)((long long)y * image.height / height);
+			for (int x = 0; x < width; x++)
+			{
+				int sx = (int)((long long)x * image.width / width);
+				const unsigned char* c = pixels + 4 * ((size_t)sy * image.width + sx);
+				int luma = (c[0] * 299 + c[1] * 587 + c[2] * 114) / 1000;
+				if (luma < 128 || c[3] < 128)
+				{
+					setBlocked(mask, x, y);
+				}
+			}
+		}
+		UnloadImage(image);
+	}
+
+	blockPadding(mask);
+	buildLevels(mask);
+	return true;
+}
+
+bool SaveCollisionMask(const CollisionMask* mask, const char* path)
+{
+	size_t words = (size_t)mask->wordsPerRow * mask->height;
+	size_t size = LMASK_HEADER_SIZE + words * 8;
+	unsigned char* file = (unsigned char*)MemAlloc((unsigned int)size);
+	memcpy(file, LMASK_MAGIC, 4);
+	writeU32(file + 4, LMASK_VERSION);
+	writeU32(file + 8, (uint32_t)mask->width);
+	writeU32(file + 12, (uint32_t)mask->height);
+	for (size_t i = 0; i < words; i++)
+	{
+		writeU32(file + LMASK_HEADER_SIZE + i * 8, (uint32_t)mask->bits[i]);
+		writeU32(file + LMASK_HEADER_SIZE + i * 8 + 4, (uint32_t)(mask->bits[i] >> 32));
+	}
+
+	bool ok = SaveFileData(path, file, (int)size);
+	MemFree(file);
+	if (ok)
+	{
+		printf(u8"%s (%dx%d, %d KB)\n", path, mask->width, mask->height, (int)(size / 1024));
+	}
+	return ok;
+}
+
+bool LoadCollisionMask(CollisionMask* mask, const char* path)
+{
+	int size = 0;
+	unsigned char* file = LoadFileData(path, &size);
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	bool ok = size >= LMASK_HEADER_SIZE && memcmp(file, LMASK_MAGIC, 4) == 0 && readU32(file + 4) == LMASK_VERSION;
+	int width = ok ? (int)readU32(file + 8) : 0;
+	int height = ok ? (int)readU32(file + 12) : 0;
+	ok = ok && width > 0 && height > 0
+		&& (size_t)size >= LMASK_HEADER_SIZE + (size_t)((width + 63) / 64) * height * 8
+		&& allocMask(mask, width, height);
+	if (ok)
+	{
+		size_t words = (size_t)mask->wordsPerRow * height;
+		for (size_t i = 0; i < words; i++)
+		{
+			mask->bits[i] = readU32(file + LMASK_HEADER_SIZE + i * 8) | (uint64_t)readU32(file + LMASK_HEADER_SIZE + i * 8 + 4) << 32;
+		}
+		blockPadding(mask);
+		buildLevels(mask);
+	}
+	else
+	{
+		TraceLog(LOG_WARNING, "CollisionMask: failed to load %s", path);
+	}
+	UnloadFileData(file);
+	return ok;
+}
+
+void UnloadCollisionMask(CollisionMask* mask)
+{
+	free(mask->bits);
+	free(mask->cells);
+	free(mask->blocks);
+	memset(mask, 0, sizeof(*mask));
+}
+
+const char* GetCollisionMaskPath(const char* mapPath)
+{
+	static char path[512];
+	const char* dot = strrchr(mapPath, '.');
+	size_t stem = dot ? (size_t)(dot - mapPath) : strlen(mapPath);
+	if (stem + 7 > sizeof(path))
+	{
+		stem = sizeof(path) - 7;
+	}
+	memcpy(path, mapPath, stem);
+	strcpy(path + stem, ".lmask");
+	return path;
+}
+
+bool IsWalkable(const CollisionMask* mask, int x, int y)
+{
+	if (x < 0 || y < 0 || x >= mask->width || y >= mask->height)
+	{
+		return false;
+	}
+	return ((mask->bits[(size_t)y * mask->wordsPerRow + x / 64] >> (x % 64)) & 1) == 0;
+}
+
+// 沿单位方向 dir 从 p 走出方块 [x0, x0+size) x [y0, y0+size) 的距离
+static float exitDistance(Vector2 p, Vector2 dir, float x0, float y0, float size)
+{
+	float t = INFINITY;
+	if (dir.x > 0) t = fminf(t, (x0 + size - p.x) / dir.x);
+	else if (dir.x < 0) t = fminf(t, (x0 - p.x) / dir.x);
+	if (dir.y > 0) t = fminf(t, (y0 + size - p.y) / dir.y);
+	else if (dir.y < 0) t = fminf(t, (y0 - p.y) / dir.y);
+	return t;
+}
+
+bool CanMoveTo(const CollisionMask* mask, Vector2 from, Vector2 to)
+{
+	float dx = to.x - from.x, dy = to.y - from.y;
+	float length = sqrtf(dx * dx + dy * dy);
+	if (length == 0.0f)
+	{
+		return IsWalkable(mask, (int)floorf(from.x), (int)floorf(from.y));
+	}
+	Vector2 dir = { dx / length, dy / length };
+
+	// 从粗到细：落在全空方块里就直接跳到方块出口，全满立即失败，只有混合的 16 像素格子才逐像素检查
+	float t = 0.0f;
+	for (;;)
+	{
+		Vector2 p = { from.x + dir.x * t, from.y + dir.y * t };
+		int x = (int)floorf(p.x), y = (int)floorf(p.y);
+		if (x < 0 || y < 0 || x >= mask->width || y >= mask->height)
+		{
+			return false;
+		}
+
+		int size;
+		MaskState state = (MaskState)mask->blocks[(y / MASK_BLOCK_SIZE) * mask->blockCols + x / MASK_BLOCK_SIZE];
+		if (state == MASK_EMPTY)
+		{
+			size = MASK_BLOCK_SIZE;
+		}
+		else if (state == MASK_FULL)
+		{
+			return false;
+		}
+		else
+		{
+			state = (MaskState)mask->cells[(y / MASK_CELL_SIZE) * mask->cellCols + x / MASK_CELL_SIZE];
+			if (state == MASK_EMPTY)
+			{
+				size = MASK_CELL_SIZE;
+			}
+			else if (state == MASK_FULL || !IsWalkable(mask, x, y))
+			{
+				return false;
+			}
+			else
+			{
+				size = 1;
+			}
+		}
+
+		// 终点落在刚检查过的方块里时整条路径通过
+		t += exitDistance(p, dir, (float)(x / size * size), (float)(y / size * size), (float)size) + MASK_STEP_EPSILON;
+		if (t > length)
+		{
+			return true;
+		}
+	}
+}
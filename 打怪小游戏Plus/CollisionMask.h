@@ -0,0 +1,49 @@
+﻿#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <raylib.h>
+#include "TileMap.h"
+
+#define MASK_CELL_SIZE 16         // 第一层粗网格边长（像素），正好是 64 位字的 1/4
+#define MASK_BLOCK_SIZE 128       // 第二层粗网格边长（像素），8x8 个第一层格子
+
+// 粗网格中一格的状态
+typedef enum MaskState
+{
+	MASK_EMPTY,     // 全部可通行
+	MASK_MIXED,     // 需要看下一层
+	MASK_FULL       // 全部不可通行
+} MaskState;
+
+// 地图的可通行位图：每像素 1 位，1 表示不可通行，每行补齐到 64 位
+// 两层粗网格记录 16/128 像素方块是否全空或全满，扫掠检测可以整块跳过
+typedef struct CollisionMask
+{
+	int width, height;
+	int wordsPerRow;
+	uint64_t* bits;
+	int cellCols, cellRows;
+	unsigned char* cells;         // MaskState，MASK_CELL_SIZE 方块
+	int blockCols, blockRows;
+	unsigned char* blocks;        // MaskState，MASK_BLOCK_SIZE 方块
+} CollisionMask;
+
+// 构建步骤：地图对象层中的 collision 矩形不可通行；
+// imagePath 不为 NULL 时再叠加手绘的遮罩图（按地图尺寸最近邻采样，暗色或透明像素不可通行）
+bool BuildCollisionMask(CollisionMask* mask, const TileMap* map, const char* imagePath);
+
+// .lmask 文件：16 字节文件头 "LMSK"、version、width、height（uint32 小端），后跟逐行的 64 位字
+// 粗网格在读入时由位图重新计算
+bool SaveCollisionMask(const CollisionMask* mask, const char* path);
+bool LoadCollisionMask(CollisionMask* mask, const char* path);
+void UnloadCollisionMask(CollisionMask* mask);
+
+// 地图文件对应的 .lmask 路径（返回值指向内部缓冲区）
+const char* GetCollisionMaskPath(const char* mapPath);
+
+// 像素是否可通行，地图外不可通行
+bool IsWalkable(const CollisionMask* mask, int x, int y);
+
+// 从 from 沿直线移动到 to 的路径上是否全部可通行（包括两个端点）
+bool CanMoveTo(const CollisionMask* mask, Vector2 from, Vector2 to);
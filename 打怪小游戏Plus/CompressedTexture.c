@@ -0,0 +1,306 @@
+﻿#define _CRT_SECURE_NO_WARNINGS
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "CompressedTexture.h"
+
+#define LTEX_MAGIC "LTEX"
+#define LTEX_VERSION 1
+
+// 文件中的像素格式编号，与 raylib 的 PixelFormat 数值无关，raylib 升级后文件仍然可用
+#define LTEX_FORMAT_RGBA8 0
+#define LTEX_FORMAT_BC1 1
+
+// ---- BC1 编解码 ----
+
+static uint16_t packRGB565(const unsigned char* c)
+{
+	return (uint16_t)(((c[0] * 31 + 127) / 255) << 11 | ((c[1] * 63 + 127) / 255) << 5 | ((c[2] * 31 + 127) / 255));
+}
+
+static void unpackRGB565(uint16_t v, unsigned char* c)
+{
+	int r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+	c[0] = (unsigned char)((r << 3) | (r >> 2));
+	c[1] = (unsigned char)((g << 2) | (g >> 4));
+	c[2] = (unsigned char)((b << 3) | (b >> 2));
+	c[3] = 255;
+}
+
+// 4 色模式的调色板：两个端点与它们之间的 1/3、2/3 插值
+static void bc1Palette(uint16_t c0, uint16_t c1, unsigned char palette[4][4])
+{
+	unpackRGB565(c0, palette[0]);
+	unpackRGB565(c1, palette[1]);
+	for (int k = 0; k < 3; k++)
+	{
+		if (c0 > c1)
+		{
+			palette[2][k] = (unsigned char)((2 * palette[0][k] + palette[1][k]) / 3);
+			palette[3][k] = (unsigned char)((palette[0][k] + 2 * palette[1][k]) / 3);
+		}
+		else
+		{
+			palette[2][k] = (unsigned char)((palette[0][k] + palette[1][k]) / 2);
+			palette[3][k] = 0;
+		}
+	}
+	palette[2][3] = 255;
+	palette[3][3] = (c0 > c1) ? 255 : 0;
+}
+
+// 单块编码：取块内颜色包围盒的两个角作为端点（range fit），每个像素选最近的调色板颜色
+static void compressBlock(const unsigned char pixels[16][4], unsigned char* out)
+{
+	unsigned char lo[3] = { 255, 255, 255 }, hi[3] = { 0, 0, 0 };
+	for (int i = 0; i < 16; i++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			if (pixels[i][k] < lo[k]) lo[k] = pixels[i][k];
+			if (pixels[i][k] > hi[k]) hi[k] = pixels[i][k];
+		}
+	}
+
+	uint16_t c0 = packRGB565(hi);
+	uint16_t c1 = packRGB565(lo);
+	unsigned int indices = 0;
+	if (c0 == c1)
+	{
+		// 纯色块：所有像素都用端点 0
+		if (c0 > 0) c1 = c0 - 1;
+		else c0 = 1;
+	}
+	else
+	{
+		if (c0 < c1)
+		{
+			uint16_t t = c0;
+			c0 = c1;
+			c1 = t;
+		}
+		unsigned char palette[4][4];
+		bc1Palette(c0, c1, palette);
+		for (int i = 0; i < 16; i++)
+		{
+			int best = 0, bestDist = 0x7fffffff;
+			for (int p = 0; p < 4; p++)
+			{
+				int dr = pixels[i][0] - palette[p][0];
+				int dg = pixels[i][1] - palette[p][1];
+				int db = pixels[i][2] - palette[p][2];
+				int d = dr * dr + dg * dg + db * db;
+				if (d < bestDist)
+				{
+					bestDist = d;
+					best = p;
+				}
+			}
+			indices |= (unsigned int)best << (2 * i);
+		}
+	}
+
+	out[0] = (unsigned char)(c0 & 0xff);
+	out[1] = (unsigned char)(c0 >> 8);
+	out[2] = (unsigned char)(c1 & 0xff);
+	out[3] = (unsigned char)(c1 >> 8);
+	out[4] = (unsigned char)(indices & 0xff);
+	out[5] = (unsigned char)((indices >> 8) & 0xff);
+	out[6] = (unsigned char)((indices >> 16) & 0xff);
+	out[7] = (unsigned char)(indices >> 24);
+}
+
+void CompressBC1(const unsigned char* rgba, int width, int height, unsigned char* blocks)
+{
+	unsigned char pixels[16][4];
+	for (int by = 0; by < height; by += 4)
+	{
+		for (int bx = 0; bx < width; bx += 4)
+		{
+			for (int i = 0; i < 16; i++)
+			{
+				memcpy(pixels[i], rgba + 4 * ((size_t)(by + i / 4) * width + bx + i % 4), 4);
+			}
+			compressBlock(pixels, blocks);
+			blocks += 8;
+		}
+	}
+}
+
+void DecompressBC1(const unsigned char* blocks, int width, int height, unsigned char* rgba)
+{
+	unsigned char palette[4][4];
+	for (int by = 0; by < height; by += 4)
+	{
+		for (int bx = 0; bx < width; bx += 4)
+		{
+			uint16_t c0 = (uint16_t)(blocks[0] | blocks[1] << 8);
+			uint16_t c1 = (uint16_t)(blocks[2] | blocks[3] << 8);
+			unsigned int indices = blocks[4] | blocks[5] << 8 | blocks[6] << 16 | (unsigned int)blocks[7] << 24;
+			bc1Palette(c0, c1, palette);
+			for (int i = 0; i < 16; i++)
+			{
+				memcpy(rgba + 4 * ((size_t)(by + i / 4) * width + bx + i % 4), palette[(indices >> (2 * i)) & 3], 4);
+			}
+			blocks += 8;
+		}
+	}
+}
+
+// ---- 容器读写 ----
+
+static void writeU32(unsigned char* p, uint32_t v)
+{
+	p[0] = (unsigned char)v;
+	p[1] = (unsigned char)(v >> 8);
+	p[2] = (unsigned char)(v >> 16);
+	p[3] = (unsigned char)(v >> 24);
+}
+
+static uint32_t readU32(const unsigned char* p)
+{
+	return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+bool BuildCompressedTexture(const char* srcPath, const char* dstPath, bool compress)
+{
+	Image src = LoadImage(srcPath);
+	if (src.data == NULL)
+	{
+		printf(u8"无法读取: %s\n", srcPath);
+		return false;
+	}
+	ImageFormat(&src, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+	// 补齐到 4 的倍数，补出的行列复制边缘像素
+	int width = (src.width + 3) & ~3;
+	int height = (src.height + 3) & ~3;
+	size_t rgbaSize = (size_t)width * height * 4;
+	unsigned char* rgba = (unsigned char*)MemAlloc((unsigned int)rgbaSize);
+	const unsigned char* pixels = (const unsigned char*)src.data;
+	for (int y = 0; y < height; y++)
+	{
+		int sy = (y < src.height) ? y : src.height - 1;
+		for (int x = 0; x < width; x++)
+		{
+			int sx = (x < src.width) ? x : src.width - 1;
+			memcpy(rgba + 4 * ((size_t)y * width + x), pixels + 4 * ((size_t)sy * src.width + sx), 4);
+		}
+	}
+	UnloadImage(src);
+
+	int format = compress ? LTEX_FORMAT_BC1 : LTEX_FORMAT_RGBA8;
+	size_t dataSize = compress ? rgbaSize / 8 : rgbaSize;
+	unsigned char* file = (unsigned char*)MemAlloc((unsigned int)(LTEX_HEADER_SIZE + dataSize));
+	memcpy(file, LTEX_MAGIC, 4);
+	writeU32(file + 4, LTEX_VERSION);
+	writeU32(file + 8, (uint32_t)width);
+	writeU32(file + 12, (uint32_t)height);
+	writeU32(file + 16, (uint32_t)format);
+	writeU32(file + 20, (uint32_t)dataSize);
+	if (compress)
+	{
+		CompressBC1(rgba, width, height, file + LTEX_HEADER_SIZE);
+	}
+	else
+	{
+		memcpy(file + LTEX_HEADER_SIZE, rgba, dataSize);
+	}
+	MemFree(rgba);
+
+	bool ok = SaveFileData(dstPath, file, (int)(LTEX_HEADER_SIZE + dataSize));
+	MemFree(file);
+	if (ok)
+	{
+		printf(u8"%s -> %s (%dx%d, %s, %d KB)\n", srcPath, dstPath, width, height, compress ? "BC1" : "RGBA8", (int)(dataSize / 1024));
+	}
+	return ok;
+}
+
+const char* PreferCompressedPath(const char* pngPath)
+{
+	static char path[512];
+	const char* dot = strrchr(pngPath, '.');
+	size_t stem = dot ? (size_t)(dot - pngPath) : strlen(pngPath);
+	if (stem + 6 > sizeof(path))
+	{
+		return pngPath;
+	}
+	memcpy(path, pngPath, stem);
+	strcpy(path + stem, ".ltex");
+	return FileExists(path) ? path : pngPath;
+}
+
+static bool isLtexPath(const char* path)
+{
+	const char* dot = strrchr(path, '.');
+	return dot != NULL && strcmp(dot, ".ltex") == 0;
+}
+
+Image LoadTextureImage(const char* path)
+{
+	Image image = { 0 };
+	if (!isLtexPath(path))
+	{
+		return LoadImage(path);
+	}
+
+	int size = 0;
+	unsigned char* file = LoadFileData(path, &size);
+	if (file == NULL)
+	{
+		return image;
+	}
+
+	if (size >= LTEX_HEADER_SIZE && memcmp(file, LTEX_MAGIC, 4) == 0 && readU32(file + 4) == LTEX_VERSION)
+	{
+		uint32_t width = readU32(file + 8);
+		uint32_t height = readU32(file + 12);
+		uint32_t format = readU32(file + 16);
+		uint32_t dataSize = readU32(file + 20);
+		// 尺寸与格式须与数据长度相符：过期或截断的 .ltex 会让上传与 DXT 软解读写越界
+		// BC1 以 4x4 为一块，每块 8 字节，即每像素半字节；边长上限保证后面按 int 计算 RGBA 大小时不溢出
+		bool bc1 = (format == LTEX_FORMAT_BC1);
+		uint64_t expected = bc1 ? (uint64_t)width * height / 2 : (uint64_t)width * height * 4;
+		bool valid = (bc1 || format == LTEX_FORMAT_RGBA8)
+			&& width > 0 && height > 0 && width <= 16384 && height <= 16384
+			&& (!bc1 || (width % 4 == 0 && height % 4 == 0))
+			&& dataSize == expected
+			&& (size_t)size >= LTEX_HEADER_SIZE + (size_t)dataSize;
+		if (valid)
+		{
+			// 像素数据原样交给 GPU，不做任何解码
+			image.data = MemAlloc(dataSize);
+			memcpy(image.data, file + LTEX_HEADER_SIZE, dataSize);
+			image.width = (int)width;
+			image.height = (int)height;
+			image.format = (format == LTEX_FORMAT_BC1) ? PIXELFORMAT_COMPRESSED_DXT1_RGB : PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+			image.mipmaps = 1;
+		}
+	}
+	if (image.data == NULL)
+	{
+		TraceLog(LOG_WARNING, "CompressedTexture: invalid %s", path);
+	}
+	UnloadFileData(file);
+	return image;
+}
+
+Texture2D UploadTextureImage(Image image)
+{
+	Texture2D texture = LoadTextureFromImage(image);
+	if (texture.id == 0 && image.format == PIXELFORMAT_COMPRESSED_DXT1_RGB)
+	{
+		// 显卡不支持 DXT：在 CPU 上解压成 RGBA8 再上传
+		Image rgba = { 0 };
+		rgba.data = MemAlloc((unsigned int)image.width * image.height * 4);
+		rgba.width = image.width;
+		rgba.height = image.height;
+		rgba.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+		rgba.mipmaps = 1;
+		DecompressBC1((const unsigned char*)image.data, image.width, image.height, (unsigned char*)rgba.data);
+		texture = LoadTextureFromImage(rgba);
+		UnloadImage(rgba);
+	}
+	return texture;
+}
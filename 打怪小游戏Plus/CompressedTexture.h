@@ -0,0 +1,28 @@
+﻿#pragma once
+
+#include <stdbool.h>
+#include <raylib.h>
+
+// 预处理好的纹理容器 .ltex：固定 32 字节文件头后紧跟可直接上传的像素数据
+//   char magic[4] = "LTEX"; uint32 version; uint32 width; uint32 height;
+//   uint32 format (0 = RGBA8, 1 = BC1); uint32 dataSize; uint32 reserved[2];
+// 宽高补齐到 4 的倍数（BC1 以 4x4 像素为一块），补出的像素复制边缘
+// 数据可以是 BC1/DXT1 压缩（每像素 0.5 字节，约为 RGBA 的 1/8），也可以是未压缩的 RGBA8
+#define LTEX_HEADER_SIZE 32
+
+// 构建步骤：把 srcPath 的图片转换为 .ltex，compress 为 false 时写入未压缩 RGBA8
+bool BuildCompressedTexture(const char* srcPath, const char* dstPath, bool compress);
+
+// 若同名 .ltex 存在则返回它的路径，否则原样返回 pngPath（返回值指向内部缓冲区）
+const char* PreferCompressedPath(const char* pngPath);
+
+// 读取图片：.ltex 直接读入像素数据不做解码，其余格式交给 LoadImage
+// 只做 CPU 端工作，可以在加载线程中调用
+Image LoadTextureImage(const char* path);
+
+// 上传纹理（需在主线程调用）：显卡不支持 DXT 时在 CPU 上解压后再上传
+Texture2D UploadTextureImage(Image image);
+
+// BC1 编解码：rgba 为 width*height 个 RGBA8 像素，宽高须为 4 的倍数
+void CompressBC1(const unsigned char* rgba, int width, int height, unsigned char* blocks);
+void DecompressBC1(const unsigned char* blocks, int width, int height, unsigned char* rgba);
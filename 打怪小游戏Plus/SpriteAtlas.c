@@ -0,0 +1,274 @@
+﻿#define _CRT_SECURE_NO_WARNINGS
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "SpriteAtlas.h"
+
+#define ATLAS_PADDING 2          // 精灵之间留空，避免纹理过滤时采到相邻精灵
+#define ATLAS_MAX_SIZE 4096
+#define ATLAS_META_MAGIC "LATLAS"
+#define ATLAS_META_VERSION 1
+
+static const char* spriteNames[SPRITE_COUNT] = {
+	u8"向前", u8"向后", u8"向左", u8"向右",
+	u8"向左跑", u8"向右跑", u8"静止", u8"跳跃",
+	u8"攻击", u8"格挡", u8"受伤", u8"死亡"
+};
+
+const char* GetSpriteName(SpriteId id)
+{
+	return (id >= 0 && id < SPRITE_COUNT) ? spriteNames[id] : "";
+}
+
+static const char* spritePath(const char* imageDir, SpriteId id)
+{
+	return TextFormat("%s/%s.png", imageDir, spriteNames[id]);
+}
+
+// ---- 离线打包 ----
+
+// 按高度从高到低排好的精灵依次放进宽为 width 的货架，返回总高度，放不下返回 -1
+static int shelfPack(const Image* images, const int* order, int width, Rectangle* rects)
+{
+	int x = ATLAS_PADDING, y = ATLAS_PADDING, shelfHeight = 0;
+	for (int k = 0; k < SPRITE_COUNT; k++)
+	{
+		const Image* img = &images[order[k]];
+		if (img->width + 2 * ATLAS_PADDING > width)
+		{
+			return -1;
+		}
+		if (x + img->width + ATLAS_PADDING > width)
+		{
+			// 换到下一层货架
+			x = ATLAS_PADDING;
+			y += shelfHeight + ATLAS_PADDING;
+			shelfHeight = 0;
+		}
+		rects[order[k]] = (Rectangle){ (float)x, (float)y, (float)img->width, (float)img->height };
+		x += img->width + ATLAS_PADDING;
+		if (img->height > shelfHeight)
+		{
+			shelfHeight = img->height;
+		}
+	}
+	return y + shelfHeight + ATLAS_PADDING;
+}
+
+static int nextPowerOfTwo(int v)
+{
+	int p = 1;
+	while (p < v)
+	{
+		p <<= 1;
+	}
+	return p;
+}
+
+bool PackSpriteAtlas(const char* imageDir, const char* atlasPath, const char* metaPath)
+{
+	Image images[SPRITE_COUNT] = { 0 };
+	int order[SPRITE_COUNT];
+	bool ok = true;
+
+	for (int i = 0; i < SPRITE_COUNT; i++)
+	{
+		images[i] = LoadImage(spritePath(imageDir, (SpriteId)i));
+		if (images[i].data == NULL)
+		{
+			printf(u8"找不到精灵: %s\n", spritePath(imageDir, (SpriteId)i));
+			ok = false;
+		}
+		order[i] = i;
+	}
+
+	// 按高度从高到低插入排序（精灵数量很少；相同高度保持原顺序，打包结果稳定）
+	for (int i = 1; ok && i < SPRITE_COUNT; i++)
+	{
+		for (int j = i; j > 0 && images[order[j - 1]].height < images[order[j]].height; j--)
+		{
+			int t = order[j];
+			order[j] = order[j - 1];
+			order[j - 1] = t;
+		}
+	}
+
+	// 依次尝试 2 的幂宽度，取面积最小的摆放；面积相同时取更接近正方形的
+	Rectangle rects[SPRITE_COUNT], best[SPRITE_COUNT];
+	int bestW = 0, bestH = 0;
+	for (int w = 64; ok && w <= ATLAS_MAX_SIZE; w <<= 1)
+	{
+		int h = shelfPack(images, order, w, rects);
+		if (h < 0 || h > ATLAS_MAX_SIZE)
+		{
+			continue;
+		}
+		h = nextPowerOfTwo(h);
+		long area = (long)w * h, bestArea = (long)bestW * bestH;
+		if (bestW == 0 || area < bestArea || (area == bestArea && abs(w - h) < abs(bestW - bestH)))
+		{
+			bestW = w;
+			bestH = h;
+			memcpy(best, rects, sizeof(rects));
+		}
+	}
+	if (ok && bestW == 0)
+	{
+		printf(u8"精灵总尺寸超过 %dx%d，无法打包\n", ATLAS_MAX_SIZE, ATLAS_MAX_SIZE);
+		ok = false;
+	}
+
+	if (ok)
+	{
+		Image atlas = GenImageColor(bestW, bestH, BLANK);
+		for (int i = 0; i < SPRITE_COUNT; i++)
+		{
+			Rectangle src = { 0, 0, (float)images[i].width, (float)images[i].height };
+			ImageDraw(&atlas, images[i], src, best[i], WHITE);
+		}
+		ok = ExportImage(atlas, atlasPath);
+		UnloadImage(atlas);
+	}
+
+	if (ok)
+	{
+		FILE* f = fopen(metaPath, "w");
+		ok = (f != NULL);
+		if (f)
+		{
+			fprintf(f, "%s %d %d %d %d\n", ATLAS_META_MAGIC, ATLAS_META_VERSION, bestW, bestH, SPRITE_COUNT);
+			for (int i = 0; i < SPRITE_COUNT; i++)
+			{
+				fprintf(f, "%s %d %d %d %d\n", spriteNames[i], (int)best[i].x, (int)best[i].y, (int)best[i].width, (int)best[i].height);
+			}
+			fclose(f);
+		}
+	}
+
+	if (ok)
+	{
+		printf(u8"已打包 %d 个精灵到 %s (%dx%d)，元数据 %s\n", SPRITE_COUNT, atlasPath, bestW, bestH, metaPath);
+	}
+
+	for (int i = 0; i < SPRITE_COUNT; i++)
+	{
+		if (images[i].data != NULL)
+		{
+			UnloadImage(images[i]);
+		}
+	}
+	return ok;
+}
+
+// ---- 运行时加载 ----
+
+// 读取元数据表，每个精灵都必须出现且落在图集范围内；图集尺寸写入 atlasWidth、atlasHeight
+static bool loadAtlasMeta(const char* metaPath, Rectangle* rects, int* atlasWidth, int* atlasHeight)
+{
+	char* text = LoadFileText(metaPath);
+	if (text == NULL)
+	{
+		return false;
+	}
+
+	bool found[SPRITE_COUNT] = { false };
+	char magic[16];
+	int version = 0, width = 0, height = 0, count = 0, consumed = 0;
+	bool ok = sscanf(text, "%15s %d %d %d %d%n", magic, &version, &width, &height, &count, &consumed) == 5
+		&& strcmp(magic, ATLAS_META_MAGIC) == 0 && version == ATLAS_META_VERSION;
+
+	const char* p = text + consumed;
+	for (int k = 0; ok && k < count; k++)
+	{
+		char name[64];
+		int x, y, w, h, n = 0;
+		if (sscanf(p, "%63s %d %d %d %d%n", name, &x, &y, &w, &h, &n) != 5)
+		{
+			ok = false;
+			break;
+		}
+		p += n;
+		if (x < 0 || y < 0 || x + w > width || y + h > height)
+		{
+			ok = false;
+			break;
+		}
+		for (int i = 0; i < SPRITE_COUNT; i++)
+		{
+			if (strcmp(name, spriteNames[i]) == 0)
+			{
+				rects[i] = (Rectangle){ (float)x, (float)y, (float)w, (float)h };
+				found[i] = true;
+			}
+		}
+	}
+	UnloadFileText(text);
+
+	for (int i = 0; ok && i < SPRITE_COUNT; i++)
+	{
+		ok = found[i];
+	}
+	*atlasWidth = width;
+	*atlasHeight = height;
+	return ok;
+}
+
+void LoadSpriteAtlas(SpriteAtlas* atlas, const char* imageDir, const char* atlasPath, const char* metaPath)
+{
+	memset(atlas, 0, sizeof(*atlas));
+
+	int metaWidth = 0, metaHeight = 0;
+	if (FileExists(atlasPath) && loadAtlasMeta(metaPath, atlas->rects, &metaWidth, &metaHeight))
+	{
+		// 一次解码、一张纹理，所有精灵绘制都绑定同一纹理，可以合批
+		Texture2D tex = LoadTexture(atlasPath);
+		if (tex.id != 0 && (tex.width != metaWidth || tex.height != metaHeight))
+		{
+			// 重新打包了图集却留着旧的元数据：矩形对不上，按过期处理
+			TraceLog(LOG_WARNING, "SpriteAtlas: %s is %dx%d but %s expects %dx%d", atlasPath, tex.width, tex.height,
+				metaPath, metaWidth, metaHeight);
+			UnloadTexture(tex);
+			tex.id = 0;
+		}
+		if (tex.id != 0)
+		{
+			for (int i = 0; i < SPRITE_COUNT; i++)
+			{
+				atlas->textures[i] = tex;
+			}
+			atlas->packed = true;
+			return;
+		}
+	}
+
+	// 回退：逐个加载
+	TraceLog(LOG_WARNING, "SpriteAtlas: atlas missing or stale, loading sprites one by one");
+	for (int i = 0; i < SPRITE_COUNT; i++)
+	{
+		Texture2D tex = LoadTexture(spritePath(imageDir, (SpriteId)i));
+		atlas->textures[i] = tex;
+		atlas->rects[i] = (Rectangle){ 0, 0, (float)tex.width, (float)tex.height };
+	}
+	atlas->packed = false;
+}
+
+void UnloadSpriteAtlas(SpriteAtlas* atlas)
+{
+	if (atlas->packed)
+	{
+		UnloadTexture(atlas->textures[0]);
+	}
+	else
+	{
+		for (int i = 0; i < SPRITE_COUNT; i++)
+		{
+			UnloadTexture(atlas->textures[i]);
+		}
+	}
+	memset(atlas, 0, sizeof(*atlas));
+}
+
+void DrawSprite(const SpriteAtlas* atlas, SpriteId id, Vector2 pos, Color tint)
+{
+	DrawTextureRec(atlas->textures[id], atlas->rects[id], pos, tint);
+}
@@ -0,0 +1,44 @@
+﻿#pragma once
+
+#include <stdbool.h>
+#include <raylib.h>
+
+// 角色精灵编号，顺序与 GetSpriteName 中的文件名一一对应
+typedef enum SpriteId
+{
+	SPRITE_FORWARD,     // 向前
+	SPRITE_BACK,        // 向后
+	SPRITE_LEFT,        // 向左
+	SPRITE_RIGHT,       // 向右
+	SPRITE_RUN_LEFT,    // 向左跑
+	SPRITE_RUN_RIGHT,   // 向右跑
+	SPRITE_IDLE,        // 静止
+	SPRITE_JUMP,        // 跳跃
+	SPRITE_ATTACK,      // 攻击
+	SPRITE_BLOCK,       // 格挡
+	SPRITE_HURT,        // 受伤
+	SPRITE_DEATH,       // 死亡
+	SPRITE_COUNT
+} SpriteId;
+
+// 精灵图集：所有角色精灵打包在一张纹理里，每个精灵对应其中一个矩形
+// 找不到图集时退回为每个精灵单独一张纹理，绘制接口不变
+typedef struct SpriteAtlas
+{
+	Texture2D textures[SPRITE_COUNT];   // 图集模式下全部是同一张纹理
+	Rectangle rects[SPRITE_COUNT];      // 精灵在纹理中的位置
+	bool packed;                        // true: 使用图集；false: 逐个加载的回退模式
+} SpriteAtlas;
+
+// 精灵的文件名（不含目录与扩展名），同时作为元数据表中的键
+const char* GetSpriteName(SpriteId id);
+
+// 离线打包：读取 imageDir 下的全部角色精灵，写出图集 png 与元数据表
+// 不需要窗口，由 "打怪小游戏Plus.exe --pack-atlas" 调用
+bool PackSpriteAtlas(const char* imageDir, const char* atlasPath, const char* metaPath);
+
+// 运行时加载：优先读取图集，缺失或与精灵列表不符时逐个加载 imageDir 下的精灵
+void LoadSpriteAtlas(SpriteAtlas* atlas, const char* imageDir, const char* atlasPath, const char* metaPath);
+void UnloadSpriteAtlas(SpriteAtlas* atlas);
+
+void DrawSprite(const SpriteAtlas* atlas, SpriteId id, Vector2 pos, Color tint);
@@ -0,0 +1,404 @@
+﻿#define _CRT_SECURE_NO_WARNINGS
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "TileMap.h"
+
+#define TILE_MAP_VERSION 1
+// 图块编号存为 unsigned short，0 表示空图块
+#define TILE_MAP_MAX_UNIQUE_TILES 65535
+
+// ---- 读写 ----
+
+// 逐行读取：返回下一行的开头并把本行结尾改成 '\0'，读完返回 NULL
+static char* nextLine(char** cursor)
+{
+	char* line = *cursor;
+	if (line == NULL || *line == '\0')
+	{
+		return NULL;
+	}
+	char* end = strpbrk(line, "\r\n");
+	if (end)
+	{
+		*end = '\0';
+		end++;
+		if (*end == '\n')
+		{
+			end++;
+		}
+	}
+	*cursor = end;
+	return line;
+}
+
+static bool isBlankOrComment(const char* line)
+{
+	while (*line == ' ' || *line == '\t')
+	{
+		line++;
+	}
+	return *line == '\0' || *line == '#';
+}
+
+static bool readLayerRows(TileMap* map, TileLayer* layer, char** cursor)
+{
+	layer->tiles = (unsigned short*)calloc((size_t)map->cols * map->rows, sizeof(unsigned short));
+	if (layer->tiles == NULL)
+	{
+		return false;
+	}
+	for (int r = 0; r < map->rows; r++)
+	{
+		char* line;
+		do
+		{
+			line = nextLine(cursor);
+		} while (line != NULL && isBlankOrComment(line));
+		if (line == NULL)
+		{
+			return false;
+		}
+
+		char* p = line;
+		for (int c = 0; c < map->cols; c++)
+		{
+			char* end;
+			long tile = strtol(p, &end, 10);
+			if (end == p || tile < 0 || tile > 65535)
+			{
+				return false;
+			}
+			layer->tiles[(size_t)r * map->cols + c] = (unsigned short)tile;
+			p = end;
+		}
+	}
+	return true;
+}
+
+bool LoadTileMap(TileMap* map, const char* path)
+{
+	memset(map, 0, sizeof(*map));
+	char* text = LoadFileText(path);
+	if (text == NULL)
+	{
+		return false;
+	}
+
+	bool ok = true;
+	bool header = false;
+	char* cursor = text;
+	char* line;
+	while (ok && (line = nextLine(&cursor)) != NULL)
+	{
+		if (isBlankOrComment(line))
+		{
+			continue;
+		}
+
+		char key[16] = { 0 };
+		int n = 0;
+		sscanf(line, "%15s%n", key, &n);
+		const char* args = line + n;
+
+		if (strcmp(key, "tilemap") == 0)
+		{
+			int version = 0;
+			header = sscanf(args, "%d", &version) == 1 && version == TILE_MAP_VERSION;
+			ok = header;
+		}
+		else if (!header)
+		{
+			ok = false;
+		}
+		else if (strcmp(key, "tileset") == 0)
+		{
+			ok = sscanf(args, "%259s %d", map->tilesetPath, &map->tileSize) == 2 && map->tileSize > 0;
+		}
+		else if (strcmp(key, "size") == 0)
+		{
+			// 只能出现一次：图层按读到时的尺寸分配，之后再改尺寸会让绘制越界
+			ok = map->cols == 0 && sscanf(args, "%d %d", &map->cols, &map->rows) == 2 && map->cols > 0 && map->rows > 0;
+		}
+		else if (strcmp(key, "layer") == 0)
+		{
+			ok = map->cols > 0 && map->layerCount < TILE_MAP_MAX_LAYERS;
+			if (ok)
+			{
+				TileLayer* layer = &map->layers[map->layerCount++];
+				sscanf(args, "%31s", layer->name);
+				ok = readLayerRows(map, layer, &cursor);
+			}
+		}
+		else if (strcmp(key, "object") == 0)
+		{
+			ok = map->objectCount < TILE_MAP_MAX_OBJECTS;
+			if (ok)
+			{
+				MapObject* obj = &map->objects[map->objectCount++];
+				char type[16];
+				ok = sscanf(args, "%15s %31s %f %f %f %f", type, obj->name,
+					&obj->rect.x, &obj->rect.y, &obj->rect.width, &obj->rect.height) == 6;
+				if (strcmp(type, "portal") == 0) obj->type = MAP_OBJECT_PORTAL;
+				else if (strcmp(type, "collision") == 0) obj->type = MAP_OBJECT_COLLISION;
+				else ok = false;
+			}
+		}
+		else
+		{
+			ok = false;
+		}
+	}
+	UnloadFileText(text);
+
+	if (!ok || !header || map->tileSize <= 0 || map->layerCount == 0)
+	{
+		TraceLog(LOG_WARNING, "TileMap: failed to load %s", path);
+		UnloadTileMap(map);
+		return false;
+	}
+	return true;
+}
+
+bool SaveTileMap(const TileMap* map, const char* path)
+{
+	FILE* f = fopen(path, "w");
+	if (f == NULL)
+	{
+		return false;
+	}
+
+	fprintf(f, "tilemap %d\n", TILE_MAP_VERSION);
+	fprintf(f, "tileset %s %d\n", map->tilesetPath, map->tileSize);
+	fprintf(f, "size %d %d\n", map->cols, map->rows);
+	for (int l = 0; l < map->layerCount; l++)
+	{
+		fprintf(f, "layer %s\n", map->layers[l].name);
+		for (int r = 0; r < map->rows; r++)
+		{
+			for (int c = 0; c < map->cols; c++)
+			{
+				fprintf(f, c ? " %d" : "%d", map->layers[l].tiles[(size_t)r * map->cols + c]);
+			}
+			fprintf(f, "\n");
+		}
+	}
+	for (int i = 0; i < map->objectCount; i++)
+	{
+		const MapObject* o = &map->objects[i];
+		fprintf(f, "object %s %s %g %g %g %g\n", o->type == MAP_OBJECT_PORTAL ? "portal" : "collision", o->name,
+			o->rect.x, o->rect.y, o->rect.width, o->rect.height);
+	}
+	fclose(f);
+	return true;
+}
+
+void UnloadTileMap(TileMap* map)
+{
+	for (int l = 0; l < map->layerCount; l++)
+	{
+		free(map->layers[l].tiles);
+	}
+	memset(map, 0, sizeof(*map));
+}
+
+float GetTileMapWidth(const TileMap* map)
+{
+	return (float)(map->cols * map->tileSize);
+}
+
+float GetTileMapHeight(const TileMap* map)
+{
+	return (float)(map->rows * map->tileSize);
+}
+
+const MapObject* FindMapObject(const TileMap* map, MapObjectType type, const char* name)
+{
+	for (int i = 0; i < map->objectCount; i++)
+	{
+		if (map->objects[i].type == type && strcmp(map->objects[i].name, name) == 0)
+		{
+			return &map->objects[i];
+		}
+	}
+	return NULL;
+}
+
+// ---- 离线构建 ----
+
+// 取出 (c, r) 处的图块像素，超出图片的部分保持透明
+static void copyTile(const Image* src, int c, int r, int tileSize, unsigned char* out)
+{
+	memset(out, 0, (size_t)tileSize * tileSize * 4);
+	const unsigned char* pixels = (const unsigned char*)src->data;
+	int x0 = c * tileSize, y0 = r * tileSize;
+	int w = (x0 + tileSize <= src->width) ? tileSize : src->width - x0;
+	int h = (y0 + tileSize <= src->height) ? tileSize : src->height - y0;
+	for (int y = 0; y < h; y++)
+	{
+		memcpy(out + (size_t)y * tileSize * 4, pixels + 4 * ((size_t)(y0 + y) * src->width + x0), (size_t)w * 4);
+	}
+}
+
+static unsigned int hashTile(const unsigned char* p, size_t n)
+{
+	unsigned int h = 2166136261u;
+	for (size_t i = 0; i < n; i++)
+	{
+		h = (h ^ p[i]) * 16777619u;
+	}
+	return h;
+}
+
+bool BuildTileMapFromImage(const char* imagePath, int tileSize, const char* tilesetPath, const char* mapPath)
+{
+	if (tileSize <= 0)
+	{
+		printf(u8"图块边长须大于 0: %d\n", tileSize);
+		return false;
+	}
+	Image src = LoadImage(imagePath);
+	if (src.data == NULL)
+	{
+		printf(u8"无法读取: %s\n", imagePath);
+		return false;
+	}
+	ImageFormat(&src, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+	TileMap map;
+	memset(&map, 0, sizeof(map));
+	map.cols = (src.width + tileSize - 1) / tileSize;
+	map.rows = (src.height + tileSize - 1) / tileSize;
+	map.tileSize = tileSize;
+	strncpy(map.tilesetPath, tilesetPath, TILE_MAP_MAX_PATH - 1);
+	map.layerCount = 1;
+	strcpy(map.layers[0].name, "ground");
+
+	int total = map.cols * map.rows;
+	size_t tileBytes = (size_t)tileSize * tileSize * 4;
+	map.layers[0].tiles = (unsigned short*)calloc(total, sizeof(unsigned short));
+	unsigned char* unique = (unsigned char*)malloc(tileBytes * total);   // 去重后的图块像素
+	unsigned int* hashes = (unsigned int*)malloc(sizeof(unsigned int) * total);
+	if (map.layers[0].tiles == NULL || unique == NULL || hashes == NULL)
+	{
+		printf(u8"内存不足: %s\n", imagePath);
+		free(hashes);
+		free(unique);
+		UnloadTileMap(&map);
+		UnloadImage(src);
+		return false;
+	}
+	int uniqueCount = 0;
+
+	bool fits = true;
+	for (int r = 0; r < map.rows && fits; r++)
+	{
+		for (int c = 0; c < map.cols; c++)
+		{
+			unsigned char* tile = unique + tileBytes * uniqueCount;
+			copyTile(&src, c, r, tileSize, tile);
+			unsigned int h = hashTile(tile, tileBytes);
+
+			int found = -1;
+			for (int k = 0; k < uniqueCount && found < 0; k++)
+			{
+				if (hashes[k] == h && memcmp(unique + tileBytes * k, tile, tileBytes) == 0)
+				{
+					found = k;
+				}
+			}
+			if (found < 0 && uniqueCount == TILE_MAP_MAX_UNIQUE_TILES)
+			{
+				fits = false;
+				break;
+			}
+			if (found < 0)
+			{
+				hashes[uniqueCount] = h;
+				found = uniqueCount++;
+			}
+			map.layers[0].tiles[(size_t)r * map.cols + c] = (unsigned short)(found + 1);
+		}
+	}
+	UnloadImage(src);
+	if (!fits)
+	{
+		printf(u8"去重后的图块超过 %d 个，请增大图块边长: %s\n", TILE_MAP_MAX_UNIQUE_TILES, imagePath);
+		free(hashes);
+		free(unique);
+		UnloadTileMap(&map);
+		return false;
+	}
+
+	// 图块集按接近正方形排列
+	int setCols = (int)ceilf(sqrtf((float)uniqueCount));
+	int setRows = (uniqueCount + setCols - 1) / setCols;
+	Image tileset = GenImageColor(setCols * tileSize, setRows * tileSize, BLANK);
+	for (int k = 0; k < uniqueCount; k++)
+	{
+		Image tile = { unique + tileBytes * k, tileSize, tileSize, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+		Rectangle srcRect = { 0, 0, (float)tileSize, (float)tileSize };
+		Rectangle dstRect = { (float)(k % setCols * tileSize), (float)(k / setCols * tileSize), (float)tileSize, (float)tileSize };
+		ImageDraw(&tileset, tile, srcRect, dstRect, WHITE);
+	}
+
+	bool ok = ExportImage(tileset, tilesetPath) && SaveTileMap(&map, mapPath);
+	if (ok)
+	{
+		printf(u8"%s -> %s (%dx%d 图块，去重后 %d 个) + %s\n", imagePath, mapPath, map.cols, map.rows, uniqueCount, tilesetPath);
+	}
+
+	UnloadImage(tileset);
+	free(hashes);
+	free(unique);
+	UnloadTileMap(&map);
+	return ok;
+}
+
+// ---- 绘制 ----
+
+int DrawTileMap(const TileMap* map, Texture2D tileset, Camera2D camera, int screenWidth, int screenHeight)
+{
+	// 视野四角换算到世界坐标，得到可见的图块范围
+	Vector2 a = GetScreenToWorld2D((Vector2){ 0, 0 }, camera);
+	Vector2 b = GetScreenToWorld2D((Vector2){ (float)screenWidth, (float)screenHeight }, camera);
+	int ts = map->tileSize;
+	int c0 = (int)floorf(fminf(a.x, b.x) / ts), c1 = (int)floorf(fmaxf(a.x, b.x) / ts);
+	int r0 = (int)floorf(fminf(a.y, b.y) / ts), r1 = (int)floorf(fmaxf(a.y, b.y) / ts);
+	if (c0 < 0) c0 = 0;
+	if (r0 < 0) r0 = 0;
+	if (c1 >= map->cols) c1 = map->cols - 1;
+	if (r1 >= map->rows) r1 = map->rows - 1;
+
+	int setCols = (tileset.width + ts - 1) / ts;
+	int drawn = 0;
+	for (int l = 0; l < map->layerCount; l++)
+	{
+		const unsigned short* tiles = map->layers[l].tiles;
+		for (int r = r0; r <= r1; r++)
+		{
+			for (int c = c0; c <= c1; c++)
+			{
+				int tile = tiles[(size_t)r * map->cols + c];
+				if (tile == 0)
+				{
+					continue;
+				}
+
+				// 图块集边缘的图块可能不完整，源矩形裁剪到纹理范围内
+				int sx = (tile - 1) % setCols * ts;
+				int sy = (tile - 1) / setCols * ts;
+				float w = (float)((sx + ts <= tileset.width) ? ts : tileset.width - sx);
+				float h = (float)((sy + ts <= tileset.height) ? ts : tileset.height - sy);
+				if (w <= 0 || h <= 0)
+				{
+					continue;
+				}
+				DrawTextureRec(tileset, (Rectangle){ (float)sx, (float)sy, w, h }, (Vector2){ (float)(c * ts), (float)(r * ts) }, WHITE);
+				drawn++;
+			}
+		}
+	}
+	return drawn;
+}
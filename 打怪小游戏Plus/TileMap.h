@@ -0,0 +1,66 @@
+﻿#pragma once
+
+#include <stdbool.h>
+#include <raylib.h>
+
+#define TILE_MAP_MAX_LAYERS 4
+#define TILE_MAP_MAX_OBJECTS 64
+#define TILE_MAP_MAX_NAME 32
+#define TILE_MAP_MAX_PATH 260
+
+// 对象层中的对象类型
+typedef enum MapObjectType
+{
+	MAP_OBJECT_PORTAL,      // 传送门
+	MAP_OBJECT_COLLISION    // 不可通行区域
+} MapObjectType;
+
+typedef struct MapObject
+{
+	MapObjectType type;
+	char name[TILE_MAP_MAX_NAME];
+	Rectangle rect;          // 世界坐标（像素）
+} MapObject;
+
+// 图块层：cols*rows 个图块编号，0 表示空，n 表示图块集中的第 n-1 个图块（按行排列）
+typedef struct TileLayer
+{
+	char name[TILE_MAP_MAX_NAME];
+	unsigned short* tiles;
+} TileLayer;
+
+// 图块地图（文本格式 .ltm）：
+//   tilemap 1
+//   tileset <图块集图片> <图块边长>
+//   size <列数> <行数>
+//   layer <名称>            后跟 行数 行、每行 列数 个图块编号
+//   object portal|collision <名称> <x> <y> <w> <h>
+// 以 # 开头的行为注释
+typedef struct TileMap
+{
+	int cols, rows;
+	int tileSize;
+	char tilesetPath[TILE_MAP_MAX_PATH];
+	TileLayer layers[TILE_MAP_MAX_LAYERS];
+	int layerCount;
+	MapObject objects[TILE_MAP_MAX_OBJECTS];
+	int objectCount;
+} TileMap;
+
+bool LoadTileMap(TileMap* map, const char* path);
+bool SaveTileMap(const TileMap* map, const char* path);
+void UnloadTileMap(TileMap* map);
+
+// 地图的像素尺寸
+float GetTileMapWidth(const TileMap* map);
+float GetTileMapHeight(const TileMap* map);
+
+// 按类型与名称查找对象，找不到返回 NULL
+const MapObject* FindMapObject(const TileMap* map, MapObjectType type, const char* name);
+
+// 离线构建：把一张大图切成 tileSize 的图块，相同图块只保留一份，写出图块集图片与地图文件
+bool BuildTileMapFromImage(const char* imagePath, int tileSize, const char* tilesetPath, const char* mapPath);
+
+// 只绘制摄像机视野内的图块，须在 BeginMode2D(camera) 与 EndMode2D 之间调用
+// 返回本帧提交的图块数
+int DrawTileMap(const TileMap* map, Texture2D tileset, Camera2D camera, int screenWidth, int screenHeight);
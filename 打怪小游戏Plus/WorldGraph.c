@@ -0,0 +1,279 @@
+﻿#define _CRT_SECURE_NO_WARNINGS
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "WorldGraph.h"
+
+#define WORLD_VERSION 1
+
+static int findMap(const World* world, const char* name)
+{
+	for (int i = 0; i < world->mapCount; i++)
+	{
+		if (strcmp(world->maps[i].name, name) == 0)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+static int clampCell(int v, int n)
+{
+	return v < 0 ? 0 : (v >= n ? n - 1 : v);
+}
+
+// 为一张地图建立传送门网格：先数每格的数量，再按前缀和填入（与 Lumin 的 AttackGrid 相同的计数排序）
+static bool buildPortalIndex(World* world, int map)
+{
+	WorldMap* wm = &world->maps[map];
+	PortalIndex* index = &wm->portals;
+	index->cols = (int)(GetTileMapWidth(&wm->tiles) / PORTAL_CELL_SIZE) + 1;
+	index->rows = (int)(GetTileMapHeight(&wm->tiles) / PORTAL_CELL_SIZE) + 1;
+	int cellCount = index->cols * index->rows;
+	index->cellStart = (int*)calloc((size_t)cellCount + 1, sizeof(int));
+	if (index->cellStart == NULL)
+	{
+		return false;
+	}
+
+	int total = 0;
+	for (int pass = 0; pass < 2; pass++)
+	{
+		int* cursor = NULL;
+		if (pass == 1)
+		{
+			// 前缀和得到每格的起始位置
+			for (int c = 0; c < cellCount; c++)
+			{
+				index->cellStart[c + 1] += index->cellStart[c];
+			}
+			total = index->cellStart[cellCount];
+			index->items = (int*)malloc(sizeof(int) * (total > 0 ? total : 1));
+			cursor = (int*)malloc(sizeof(int) * cellCount);
+			if (index->items == NULL || cursor == NULL)
+			{
+				free(cursor);
+				return false;
+			}
+			memcpy(cursor, index->cellStart, sizeof(int) * cellCount);
+		}
+
+		for (int p = 0; p < world->portalCount; p++)
+		{
+			const Portal* portal = &world->portals[p];
+			if (portal->fromMap != map)
+			{
+				continue;
+			}
+			int cx0 = clampCell((int)(portal->rect.x / PORTAL_CELL_SIZE), index->cols);
+			int cy0 = clampCell((int)(portal->rect.y / PORTAL_CELL_SIZE), index->rows);
+			int cx1 = clampCell((int)((portal->rect.x + portal->rect.width) / PORTAL_CELL_SIZE), index->cols);
+			int cy1 = clampCell((int)((portal->rect.y + portal->rect.height) / PORTAL_CELL_SIZE), index->rows);
+			for (int cy = cy0; cy <= cy1; cy++)
+			{
+				for (int cx = cx0; cx <= cx1; cx++)
+				{
+					int cell = cy * index->cols + cx;
+					if (pass == 0) index->cellStart[cell + 1]++;
+					else index->items[cursor[cell]++] = p;
+				}
+			}
+		}
+		free(cursor);
+	}
+	return true;
+}
+
+bool LoadWorld(World* world, const char* path)
+{
+	memset(world, 0, sizeof(*world));
+	world->startMap = -1;
+
+	char* text = LoadFileText(path);
+	if (text == NULL)
+	{
+		TraceLog(LOG_WARNING, "World: failed to open %s", path);
+		return false;
+	}
+
+	bool ok = true;
+	bool header = false;
+	char* line = strtok(text, "\r\n");
+	while (ok && line != NULL)
+	{
+		char key[16] = { 0 };
+		int n = 0;
+		if (sscanf(line, "%15s%n", key, &n) == 1 && key[0] != '#')
+		{
+			const char* args = line + n;
+			char a[TILE_MAP_MAX_PATH], b[TILE_MAP_MAX_NAME], c[TILE_MAP_MAX_NAME];
+			float x, y;
+
+			if (strcmp(key, "world") == 0)
+			{
+				int version = 0;
+				header = ok = sscanf(args, "%d", &version) == 1 && version == WORLD_VERSION;
+			}
+			else if (!header)
+			{
+				ok = false;
+			}
+			else if (strcmp(key, "map") == 0)
+			{
+				ok = world->mapCount < WORLD_MAX_MAPS && sscanf(args, "%31s %259s", b, a) == 2 && findMap(world, b) < 0;
+				if (ok)
+				{
+					WorldMap* wm = &world->maps[world->mapCount];
+					strcpy(wm->name, b);
+					strcpy(wm->path, a);
+					ok = LoadTileMap(&wm->tiles, a);
+					if (ok)
+					{
+						// 地图改过尺寸后旧的 .lmask 会挡住或放开错误的区域：尺寸不符时丢弃，按对象层重新生成
+						const char* maskPath = GetCollisionMaskPath(a);
+						bool loaded = FileExists(maskPath) && LoadCollisionMask(&wm->mask, maskPath);
+						if (loaded && (wm->mask.width != (int)GetTileMapWidth(&wm->tiles) || wm->mask.height != (int)GetTileMapHeight(&wm->tiles)))
+						{
+							TraceLog(LOG_WARNING, "World: %s is %dx%d but %s is %dx%d, rebuilding from objects", maskPath,
+								wm->mask.width, wm->mask.height, a, (int)GetTileMapWidth(&wm->tiles), (int)GetTileMapHeight(&wm->tiles));
+							UnloadCollisionMask(&wm->mask);
+							loaded = false;
+						}
+						ok = loaded || BuildCollisionMask(&wm->mask, &wm->tiles, NULL);
+						if (!ok)
+						{
+							UnloadTileMap(&wm->tiles);
+						}
+					}
+					if (ok)
+					{
+						world->mapCount++;
+					}
+				}
+			}
+			else if (strcmp(key, "portal") == 0)
+			{
+				char object[TILE_MAP_MAX_NAME];
+				ok = world->portalCount < WORLD_MAX_PORTALS && sscanf(args, "%31s %31s %31s %f %f", b, object, c, &x, &y) == 5;
+				int from = ok ? findMap(world, b) : -1;
+				int to = ok ? findMap(world, c) : -1;
+				const MapObject* obj = (from >= 0) ? FindMapObject(&world->maps[from].tiles, MAP_OBJECT_PORTAL, object) : NULL;
+				ok = ok && to >= 0 && obj != NULL;
+				if (ok)
+				{
+					Portal* portal = &world->portals[world->portalCount++];
+					portal->fromMap = from;
+					portal->toMap = to;
+					portal->rect = obj->rect;
+					portal->spawn = (Vector2){ x, y };
+				}
+			}
+			else if (strcmp(key, "start") == 0)
+			{
+				ok = sscanf(args, "%31s %f %f", b, &x, &y) == 3 && (world->startMap = findMap(world, b)) >= 0;
+				world->startPos = (Vector2){ x, y };
+			}
+			else
+			{
+				ok = false;
+			}
+		}
+		if (ok)
+		{
+			line = strtok(NULL, "\r\n");
+		}
+	}
+	UnloadFileText(text);
+
+	ok = ok && header && world->mapCount > 0 && world->startMap >= 0;
+	for (int m = 0; ok && m < world->mapCount; m++)
+	{
+		ok = buildPortalIndex(world, m);
+	}
+	if (!ok)
+	{
+		TraceLog(LOG_WARNING, "World: failed to load %s", path);
+		UnloadWorld(world);
+	}
+	return ok;
+}
+
+void UnloadWorld(World* world)
+{
+	for (int m = 0; m < world->mapCount; m++)
+	{
+		UnloadTileMap(&world->maps[m].tiles);
+		UnloadCollisionMask(&world->maps[m].mask);
+		free(world->maps[m].portals.cellStart);
+		free(world->maps[m].portals.items);
+	}
+	memset(world, 0, sizeof(*world));
+}
+
+const Portal* FindPortalAt(const World* world, int map, Vector2 pos)
+{
+	const PortalIndex* index = &world->maps[map].portals;
+	if (pos.x < 0 || pos.y < 0)
+	{
+		return NULL;
+	}
+	int cx = (int)(pos.x / PORTAL_CELL_SIZE), cy = (int)(pos.y / PORTAL_CELL_SIZE);
+	if (cx >= index->cols || cy >= index->rows)
+	{
+		return NULL;
+	}
+
+	int cell = cy * index->cols + cx;
+	for (int k = index->cellStart[cell]; k < index->cellStart[cell + 1]; k++)
+	{
+		const Portal* portal = &world->portals[index->items[k]];
+		if (CheckCollisionPointRec(pos, portal->rect))
+		{
+			return portal;
+		}
+	}
+	return NULL;
+}
+
+int FindPortalsNear(const World* world, int map, Vector2 pos, float radius, const Portal** out, int maxCount)
+{
+	const PortalIndex* index = &world->maps[map].portals;
+
+	// 传送门中心在半径内时，传送门至少有一部分落在以 pos 为中心、边长 2*radius 的正方形里
+	int cx0 = clampCell((int)((pos.x - radius) / PORTAL_CELL_SIZE), index->cols);
+	int cy0 = clampCell((int)((pos.y - radius) / PORTAL_CELL_SIZE), index->rows);
+	int cx1 = clampCell((int)((pos.x + radius) / PORTAL_CELL_SIZE), index->cols);
+	int cy1 = clampCell((int)((pos.y + radius) / PORTAL_CELL_SIZE), index->rows);
+
+	int count = 0;
+	for (int cy = cy0; cy <= cy1; cy++)
+	{
+		for (int cx = cx0; cx <= cx1; cx++)
+		{
+			int cell = cy * index->cols + cx;
+			for (int k = index->cellStart[cell]; k < index->cellStart[cell + 1]; k++)
+			{
+				const Portal* portal = &world->portals[index->items[k]];
+				float dx = pos.x - (portal->rect.x + portal->rect.width / 2);
+				float dy = pos.y - (portal->rect.y + portal->rect.height / 2);
+				if (dx * dx + dy * dy >= radius * radius)
+				{
+					continue;
+				}
+
+				// 跨多个格子的传送门只记录一次
+				bool seen = false;
+				for (int i = 0; i < count && !seen; i++)
+				{
+					seen = (out[i] == portal);
+				}
+				if (!seen && count < maxCount)
+				{
+					out[count++] = portal;
+				}
+			}
+		}
+	}
+	return count;
+}
@@ -0,0 +1,61 @@
+﻿#pragma once
+
+#include <stdbool.h>
+#include <raylib.h>
+#include "TileMap.h"
+#include "CollisionMask.h"
+
+#define WORLD_MAX_MAPS 16
+#define WORLD_MAX_PORTALS 64
+#define PORTAL_CELL_SIZE 128      // 传送门空间索引的网格边长（像素）
+
+// 传送门：位于 fromMap 中的矩形，进入后到达 toMap 的 spawn 位置
+typedef struct Portal
+{
+	int fromMap;
+	int toMap;
+	Rectangle rect;           // 来自 fromMap 的对象层
+	Vector2 spawn;
+} Portal;
+
+// 每张地图的传送门均匀网格：cellStart[c]..cellStart[c+1] 是格子 c 中的传送门编号
+typedef struct PortalIndex
+{
+	int cols, rows;
+	int* cellStart;
+	int* items;
+} PortalIndex;
+
+typedef struct WorldMap
+{
+	char name[TILE_MAP_MAX_NAME];
+	char path[TILE_MAP_MAX_PATH];
+	TileMap tiles;
+	CollisionMask mask;       // 有 --build-mask 生成的 .lmask 时读入，否则由对象层的 collision 矩形生成
+	PortalIndex portals;
+} WorldMap;
+
+// 世界图（文本文件）：
+//   world 1
+//   map <名称> <地图文件 .ltm>
+//   portal <所在地图> <对象层中的传送门名称> <目标地图> <出生点x> <出生点y>
+//   start <地图> <x> <y>
+// 增加地图或传送门只需修改数据文件
+typedef struct World
+{
+	WorldMap maps[WORLD_MAX_MAPS];
+	int mapCount;
+	Portal portals[WORLD_MAX_PORTALS];
+	int portalCount;
+	int startMap;
+	Vector2 startPos;
+} World;
+
+bool LoadWorld(World* world, const char* path);
+void UnloadWorld(World* world);
+
+// 玩家所在位置的传送门，只检查所在的一个网格；没有返回 NULL
+const Portal* FindPortalAt(const World* world, int map, Vector2 pos);
+
+// 中心距离 pos 小于 radius 的传送门（用于预取），只检查覆盖的网格，返回个数
+int FindPortalsNear(const World* world, int map, Vector2 pos, float radius, const Portal** out, int maxCount);
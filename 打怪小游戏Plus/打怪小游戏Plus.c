@@ -1,105 +1,343 @@
 ﻿#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
 #include<raylib.h>
-int main(void)
+#include"SpriteAtlas.h"
+#include"Animation.h"
+#include"AsyncLoader.h"
+#include"CompressedTexture.h"
+#include"TileMap.h"
+#include"WorldGraph.h"
+
+#define IMAGE_DIR "Image"
+#define ATLAS_PATH "Image/atlas.png"
+#define ATLAS_META_PATH "Image/atlas.txt"
+
+// 窗口只显示地图的一部分，摄像机跟随玩家
+#define SCREEN_WIDTH 1024
+#define SCREEN_HEIGHT 768
+
+// 玩家离传送门中心小于这个距离时开始预取目标地图
+#define PREFETCH_DISTANCE 300.0f
+// 离开所有通往某张地图的传送门超过这个距离后释放预取的图块集；比预取距离大一截，在边界附近来回走动时不会反复加载
+#define PREFETCH_RELEASE_DISTANCE 450.0f
+
+// 地图、传送门与出生点都写在世界图文件中
+#define WORLD_PATH "Map/world.txt"
+
+// 同时预取的传送门数量上限
+#define MAX_NEAR_PORTALS 8
+
+// 靠近传送门时提前请求目标地图的图块集，走进传送门时通常已经解码并上传完毕
+static void prefetchMap(AsyncLoader* loader, const World* world, int* mapSlots, int map)
 {
-	InitWindow(1500, 1394, u8"打怪小游戏Plus");
+	if (mapSlots[map] < 0)
+	{
+		// 已经用 --build-ltex 转换过的图块集直接读取预处理好的数据
+		mapSlots[map] = RequestTexture(loader, PreferCompressedPath(world->maps[map].tiles.tilesetPath));
+	}
+}
 
-	SetTargetFPS(60);
+// 不再需要某张地图的图块集；几张地图共用同一图块集时槽位相同，没有其他地图使用时才真正释放
+static void releaseMap(AsyncLoader* loader, const World* world, int* mapSlots, int map)
+{
+	int slot = mapSlots[map];
+	mapSlots[map] = -1;
+	for (int i = 0; i < world->mapCount; i++)
+	{
+		if (mapSlots[i] == slot)
+		{
+			return;
+		}
+	}
+	ReleaseTexture(loader, slot);
+}
+
+// 切换地图：释放离开的地图，只保留当前地图常驻
+// 通往同一张地图的传送门只移动玩家；目标地图的槽位请求成功后才释放离开的地图
+static void switchMap(AsyncLoader* loader, const World* world, int* mapSlots, int* currentMap, int map)
+{
+	if (map == *currentMap)
+	{
+		return;
+	}
+	prefetchMap(loader, world, mapSlots, map);
+	if (mapSlots[map] >= 0)
+	{
+		releaseMap(loader, world, mapSlots, *currentMap);
+	}
+	*currentMap = map;
+}
 
-	Texture2D bgTex = LoadTexture("Image/主地图.png");
-	Texture2D map1 = LoadTexture("Image/map1Plus.png");
+// 世界图包含所有地图的图块数据，放在静态存储区
+static World world;
 
-	Image img = LoadImage("map1Plus.png");
-	
-	// 当前地图编号
-	int currentMap = 0;
-	// 当前显示的地图
-	Texture2D currentBg = bgTex;
+int main(int argc, char* argv[])
+{
+	// 离线打包角色精灵：打怪小游戏Plus.exe --pack-atlas
+	if (argc > 1 && strcmp(argv[1], "--pack-atlas") == 0)
+	{
+		return PackSpriteAtlas(IMAGE_DIR, ATLAS_PATH, ATLAS_META_PATH) ? 0 : 1;
+	}
+
+	// 把大图切成去重的图块集与地图文件：
+	// 打怪小游戏Plus.exe --build-tilemap 图片 图块边长 图块集.png 地图.ltm
+	if (argc > 5 && strcmp(argv[1], "--build-tilemap") == 0)
+	{
+		return BuildTileMapFromImage(argv[2], atoi(argv[3]), argv[4], argv[5]) ? 0 : 1;
+	}
+
+	// 把图块集转换为 .ltex：打怪小游戏Plus.exe --build-ltex [--raw] [图片...]
+	// 默认使用 BC1 压缩，--raw 写入未压缩 RGBA8；不指定图片时转换所有地图的图块集
+	if (argc > 1 && strcmp(argv[1], "--build-ltex") == 0)
+	{
+		bool compress = true;
+		int first = 2;
+		if (argc > 2 && strcmp(argv[2], "--raw") == 0)
+		{
+			compress = false;
+			first = 3;
+		}
+
+		if (first >= argc && !LoadWorld(&world, WORLD_PATH))
+		{
+			return 1;
+		}
+
+		bool ok = true;
+		int count = (first < argc) ? argc - first : world.mapCount;
+		for (int i = 0; i < count; i++)
+		{
+			const char* src = (first < argc) ? argv[first + i] : world.maps[i].tiles.tilesetPath;
+			const char* dot = strrchr(src, '.');
+			const char* dst = TextFormat("%.*s.ltex", dot ? (int)(dot - src) : (int)strlen(src), src);
+			ok = BuildCompressedTexture(src, dst, compress) && ok;
+		}
+		UnloadWorld(&world);
+		return ok ? 0 : 1;
+	}
+
+	// 离线生成地形碰撞位图：打怪小游戏Plus.exe --build-mask
+	// 为世界图中的每张地图写出 .lmask；地图旁有同名的 _mask.png 手绘遮罩时一并叠加（黑色不可通行）
+	if (argc > 1 && strcmp(argv[1], "--build-mask") == 0)
+	{
+		if (!LoadWorld(&world, WORLD_PATH))
+		{
+			return 1;
+		}
+
+		bool ok = true;
+		for (int i = 0; i < world.mapCount; i++)
+		{
+			const char* mapPath = world.maps[i].path;
+			const char* dot = strrchr(mapPath, '.');
+			const char* imagePath = TextFormat("%.*s_mask.png", dot ? (int)(dot - mapPath) : (int)strlen(mapPath), mapPath);
+			CollisionMask mask;
+			if (BuildCollisionMask(&mask, &world.maps[i].tiles, FileExists(imagePath) ? imagePath : NULL))
+			{
+				ok = SaveCollisionMask(&mask, GetCollisionMaskPath(mapPath)) && ok;
+				UnloadCollisionMask(&mask);
+			}
+			else
+			{
+				ok = false;
+			}
+		}
+		UnloadWorld(&world);
+		return ok ? 0 : 1;
+	}
+
+	// 地图文件很小，启动时全部读入；图块集纹理按需异步加载
+	if (!LoadWorld(&world, WORLD_PATH))
+	{
+		printf(u8"无法读取世界图: %s\n", WORLD_PATH);
+		return 1;
+	}
+
+	InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, u8"打怪小游戏Plus");
 
+	SetTargetFPS(60);
+
+	// 地图背景在后台线程解码，不阻塞第一帧
+	AsyncLoader loader;
+	if (!StartAsyncLoader(&loader))
+	{
+		printf(u8"无法启动加载线程\n");
+		CloseWindow();
+		UnloadWorld(&world);
+		return 1;
+	}
 
-	// ⭐ 地图1中的传送门（传送到地图2）
-	Rectangle portal1 = { 600, 300, 60, 60 };
+	// 当前地图编号
+	int currentMap = world.startMap;
+	// 各地图在加载器中的槽位，-1 表示未加载
+	int mapSlots[WORLD_MAX_MAPS];
+	for (int i = 0; i < WORLD_MAX_MAPS; i++)
+	{
+		mapSlots[i] = -1;
+	}
+	prefetchMap(&loader, &world, mapSlots, currentMap);
 
-	// ⭐ 地图2中的传送门（传送回地图1）
-	Rectangle portal2 = { 100, 100, 60, 60 };
+	// 角色精灵全部来自同一张图集纹理
+	SpriteAtlas sprites;
+	LoadSpriteAtlas(&sprites, IMAGE_DIR, ATLAS_PATH, ATLAS_META_PATH);
 
-	Texture2D knightForward = LoadTexture("Image/向前.png");
+	// 动画定义所有角色共享，玩家只保存自己的播放状态
+	AnimationSet animations;
+	LoadAnimationSet(&animations, &sprites);
+	Animator player;
+	ResetAnimator(&player, ANIM_IDLE);
 
-	Vector2 pos = { 250,250 };
+	// 玩家脚底的位置，地形碰撞与传送门都以这一点判断
+	Vector2 pos = world.startPos;
 
 	bool canTeleport = true;
 
+	Camera2D camera = { 0 };
+	camera.offset = (Vector2){ SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f };
+	camera.zoom = 1.0f;
 
 	while (!WindowShouldClose())
 	{
+		// 每帧最多上传一张解码好的图片
+		PumpAsyncLoader(&loader, 1);
+		// 槽位用尽时请求会失败（返回 -1），之后每帧重试当前地图
+		prefetchMap(&loader, &world, mapSlots, currentMap);
+
+		// 摄像机对准玩家，但不超出地图边界
+		const TileMap* map = &world.maps[currentMap].tiles;
+		float halfW = SCREEN_WIDTH / 2.0f, halfH = SCREEN_HEIGHT / 2.0f;
+		camera.target = pos;
+		if (camera.target.x < halfW) camera.target.x = halfW;
+		if (camera.target.y < halfH) camera.target.y = halfH;
+		if (camera.target.x > GetTileMapWidth(map) - halfW) camera.target.x = GetTileMapWidth(map) - halfW;
+		if (camera.target.y > GetTileMapHeight(map) - halfH) camera.target.y = GetTileMapHeight(map) - halfH;
+
 		BeginDrawing();
 
 		ClearBackground(WHITE);
 
-		DrawTexture(currentBg, 0, 0, WHITE);
+		BeginMode2D(camera);
 
-		DrawFPS(0, 0);
+		// 只提交视野内的图块
+		if (IsTextureReady(&loader, mapSlots[currentMap]))
+		{
+			DrawTileMap(map, GetLoadedTexture(&loader, mapSlots[currentMap]), camera, SCREEN_WIDTH, SCREEN_HEIGHT);
+		}
+
+		DrawAnimator(&animations, &player, pos, WHITE);
+
+		// 当前地图的传送门，颜色按目标地图区分
+		static const Color portalColors[] = { RED, BLUE, GREEN, ORANGE };
+		for (int i = 0; i < world.portalCount; i++)
+		{
+			const Portal* portal = &world.portals[i];
+			if (portal->fromMap == currentMap)
+			{
+				DrawRectangleRec(portal->rect, Fade(portalColors[portal->toMap % 4], 0.4f));
+			}
+		}
 
-		DrawTextureV(knightForward, pos, WHITE);
+		EndMode2D();
 
-		if (currentMap == 0)
-			DrawRectangleRec(portal1, Fade(RED, 0.4f));
-		else
-			DrawRectangleRec(portal2, Fade(BLUE, 0.4f));
+		if (!IsTextureReady(&loader, mapSlots[currentMap]))
+		{
+			DrawText("Loading...", 20, 40, 20, GRAY);
+		}
 
+		DrawFPS(0, 0);
 
 		EndDrawing();
 
+		Vector2 next = pos;
+		AnimAction action = ANIM_IDLE;
 		if (IsKeyDown(KEY_W) || IsKeyDown(KEY_UP)) {
-			pos.y -= 2;
+			next.y -= 2;
+			action = ANIM_WALK_UP;
 		}
 		else if (IsKeyDown(KEY_S) || IsKeyDown(KEY_DOWN)) {
-			pos.y += 2;
+			next.y += 2;
+			action = ANIM_WALK_DOWN;
 		}
 		else if (IsKeyDown(KEY_A) || IsKeyDown(KEY_LEFT)) {
-			pos.x -= 2;
+			next.x -= 2;
+			action = ANIM_RUN_LEFT;
 		}
 		else if (IsKeyDown(KEY_D) || IsKeyDown(KEY_RIGHT)) {
-			pos.x += 2;
+			next.x += 2;
+			action = ANIM_RUN_RIGHT;
+		}
+
+		// J 攻击、空格跳跃、按住 K 格挡；攻击与跳跃播完前不会被移动动作打断
+		if (IsKeyPressed(KEY_J)) {
+			action = ANIM_ATTACK;
+		}
+		else if (IsKeyPressed(KEY_SPACE)) {
+			action = ANIM_JUMP;
+		}
+		else if (IsKeyDown(KEY_K)) {
+			action = ANIM_BLOCK;
+		}
+		PlayAnimation(&player, &animations, action);
+		UpdateAnimators(&player, 1, &animations, GetFrameTime());
+
+		// 不走出地图
+		if (next.x < 0) next.x = 0;
+		if (next.y < 0) next.y = 0;
+		if (next.x > GetTileMapWidth(map) - 1) next.x = GetTileMapWidth(map) - 1;
+		if (next.y > GetTileMapHeight(map) - 1) next.y = GetTileMapHeight(map) - 1;
+
+		// 地形碰撞：整段路径都可通行才移动
+		if (CanMoveTo(&world.maps[currentMap].mask, pos, next))
+		{
+			pos = next;
 		}
 
 		// ---- 地图切换逻辑 ----
-		if (currentMap == 0)
+		// 靠近传送门时预取目标地图，只检查玩家附近的网格
+		// 走远后释放预取过的地图：当前地图与释放距离内传送门通往的地图保留，其余的都释放
+		bool keepMap[WORLD_MAX_MAPS] = { false };
+		keepMap[currentMap] = true;
+		const Portal* nearPortals[MAX_NEAR_PORTALS];
+		int nearCount = FindPortalsNear(&world, currentMap, pos, PREFETCH_DISTANCE, nearPortals, MAX_NEAR_PORTALS);
+		for (int i = 0; i < nearCount; i++)
 		{
-			if (CheckCollisionPointRec(pos, portal1))
-			{
-				if (canTeleport) {
-					currentMap = 1;
-					currentBg = map1;
-					pos = (Vector2){ 300, 300 };   // 远离传送点
-					canTeleport = false;          // 冷却开始
-				}
-			}
-			else {
-				canTeleport = true; // 玩家离开传送门后，才能再次传送
-			}
+			prefetchMap(&loader, &world, mapSlots, nearPortals[i]->toMap);
+			// 传送门多于 MAX_NEAR_PORTALS 时，下面较大半径的查询可能漏掉这些，正在预取的也一并保留
+			keepMap[nearPortals[i]->toMap] = true;
+		}
+		nearCount = FindPortalsNear(&world, currentMap, pos, PREFETCH_RELEASE_DISTANCE, nearPortals, MAX_NEAR_PORTALS);
+		for (int i = 0; i < nearCount; i++)
+		{
+			keepMap[nearPortals[i]->toMap] = true;
 		}
-		else if (currentMap == 1)
+		for (int i = 0; i < world.mapCount; i++)
 		{
-			if (CheckCollisionPointRec(pos, portal2))
+			if (!keepMap[i] && mapSlots[i] >= 0)
 			{
-				if (canTeleport) {
-					currentMap = 0;
-					currentBg = bgTex;
-					pos = (Vector2){ 500, 400 };
-					canTeleport = false;
-				}
+				releaseMap(&loader, &world, mapSlots, i);
 			}
-			else {
-				canTeleport = true;
+		}
+
+		const Portal* portal = FindPortalAt(&world, currentMap, pos);
+		if (portal != NULL)
+		{
+			if (canTeleport) {
+				switchMap(&loader, &world, mapSlots, &currentMap, portal->toMap);
+				pos = portal->spawn;          // 出生点远离目标地图的传送门
+				canTeleport = false;          // 冷却开始
 			}
 		}
+		else {
+			canTeleport = true; // 玩家离开传送门后，才能再次传送
+		}
 	}
-	UnloadTexture(bgTex);
-	UnloadTexture(map1);
-	UnloadTexture(knightForward);
+	StopAsyncLoader(&loader);
+	UnloadSpriteAtlas(&sprites);
 	CloseWindow();
 
+	UnloadWorld(&world);
+
 	return 0;
 }
 